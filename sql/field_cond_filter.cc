@@ -0,0 +1,271 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "sql/field_cond_filter.h"
+
+#include <algorithm>
+
+#include "my_dbug.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_cmpfunc.h"
+#include "sql/item_func.h"
+#include "sql/sql_class.h"
+#include "sql/sql_list.h"
+#include "sql/table.h"
+#include "template_utils.h"
+
+namespace {
+
+/**
+  Compares two integers of any signedness.
+
+  @returns -1, 0 or 1 if a is less than, equal to or greater than b
+*/
+inline int cmp_values(const Field_cond_filter::Value &a,
+                      const Field_cond_filter::Value &b)
+{
+  if (a.unsigned_flag != b.unsigned_flag)
+  {
+    // A negative signed value is less than any unsigned value
+    if (!a.unsigned_flag && a.value < 0)
+      return -1;
+    if (!b.unsigned_flag && b.value < 0)
+      return 1;
+  }
+  else if (!a.unsigned_flag)
+    return a.value < b.value ? -1 : (a.value == b.value ? 0 : 1);
+  const ulonglong ua= static_cast<ulonglong>(a.value);
+  const ulonglong ub= static_cast<ulonglong>(b.value);
+  return ua < ub ? -1 : (ua == ub ? 0 : 1);
+}
+
+
+/// @returns the column of an integer type that item is, or NULL
+Field *int_column(Item *item, TABLE *table)
+{
+  if (item->type() != Item::FIELD_ITEM ||
+      (item->used_tables() & OUTER_REF_TABLE_BIT))
+    return NULL;
+  Field *const field= down_cast<Item_field*>(item)->field;
+  if (field->table != table)
+    return NULL;
+  switch (field->real_type())
+  {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+    return field;
+  default:
+    return NULL;
+  }
+}
+
+
+/**
+  Evaluates an integer constant.
+
+  @returns true if item is not a non-NULL integer constant
+*/
+bool int_constant(Item *item, Field_cond_filter::Value *value)
+{
+  if (!item->const_item() || item->is_expensive() ||
+      item->result_type() != INT_RESULT)
+    return true;
+  value->value= item->val_int();
+  value->unsigned_flag= item->unsigned_flag;
+  return item->null_value;
+}
+
+} // namespace
+
+
+Field_cond_filter::Field_cond_filter(THD *thd, Item *condition)
+  : m_condition(condition), m_terms(thd->mem_root)
+{}
+
+
+Field_cond_filter *
+Field_cond_filter::create(THD *thd, Item *condition, TABLE *table)
+{
+  Field_cond_filter *const filter=
+    new (thd->mem_root) Field_cond_filter(thd, condition);
+  if (filter == NULL)
+    return NULL;                                /* purecov: inspected */
+
+  if (condition->type() == Item::COND_ITEM &&
+      down_cast<Item_cond*>(condition)->functype() ==
+      Item_func::COND_AND_FUNC)
+  {
+    List_iterator<Item> it(*down_cast<Item_cond*>(condition)->argument_list());
+    Item *item;
+    while ((item= it++))
+    {
+      if (filter->add_term(thd, item, table))
+        return NULL;
+    }
+  }
+  else if (filter->add_term(thd, condition, table))
+    return NULL;
+
+  if (thd->is_error())
+    return NULL;
+  return filter;
+}
+
+
+/**
+  Compiles a predicate of the condition.
+
+  @returns true if the predicate is not simple, or if out of memory
+*/
+bool Field_cond_filter::add_term(THD *thd, Item *item, TABLE *table)
+{
+  if (item->type() != Item::FUNC_ITEM)
+    return true;
+  Item_func *const func= down_cast<Item_func*>(item);
+  Item **const args= func->arguments();
+
+  Term term;
+  term.negated= false;
+  term.values= NULL;
+  term.num_values= 0;
+
+  switch (func->functype())
+  {
+  case Item_func::EQ_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+  {
+    // Put the column on the left side, mirroring the comparison if needed
+    bool swapped= false;
+    if ((term.field= int_column(args[0], table)) == NULL)
+    {
+      if ((term.field= int_column(args[1], table)) == NULL)
+        return true;
+      swapped= true;
+    }
+    if (int_constant(args[swapped ? 0 : 1], &term.low))
+      return true;
+    switch (func->functype())
+    {
+    case Item_func::EQ_FUNC: term.type= TERM_EQ; break;
+    case Item_func::NE_FUNC: term.type= TERM_NE; break;
+    case Item_func::LT_FUNC: term.type= swapped ? TERM_GT : TERM_LT; break;
+    case Item_func::LE_FUNC: term.type= swapped ? TERM_GE : TERM_LE; break;
+    case Item_func::GT_FUNC: term.type= swapped ? TERM_LT : TERM_GT; break;
+    default:                 term.type= swapped ? TERM_LE : TERM_GE; break;
+    }
+    break;
+  }
+  case Item_func::BETWEEN:
+    if ((term.field= int_column(args[0], table)) == NULL ||
+        int_constant(args[1], &term.low) || int_constant(args[2], &term.high))
+      return true;
+    term.type= TERM_BETWEEN;
+    term.negated= down_cast<Item_func_opt_neg*>(func)->negated;
+    break;
+  case Item_func::IN_FUNC:
+  {
+    if ((term.field= int_column(args[0], table)) == NULL)
+      return true;
+    const uint num_values= func->argument_count() - 1;
+    Value *const values=
+      static_cast<Value*>(thd->alloc(num_values * sizeof(Value)));
+    if (values == NULL)
+      return true;                              /* purecov: inspected */
+    for (uint i= 0; i < num_values; i++)
+    {
+      if (int_constant(args[i + 1], &values[i]))
+        return true;
+    }
+    std::sort(values, values + num_values,
+              [](const Value &a, const Value &b)
+              { return cmp_values(a, b) < 0; });
+    term.type= TERM_IN;
+    term.negated= down_cast<Item_func_opt_neg*>(func)->negated;
+    term.values= values;
+    term.num_values= num_values;
+    break;
+  }
+  case Item_func::ISNULL_FUNC:
+  case Item_func::ISNOTNULL_FUNC:
+    if ((term.field= int_column(args[0], table)) == NULL)
+      return true;
+    term.type= func->functype() == Item_func::ISNULL_FUNC ?
+      TERM_IS_NULL : TERM_IS_NOT_NULL;
+    break;
+  default:
+    return true;
+  }
+
+  term.unsigned_field= down_cast<Field_num*>(term.field)->unsigned_flag;
+  return m_terms.push_back(term);
+}
+
+
+inline bool Field_cond_filter::term_matches(const Term &term)
+{
+  if (term.field->is_null())
+    return term.type == TERM_IS_NULL;
+
+  const Value value= { term.field->val_int(), term.unsigned_field };
+  switch (term.type)
+  {
+  case TERM_EQ:
+    return cmp_values(value, term.low) == 0;
+  case TERM_NE:
+    return cmp_values(value, term.low) != 0;
+  case TERM_LT:
+    return cmp_values(value, term.low) < 0;
+  case TERM_LE:
+    return cmp_values(value, term.low) <= 0;
+  case TERM_GT:
+    return cmp_values(value, term.low) > 0;
+  case TERM_GE:
+    return cmp_values(value, term.low) >= 0;
+  case TERM_BETWEEN:
+    return (cmp_values(value, term.low) >= 0 &&
+            cmp_values(value, term.high) <= 0) != term.negated;
+  case TERM_IN:
+    return std::binary_search(term.values, term.values + term.num_values,
+                              value,
+                              [](const Value &a, const Value &b)
+                              { return cmp_values(a, b) < 0; }) !=
+           term.negated;
+  case TERM_IS_NULL:
+    return false;
+  case TERM_IS_NOT_NULL:
+    return true;
+  }
+  DBUG_ASSERT(false);
+  return false;
+}
+
+
+bool Field_cond_filter::matches() const
+{
+  for (const Term &term : m_terms)
+  {
+    if (!term_matches(term))
+      return false;
+  }
+  return true;
+}
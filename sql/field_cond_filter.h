@@ -0,0 +1,110 @@
+#ifndef FIELD_COND_FILTER_INCLUDED
+#define FIELD_COND_FILTER_INCLUDED
+
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file sql/field_cond_filter.h
+  Evaluation of simple table conditions without the Item tree.
+*/
+
+#include "my_inttypes.h"
+#include "sql/mem_root_array.h"
+#include "sql/sql_alloc.h"
+
+class Field;
+class Item;
+class THD;
+struct TABLE;
+
+/**
+  A table condition which is a conjunction of simple predicates on
+  integer columns of the table:
+
+    column op constant, where op is one of =, <>, <, <=, >, >=
+    column [NOT] BETWEEN constant AND constant
+    column [NOT] IN (constant, ...)
+    column IS [NOT] NULL
+
+  The condition is compiled once into an array of terms, each holding the
+  column and the constants it is compared with. For every row, the terms
+  are evaluated in a loop reading the values of the columns, rather than
+  through the virtual val_int() calls of the functions, comparators and
+  fields of the Item tree. The result is the same as
+  condition->val_int() != 0.
+*/
+class Field_cond_filter : public Sql_alloc
+{
+public:
+  /**
+    Compiles a condition attached to a table.
+
+    @param thd        thread handler
+    @param condition  the condition
+    @param table      the table the condition is attached to
+
+    @returns the compiled condition, or NULL if the condition has other
+             terms, or if out of memory.
+  */
+  static Field_cond_filter *create(THD *thd, Item *condition, TABLE *table);
+
+  /// @returns the condition which has been compiled
+  Item *condition() const { return m_condition; }
+
+  /// @returns whether the current row of the table satisfies the condition
+  bool matches() const;
+
+  /// An integer constant, with its signedness
+  struct Value
+  {
+    longlong value;
+    bool unsigned_flag;
+  };
+
+private:
+  enum enum_term_type
+  {
+    TERM_EQ, TERM_NE, TERM_LT, TERM_LE, TERM_GT, TERM_GE,
+    TERM_BETWEEN, TERM_IN, TERM_IS_NULL, TERM_IS_NOT_NULL
+  };
+
+  struct Term
+  {
+    Field *field;
+    bool unsigned_field;
+    enum_term_type type;
+    /// For TERM_BETWEEN and TERM_IN: whether the predicate is negated
+    bool negated;
+    /// Constant compared with, lower bound for TERM_BETWEEN
+    Value low;
+    /// Upper bound for TERM_BETWEEN
+    Value high;
+    /// For TERM_IN: the constants of the list, in ascending order
+    const Value *values;
+    uint num_values;
+  };
+
+  Field_cond_filter(THD *thd, Item *condition);
+
+  bool add_term(THD *thd, Item *item, TABLE *table);
+
+  static bool term_matches(const Term &term);
+
+  Item *const m_condition;
+  Mem_root_array<Term> m_terms;
+};
+
+#endif /* FIELD_COND_FILTER_INCLUDED */
@@ -441,6 +441,7 @@ bool filesort(THD *thd, Filesort *filesort, bool sort_positions,
                           max_rows, sort_positions);
 
   table_sort.addon_fields= param.addon_fields;
+  param.m_sort_threads= thd->variables.sort_threads;
 
   if (tab->quick())
     thd->inc_status_sort_range();
@@ -634,7 +635,7 @@ bool filesort(THD *thd, Filesort *filesort, bool sort_positions,
     sort_mode.append(">");
 
     const char *algo_text[]= {
-      "none", "std::sort", "std::stable_sort"
+      "none", "std::sort", "std::stable_sort", "radix_sort"
     };
 
     Opt_trace_object filesort_summary(trace, "filesort_summary");
@@ -837,6 +838,124 @@ uint Filesort::make_sortorder()
 }
 
 
+namespace {
+/// Orders the sort keys of Sort_limit_filter's heap, greatest first.
+class Sort_limit_key_less
+{
+public:
+  explicit Sort_limit_key_less(uint key_length) : m_key_length(key_length) {}
+  bool operator()(const uchar *k1, const uchar *k2) const
+  {
+    return memcmp(k1, k2, m_key_length) < 0;
+  }
+private:
+  uint m_key_length;
+};
+} // namespace
+
+
+bool Sort_limit_filter::init(THD *thd, Filesort *filesort)
+{
+  DBUG_ENTER("Sort_limit_filter::init");
+  DBUG_ASSERT(m_param == NULL);
+  TABLE *const table= filesort->tab->table();
+  const ha_rows limit= filesort->limit;
+
+  const uint s_length= filesort->make_sortorder();
+  if (s_length == 0)
+    DBUG_RETURN(true);                          /* purecov: inspected */
+  /*
+    filesort() makes its own sort order again; work on a copy so that both
+    do not share the lengths computed by sortlength().
+  */
+  st_sort_field *const sortorder= static_cast<st_sort_field*>(
+    thd->memdup(filesort->sortorder, sizeof(st_sort_field) * s_length));
+  if (sortorder == NULL)
+    DBUG_RETURN(true);                          /* purecov: inspected */
+  const uint sort_length= sortlength(thd, sortorder, s_length);
+
+  if (limit == 0 ||
+      limit > thd->variables.sortbuff_size / (sort_length + sizeof(uchar*)))
+    DBUG_RETURN(false);
+
+  if (!(m_param= new (thd->mem_root) Sort_param))
+    DBUG_RETURN(true);                          /* purecov: inspected */
+  m_param->init_for_filesort(filesort, make_array(sortorder, s_length),
+                             sort_length, table,
+                             thd->variables.max_length_for_sort_data,
+                             limit, true);
+  DBUG_ASSERT(!m_param->using_addon_fields());
+  if (m_param->using_varlen_keys())
+    DBUG_RETURN(false);
+
+  /*
+    One buffer holds the heap, the keys of the heap, the key of the row
+    being checked, the row reference and the temporary buffer of
+    make_sortkey().
+  */
+  const size_t heap_size= limit * sizeof(uchar*);
+  const size_t keys_size= limit * sort_length;
+  const size_t buffer_size= heap_size + keys_size +
+                            m_param->max_record_length() +
+                            m_param->ref_length +
+                            m_param->max_compare_length();
+  uchar *const buffer= static_cast<uchar*>(
+    my_malloc(key_memory_Filesort_buffer_sort_keys, buffer_size, MYF(MY_WME)));
+  if (buffer == NULL)
+    DBUG_RETURN(true);                          /* purecov: inspected */
+
+  m_heap= reinterpret_cast<uchar**>(buffer);
+  uchar *const keys= buffer + heap_size;
+  for (ha_rows i= 0; i < limit; i++)
+    m_heap[i]= keys + i * sort_length;
+  m_row_key= keys + keys_size;
+  m_ref= m_row_key + m_param->max_record_length();
+  memset(m_ref, 0, m_param->ref_length);
+  m_param->tmp_buffer= pointer_cast<char*>(m_ref + m_param->ref_length);
+
+  m_key_length= sort_length;
+  m_limit= limit;
+  m_num_keys= 0;
+  DBUG_RETURN(false);
+}
+
+
+Sort_limit_filter::~Sort_limit_filter()
+{
+  my_free(m_heap);
+}
+
+
+bool Sort_limit_filter::is_rejected()
+{
+  if (m_limit == 0)
+    return false;
+  m_param->make_sortkey(m_row_key, m_ref);
+  return m_num_keys == m_limit &&
+         memcmp(m_row_key, m_heap[0], m_key_length) > 0;
+}
+
+
+void Sort_limit_filter::add_row()
+{
+  if (m_limit == 0)
+    return;
+  const Sort_limit_key_less less(m_key_length);
+  if (m_num_keys < m_limit)
+  {
+    memcpy(m_heap[m_num_keys++], m_row_key, m_key_length);
+    std::push_heap(m_heap, m_heap + m_num_keys, less);
+  }
+  else if (less(m_row_key, m_heap[0]))
+  {
+    // Replace the greatest key of the heap
+    std::pop_heap(m_heap, m_heap + m_limit, less);
+    memcpy(m_heap[m_limit - 1], m_row_key, m_key_length);
+    std::push_heap(m_heap, m_heap + m_limit, less);
+  }
+}
+
+
 void Filesort_info::read_chunk_descriptors(IO_CACHE *chunk_file, uint count)
 {
   DBUG_ENTER("Filesort_info::read_chunk_descriptors");
@@ -28,6 +28,7 @@
 class Addon_fields;
 class Field;
 class QEP_TAB;
+class Sort_param;
 class THD;
 struct TABLE;
 struct st_order;
@@ -84,6 +85,77 @@ public:
                                  uint *ppackable_length);
 };
 
+
+/**
+  Filters the rows written to a temporary table which is then sorted by
+  filesort() with a LIMIT.
+
+  The sort keys of the first limit rows written are kept in a max-heap.
+  A row whose sort key is greater than the greatest key of the heap cannot
+  be among the first limit rows of the sorted table, so it does not need
+  to be written. A row with a smaller key is written, and replaces the
+  greatest key of the heap. The filter thus works with a threshold which
+  decreases while the table is filled.
+
+  The heap takes limit sort keys; the filter is not used if that would
+  exceed sort_buffer_size, or if the sort keys are of variable length.
+*/
+class Sort_limit_filter: public Sql_alloc
+{
+public:
+  Sort_limit_filter() :
+    m_param(NULL), m_limit(0), m_key_length(0), m_num_keys(0),
+    m_heap(NULL), m_row_key(NULL), m_ref(NULL)
+  {}
+
+  ~Sort_limit_filter();
+
+  /**
+    Prepare the filter for the rows of the table sorted by filesort.
+    Must be called with the ref item slice used to read the table, as the
+    sort keys are made from the same expressions as those of filesort().
+
+    @param thd       Thread handler
+    @param filesort  The sort of the table, with filesort->limit set
+
+    @returns true on error. If the filter cannot be used, false is
+             returned and the filter accepts all rows.
+  */
+  bool init(THD *thd, Filesort *filesort);
+
+  /// Forgets the rows accepted so far, before the table is filled again.
+  void reset() { m_num_keys= 0; }
+
+  /**
+    Makes the sort key of the row in the record buffer of the table.
+
+    @returns true if the row cannot be among the first limit rows of the
+             sorted table, and needs not be written to it.
+  */
+  bool is_rejected();
+
+  /**
+    Adds the sort key made by the last call to is_rejected() to the heap,
+    after the row has been written to the table.
+  */
+  void add_row();
+
+private:
+  Sort_param *m_param;
+  /// Number of rows returned by filesort(), 0 if the filter is not used
+  ha_rows m_limit;
+  /// Length of the sort keys, without the row reference
+  uint m_key_length;
+  /// Number of keys in the heap
+  ha_rows m_num_keys;
+  /// Max-heap of the sort keys of the rows accepted so far
+  uchar **m_heap;
+  /// Sort key of the last row checked by is_rejected()
+  uchar *m_row_key;
+  /// Row reference given to Sort_param::make_sortkey()
+  uchar *m_ref;
+};
+
 bool filesort(THD *thd, Filesort *fsort, bool sort_positions,
               ha_rows *examined_rows, ha_rows *found_rows,
               ha_rows *returned_rows);
@@ -18,10 +18,19 @@
 #include <string.h>
 #include <algorithm>
 #include <cmath>
+#include <deque>
+#include <functional>
+#include <vector>
 
 #include "my_dbug.h"
 #include "my_io.h"
 #include "my_pointer_arithmetic.h"
+#include "my_sys.h"
+#include "my_thread.h"
+#include "myisampack.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_thread.h"
 #include "mysql/udf_registration_types.h"
 #include "sql/cmp_varlen_keys.h"
 #include "sql/opt_costmodel.h"
@@ -33,6 +42,8 @@ extern "C" {
 PSI_memory_key key_memory_Filesort_buffer_sort_keys;
 }
 
+ulong sort_worker_threads= 16;
+
 namespace {
 /**
   A local helper function. See comments for get_merge_buffers_cost().
@@ -229,8 +240,400 @@ private:
 };
 
 
+/**
+  A key to be sorted by radix_sort_keys(), and its first eight bytes
+  stored as a big-endian integer.
+*/
+struct Radix_sort_key
+{
+  ulonglong prefix;
+  uchar *key;
+};
+
+/// Ranges with fewer keys are sorted by comparison rather than by radix.
+const size_t RADIX_SORT_CUTOFF= 64;
+
+/// Buffers with fewer keys are not sorted with radix_sort_keys().
+const size_t RADIX_SORT_MIN_KEYS= 1024;
+
+static_assert(2 * sizeof(Radix_sort_key) <= RADIX_SORT_SPACE_PER_KEY,
+              "radix_sort_keys() needs two Radix_sort_key per key");
+
+/**
+  Sorts keys [0, count) by the bytes byte_no, ..., 7 of their prefixes,
+  then by the rest of the keys, using tmp as work space.
+
+  All keys of the range have the same bytes 0, ..., byte_no - 1 of their
+  prefixes.
+*/
+void radix_sort_range(Radix_sort_key *keys, Radix_sort_key *tmp,
+                      size_t count, size_t key_len, uint byte_no)
+{
+  const auto compare_rest= [key_len](const Radix_sort_key &k1,
+                                     const Radix_sort_key &k2)
+  {
+    if (k1.prefix != k2.prefix)
+      return k1.prefix < k2.prefix;
+    return key_len > 8 && memcmp(k1.key + 8, k2.key + 8, key_len - 8) < 0;
+  };
+
+  for (; byte_no < 8 && byte_no < key_len; byte_no++)
+  {
+    if (count < RADIX_SORT_CUTOFF)
+      break;
+
+    // Count the keys in each bucket, and find where each bucket starts.
+    const uint shift= 56 - 8 * byte_no;
+    uint starts[256 + 1]= {0};
+    for (size_t i= 0; i < count; i++)
+      starts[((keys[i].prefix >> shift) & 0xff) + 1]++;
+    bool one_bucket= false;
+    for (uint digit= 0; digit < 256; digit++)
+    {
+      one_bucket|= (starts[digit + 1] == count);
+      starts[digit + 1]+= starts[digit];
+    }
+    if (one_bucket)
+      continue;                     // All keys have the same byte
+
+    uint next[256];
+    memcpy(next, starts, sizeof(next));
+    for (size_t i= 0; i < count; i++)
+      tmp[next[(keys[i].prefix >> shift) & 0xff]++]= keys[i];
+    memcpy(keys, tmp, count * sizeof(Radix_sort_key));
+
+    for (uint digit= 0; digit < 256; digit++)
+    {
+      const uint bucket_size= starts[digit + 1] - starts[digit];
+      if (bucket_size > 1)
+        radix_sort_range(keys + starts[digit], tmp + starts[digit],
+                         bucket_size, key_len, byte_no + 1);
+    }
+    return;
+  }
+
+  // Short range, or the prefixes are all equal.
+  const bool prefixes_sorted= byte_no >= std::min<size_t>(key_len, 8);
+  if (count > 1 && !(prefixes_sorted && key_len <= 8))
+    std::stable_sort(keys, keys + count, compare_rest);
+}
+
+/**
+  Minimum number of keys for a thread to sort. Smaller buffers are sorted
+  by fewer threads, the cost of starting a thread would not be recovered.
+*/
+const size_t MIN_KEYS_PER_SORT_THREAD= 16384;
+
+/**
+  A set of tasks submitted by one sort. The tasks are claimed one at a time,
+  under LOCK_sort_workers, by the workers of the pool and by the thread that
+  submitted them.
+*/
+struct Sort_tasks
+{
+  const std::function<void(size_t)> *func;
+  size_t num_tasks;
+  /// The first task that has not been claimed yet
+  size_t next_task;
+  /// Number of tasks that workers have claimed and not finished
+  size_t running;
+};
+
+bool sort_workers_inited= false;
+bool sort_workers_terminate= false;
+/// The threads of the pool, at most sort_worker_threads
+std::vector<my_thread_handle> sort_worker_ids;
+/// Number of threads waiting for tasks
+size_t idle_sort_workers= 0;
+/// Sets of tasks that still have unclaimed tasks
+std::deque<Sort_tasks*> sort_task_queue;
+
+/// Protects all of the above, and the claiming of tasks
+mysql_mutex_t LOCK_sort_workers;
+/// Signalled when tasks are queued, and at shutdown
+mysql_cond_t COND_sort_workers;
+/// Signalled when a worker has finished the last task it ran of a set
+mysql_cond_t COND_sort_tasks_done;
+
+#ifdef HAVE_PSI_INTERFACE
+PSI_mutex_key key_LOCK_sort_workers;
+PSI_cond_key key_COND_sort_workers;
+PSI_cond_key key_COND_sort_tasks_done;
+PSI_thread_key key_thread_sort_worker;
+
+PSI_mutex_info sort_worker_mutexes[]=
+{
+  { &key_LOCK_sort_workers, "LOCK_sort_workers", PSI_FLAG_SINGLETON, 0,
+    PSI_DOCUMENT_ME}
+};
+
+PSI_cond_info sort_worker_conds[]=
+{
+  { &key_COND_sort_workers, "COND_sort_workers", PSI_FLAG_SINGLETON, 0,
+    PSI_DOCUMENT_ME},
+  { &key_COND_sort_tasks_done, "COND_sort_tasks_done", PSI_FLAG_SINGLETON,
+    0, PSI_DOCUMENT_ME}
+};
+
+PSI_thread_info sort_worker_threads_info[]=
+{
+  { &key_thread_sort_worker, "sort_worker", 0, 0, PSI_DOCUMENT_ME}
+};
+#endif
+
+
+/**
+  Claim the next task of a set, and remove the set from the queue when its
+  last task is claimed.
+
+  @pre LOCK_sort_workers is held by the caller.
+
+  @param tasks      the set of tasks
+  @param[out] task  the task claimed
+
+  @retval true if a task was claimed
+  @retval false if all the tasks have been claimed already
+*/
+bool claim_sort_task(Sort_tasks *tasks, size_t *task)
+{
+  mysql_mutex_assert_owner(&LOCK_sort_workers);
+  if (tasks->next_task == tasks->num_tasks)
+    return false;
+  *task= tasks->next_task++;
+  if (tasks->next_task == tasks->num_tasks)
+    sort_task_queue.erase(std::find(sort_task_queue.begin(),
+                                    sort_task_queue.end(), tasks));
+  return true;
+}
+
+
+extern "C" void *sort_worker_thread(void *)
+{
+  my_thread_init();
+  DBUG_ENTER("sort_worker_thread");
+
+  mysql_mutex_lock(&LOCK_sort_workers);
+  for (;;)
+  {
+    while (sort_task_queue.empty() && !sort_workers_terminate)
+    {
+      idle_sort_workers++;
+      mysql_cond_wait(&COND_sort_workers, &LOCK_sort_workers);
+      idle_sort_workers--;
+    }
+    if (sort_workers_terminate)
+      break;
+
+    Sort_tasks *tasks= sort_task_queue.front();
+    size_t task;
+    claim_sort_task(tasks, &task);
+    tasks->running++;
+    mysql_mutex_unlock(&LOCK_sort_workers);
+
+    (*tasks->func)(task);
+
+    mysql_mutex_lock(&LOCK_sort_workers);
+    // The submitting thread returns, and frees tasks, once this is 0.
+    if (--tasks->running == 0)
+      mysql_cond_broadcast(&COND_sort_tasks_done);
+  }
+  mysql_mutex_unlock(&LOCK_sort_workers);
+
+  DBUG_LEAVE;
+  my_thread_end();
+  my_thread_exit(0);
+  return 0;
+}
+
+
+/**
+  Add a thread to the pool.
+
+  @pre LOCK_sort_workers is held by the caller.
+
+  @retval true if the thread could not be created
+*/
+bool start_sort_worker()
+{
+  mysql_mutex_assert_owner(&LOCK_sort_workers);
+  my_thread_attr_t attr;
+  if (my_thread_attr_init(&attr))
+    return true;
+
+  my_thread_handle id;
+  const bool error= mysql_thread_create(key_thread_sort_worker, &id, &attr,
+                                        sort_worker_thread, nullptr) != 0;
+  if (!error)
+    sort_worker_ids.push_back(id);
+
+  (void) my_thread_attr_destroy(&attr);
+  return error;
+}
+
+
+/**
+  Calls func(0), ..., func(num_tasks - 1) on the threads of the pool and on
+  the calling thread, and returns when all of them have finished.
+
+  The pool has at most sort_worker_threads threads for the whole server;
+  they are started when they are first needed and kept until shutdown.
+  The calling thread runs the tasks that no worker has claimed, so all of
+  them are run by the calling thread when the pool is busy or empty.
+*/
+void run_sort_tasks(size_t num_tasks, const std::function<void(size_t)> &func)
+{
+  if (num_tasks > 1 && sort_workers_inited)
+  {
+    Sort_tasks tasks= { &func, num_tasks, 0, 0 };
+    mysql_mutex_lock(&LOCK_sort_workers);
+    sort_task_queue.push_back(&tasks);
+    // Start threads for the tasks that the idle ones will not take.
+    for (size_t i= idle_sort_workers;
+         i < num_tasks - 1 && sort_worker_ids.size() < sort_worker_threads;
+         ++i)
+    {
+      if (start_sort_worker())
+        break;
+    }
+    mysql_cond_broadcast(&COND_sort_workers);
+
+    size_t task;
+    while (claim_sort_task(&tasks, &task))
+    {
+      mysql_mutex_unlock(&LOCK_sort_workers);
+      func(task);
+      mysql_mutex_lock(&LOCK_sort_workers);
+    }
+    while (tasks.running != 0)
+      mysql_cond_wait(&COND_sort_tasks_done, &LOCK_sort_workers);
+    mysql_mutex_unlock(&LOCK_sort_workers);
+    return;
+  }
+
+  for (size_t i= 0; i < num_tasks; ++i)
+    func(i);
+}
+
+/**
+  Sorts the keys [first, first + count) on up to num_threads threads.
+
+  The keys are split in segments of about the same size, which are sorted
+  in parallel. Neighbouring segments are then merged pairwise, each pair
+  on its own thread, until all of them are merged. std::inplace_merge is
+  stable, so the result is stable if the segments are sorted stably.
+
+  @param first        the keys to sort
+  @param count        number of keys
+  @param comp         key comparison
+  @param sort_segment sorts the keys [begin, end) of a segment
+  @param num_threads  maximum number of threads to use
+*/
+template <class Comp, class Sort>
+void sort_keys(uchar **first, size_t count, Comp comp, Sort sort_segment,
+               size_t num_threads)
+{
+  num_threads= std::min(num_threads, count / MIN_KEYS_PER_SORT_THREAD);
+  if (num_threads <= 1)
+  {
+    sort_segment(first, first + count);
+    return;
+  }
+
+  std::vector<uchar **> bounds;
+  for (size_t i= 0; i <= num_threads; ++i)
+    bounds.push_back(first + count * i / num_threads);
+
+  run_sort_tasks(num_threads, [&](size_t i)
+  {
+    sort_segment(bounds[i], bounds[i + 1]);
+  });
+
+  while (bounds.size() > 2)
+  {
+    const size_t num_segments= bounds.size() - 1;
+    run_sort_tasks(num_segments / 2, [&](size_t i)
+    {
+      std::inplace_merge(bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2],
+                         comp);
+    });
+    // Keep the bounds of the merged segments, and of an odd last segment.
+    std::vector<uchar **> merged;
+    for (size_t i= 0; i < num_segments; i+= 2)
+      merged.push_back(bounds[i]);
+    merged.push_back(bounds[num_segments]);
+    bounds.swap(merged);
+  }
+}
+
 } // namespace
 
+
+void sort_worker_pool_init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", sort_worker_mutexes,
+                       static_cast<int>(array_elements(sort_worker_mutexes)));
+  mysql_cond_register("sql", sort_worker_conds,
+                      static_cast<int>(array_elements(sort_worker_conds)));
+  mysql_thread_register("sql", sort_worker_threads_info,
+                        static_cast<int>(
+                          array_elements(sort_worker_threads_info)));
+#endif
+  mysql_mutex_init(key_LOCK_sort_workers, &LOCK_sort_workers,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_sort_workers, &COND_sort_workers);
+  mysql_cond_init(key_COND_sort_tasks_done, &COND_sort_tasks_done);
+  sort_workers_inited= true;
+}
+
+
+void sort_worker_pool_free()
+{
+  if (!sort_workers_inited)
+    return;
+
+  mysql_mutex_lock(&LOCK_sort_workers);
+  DBUG_ASSERT(sort_task_queue.empty());
+  sort_workers_terminate= true;
+  mysql_cond_broadcast(&COND_sort_workers);
+  mysql_mutex_unlock(&LOCK_sort_workers);
+
+  for (my_thread_handle &id : sort_worker_ids)
+    my_thread_join(&id, NULL);
+  sort_worker_ids.clear();
+
+  mysql_cond_destroy(&COND_sort_tasks_done);
+  mysql_cond_destroy(&COND_sort_workers);
+  mysql_mutex_destroy(&LOCK_sort_workers);
+  sort_workers_inited= false;
+  sort_workers_terminate= false;
+}
+
+
+void radix_sort_keys(uchar **keys, size_t count, size_t key_len,
+                     uchar *work_space)
+{
+  if (count < 2 || key_len == 0)
+    return;
+
+  Radix_sort_key *const radix_keys=
+    reinterpret_cast<Radix_sort_key*>(work_space);
+
+  for (size_t i= 0; i < count; i++)
+  {
+    uchar prefix[8]= {0, 0, 0, 0, 0, 0, 0, 0};
+    memcpy(prefix, keys[i], std::min<size_t>(key_len, sizeof(prefix)));
+    radix_keys[i].prefix= mi_uint8korr(prefix);
+    radix_keys[i].key= keys[i];
+  }
+
+  radix_sort_range(radix_keys, radix_keys + count, count, key_len, 0);
+
+  for (size_t i= 0; i < count; i++)
+    keys[i]= radix_keys[i].key;
+}
+
+
 void Filesort_buffer::sort_buffer(Sort_param *param, uint count)
 {
   const bool force_stable_sort= param->m_force_stable_sort;
@@ -250,20 +653,23 @@ void Filesort_buffer::sort_buffer(Sort_param *param, uint count)
 
   if (param->using_varlen_keys())
   {
+    // TODO: Make more elaborate heuristics than just always picking std::sort.
+    const Mem_compare_varlen_key comp(param->local_sortorder, param->use_hash);
     if (force_stable_sort)
     {
       param->m_sort_algorithm= Sort_param::FILESORT_ALG_STD_STABLE;
-      std::stable_sort(m_sort_keys, m_sort_keys + count,
-                Mem_compare_varlen_key(param->local_sortorder,
-                                       param->use_hash));
+      sort_keys(m_sort_keys, count, comp,
+                [&comp](uchar **begin, uchar **end)
+                { std::stable_sort(begin, end, comp); },
+                param->m_sort_threads);
     }
     else
     {
-      // TODO: Make more elaborate heuristics than just always picking std::sort.
       param->m_sort_algorithm= Sort_param::FILESORT_ALG_STD_SORT;
-      std::sort(m_sort_keys, m_sort_keys + count,
-                Mem_compare_varlen_key(param->local_sortorder,
-                                       param->use_hash));
+      sort_keys(m_sort_keys, count, comp,
+                [&comp](uchar **begin, uchar **end)
+                { std::sort(begin, end, comp); },
+                param->m_sort_threads);
     }
     return;
   }
@@ -303,12 +709,57 @@ void Filesort_buffer::sort_buffer(Sort_param *param, uint count)
                 !param->using_varlen_keys());
     compare_len-= param->ref_length; // ref was added last
   }
+  /*
+    The keys are compared with memcmp(), so large buffers can be sorted by
+    radix. Each thread sorts at least MIN_KEYS_PER_SORT_THREAD keys, more
+    than RADIX_SORT_MIN_KEYS, so the segments of a parallel sort are sorted
+    by radix too.
+
+    The work space of the radix sort is the unused part of the sort buffer,
+    between the records and the record pointers, so that the sort stays
+    within sort_buffer_size. A buffer without room for it is sorted by
+    std::stable_sort.
+  */
+  const size_t work_offset= ALIGN_SIZE(space_used_for_data());
+  const size_t keys_offset= reinterpret_cast<uchar*>(m_sort_keys) - m_rawmem;
+  if (count >= RADIX_SORT_MIN_KEYS && work_offset <= keys_offset &&
+      keys_offset - work_offset >= count * RADIX_SORT_SPACE_PER_KEY)
+  {
+    param->m_sort_algorithm= Sort_param::FILESORT_ALG_RADIX;
+    uchar **const keys= m_sort_keys;
+    uchar *const work_space= m_rawmem + work_offset;
+    const auto radix_sort= [compare_len, keys, work_space](uchar **begin,
+                                                           uchar **end)
+    {
+      // Each segment uses the part of the work space for its keys.
+      radix_sort_keys(begin, end - begin, compare_len,
+                      work_space + (begin - keys) * RADIX_SORT_SPACE_PER_KEY);
+    };
+    if (compare_len < 10)
+      sort_keys(m_sort_keys, count, Mem_compare(compare_len), radix_sort,
+                param->m_sort_threads);
+    else
+      sort_keys(m_sort_keys, count, Mem_compare_longkey(compare_len),
+                radix_sort, param->m_sort_threads);
+    return;
+  }
+
   param->m_sort_algorithm= Sort_param::FILESORT_ALG_STD_STABLE;
   // Heuristics here: avoid function overhead call for short keys.
   if (compare_len < 10)
-    std::stable_sort(m_sort_keys, m_sort_keys + count,
-                     Mem_compare(compare_len));
+  {
+    const Mem_compare comp(compare_len);
+    sort_keys(m_sort_keys, count, comp,
+              [&comp](uchar **begin, uchar **end)
+              { std::stable_sort(begin, end, comp); },
+              param->m_sort_threads);
+  }
   else
-    std::stable_sort(m_sort_keys, m_sort_keys + count,
-                     Mem_compare_longkey(compare_len));
+  {
+    const Mem_compare_longkey comp(compare_len);
+    sort_keys(m_sort_keys, count, comp,
+              [&comp](uchar **begin, uchar **end)
+              { std::stable_sort(begin, end, comp); },
+              param->m_sort_threads);
+  }
 }
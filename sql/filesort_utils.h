@@ -56,6 +56,48 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
                                       const Cost_model_table *cost_model);
 
 
+/**
+  Sorts keys that can be compared with memcmp(), with a most significant
+  digit radix sort.
+
+  The first eight bytes of every key are copied, in big-endian order, next
+  to the pointer to the key, and the (prefix, pointer) pairs are sorted one
+  byte at a time by counting sort. This works on a contiguous array without
+  reading the keys again. Ranges shorter than a few dozen keys, and keys
+  with equal prefixes, are sorted by comparison instead. The sort is
+  stable.
+
+  @param keys        Pointers to the keys to be sorted.
+  @param count       Number of keys.
+  @param key_len     Number of bytes of each key to compare.
+  @param work_space  count * RADIX_SORT_SPACE_PER_KEY bytes, aligned
+                     with ALIGN_SIZE().
+
+  @note
+    Declared here in order to be able to unit test it.
+*/
+
+void radix_sort_keys(uchar **keys, size_t count, size_t key_len,
+                     uchar *work_space);
+
+/// Bytes of work space that radix_sort_keys() needs for each key
+const size_t RADIX_SORT_SPACE_PER_KEY= 32;
+
+
+/**
+  Maximum number of threads in the server that help sessions sort their
+  filesort buffers, see @@session.sort_threads. 0 means that every buffer
+  is sorted by the session that fills it.
+*/
+extern ulong sort_worker_threads;
+
+/// Initialize the pool of sort worker threads, which starts out empty
+void sort_worker_pool_init();
+
+/// Stop the threads of the pool and free it
+void sort_worker_pool_free();
+
+
 /**
   A wrapper class around the buffer used by filesort().
   The sort buffer is a contiguous chunk of memory,
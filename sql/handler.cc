@@ -30,15 +30,18 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
+#include <algorithm>
 #include <atomic>
 #include <cmath>
 #include <list>
 #include <random>                     // std::uniform_real_distribution
 #include <string>
+#include <vector>
 
 #include "binary_log_types.h"
 #include "binlog_event.h"
 #include "keycache.h"
+#include "map_helpers.h"
 #include "m_ctype.h"
 #include "m_string.h"
 #include "my_bit.h"                   // my_count_bits
@@ -79,6 +82,8 @@
 #include "sql/derror.h"               // ER_DEFAULT
 #include "sql/error_handler.h"        // Internal_error_handler
 #include "sql/field.h"
+#include "sql/histograms/auto_update.h" // histograms::note_changed_rows
+#include "sql/histograms/histogram.h" // histograms::Histogram
 #include "sql/item.h"
 #include "sql/lock.h"                 // MYSQL_LOCK
 #include "sql/log.h"
@@ -88,6 +93,7 @@
 #include "sql/opt_costconstantcache.h" // reload_optimizer_cost_constants
 #include "sql/opt_costmodel.h"
 #include "sql/opt_hints.h"
+#include "sql/opt_range.h"            // store_key_image_to_rec
 #include "sql/protocol.h"
 #include "sql/psi_memory_key.h"
 #include "sql/query_options.h"
@@ -110,6 +116,7 @@
 #include "sql/sql_servers.h"
 #include "sql/sql_table.h"            // build_table_filename
 #include "sql/table.h"
+#include "sql/table_version.h"        // table_version_note_write
 #include "sql/tc_log.h"
 #include "sql/thr_malloc.h"
 #include "sql/transaction.h"          // trans_commit_implicit
@@ -1873,6 +1880,7 @@ end:
   {
     trn_ctx->cleanup();
     thd->tx_priority= 0;
+    table_version_end_transaction(thd);
   }
 
   if (need_clear_owned_gtid)
@@ -2145,6 +2153,7 @@ int ha_rollback_trans(THD *thd, bool all)
   {
     trn_ctx->cleanup();
     thd->tx_priority= 0;
+    table_version_end_transaction(thd);
   }
 
   if (all)
@@ -6402,6 +6411,381 @@ static bool key_uses_partial_cols(TABLE *table, uint keyno)
  * Default MRR implementation (MRR to non-MRR converter)
  ***************************************************************************/
 
+/**
+  Number of ranges for which the default MRR implementation always calls
+  records_in_range(). Ranges beyond this are sampled, see
+  handler::multi_range_read_info_const().
+*/
+static const uint RANGE_DIVE_SAMPLE_THRESHOLD= 200;
+
+/// Number of sampled ranges after which the sampling stride is doubled
+static const uint RANGE_DIVE_SAMPLES= 32;
+
+/// Number of ranges estimated with one call to ha_records_in_ranges()
+static const uint RANGE_ESTIMATE_BATCH= 64;
+
+/// Maximum number of estimates in the Range_estimate_cache of a handler
+static const size_t RANGE_ESTIMATE_CACHE_SIZE= 4096;
+
+/**
+  Maximum memory used by the Range_estimate_cache of all handlers, as
+  there is one per open table instance.
+*/
+static const size_t RANGE_ESTIMATE_CACHE_MEMORY= 16 * 1024 * 1024;
+
+/// Memory accounted for the Range_estimate_cache of all handlers
+static std::atomic<size_t> range_estimate_cache_memory(0);
+
+
+/**
+  Recent estimates of the number of rows in index ranges, made by
+  records_in_ranges() of one handler.
+
+  The estimates are reused while the version of the table, see
+  table_version(), is unchanged, that is until the table is next locked
+  for writing. Estimates are not added when the cache is full, or when the
+  caches of all handlers use RANGE_ESTIMATE_CACHE_MEMORY, so a statement
+  with more ranges than fit does not evict the ranges of the others.
+*/
+
+class Range_estimate_cache
+{
+public:
+  ~Range_estimate_cache() { clear(); }
+
+  /// Forgets the estimates if the table has changed since they were made
+  void validate(ulonglong table_version)
+  {
+    if (table_version != m_table_version)
+    {
+      clear();
+      m_table_version= table_version;
+    }
+  }
+
+  /// @returns the cached number of rows in the range, or HA_POS_ERROR
+  ha_rows find(uint keyno, const Range_estimate &range)
+  {
+    make_key(keyno, range);
+    const auto it= m_estimates.find(m_key);
+    return it == m_estimates.end() ? HA_POS_ERROR : it->second;
+  }
+
+  void store(uint keyno, const Range_estimate &range)
+  {
+    if (m_estimates.size() >= RANGE_ESTIMATE_CACHE_SIZE)
+      return;
+    make_key(keyno, range);
+    const size_t size= entry_size(m_key);
+    if (range_estimate_cache_memory.fetch_add(size) + size >
+        RANGE_ESTIMATE_CACHE_MEMORY)
+    {
+      range_estimate_cache_memory.fetch_sub(size);
+      return;
+    }
+    if (m_estimates.emplace(m_key, range.rows).second)
+      m_memory+= size;
+    else
+      range_estimate_cache_memory.fetch_sub(size);
+  }
+
+private:
+  /// @returns the memory accounted for an estimate
+  static size_t entry_size(const std::string &key)
+  {
+    return key.size() + sizeof(std::pair<const std::string, ha_rows>) +
+           2 * sizeof(void *);
+  }
+
+  void clear()
+  {
+    m_estimates.clear();
+    range_estimate_cache_memory.fetch_sub(m_memory);
+    m_memory= 0;
+  }
+
+  void add_bound(const key_range *bound)
+  {
+    if (bound == NULL)
+    {
+      m_key.push_back('\0');
+      return;
+    }
+    m_key.push_back(static_cast<char>(bound->flag + 1));
+    m_key.append(reinterpret_cast<const char *>(&bound->keypart_map),
+                 sizeof(bound->keypart_map));
+    m_key.append(reinterpret_cast<const char *>(bound->key), bound->length);
+  }
+
+  /// Stores the index number and the bounds of the range in m_key
+  void make_key(uint keyno, const Range_estimate &range)
+  {
+    m_key.assign(reinterpret_cast<const char *>(&keyno), sizeof(keyno));
+    add_bound(range.min_key);
+    add_bound(range.max_key);
+  }
+
+  malloc_unordered_map<std::string, ha_rows>
+    m_estimates{key_memory_range_estimate_cache};
+  /// Memory accounted for the estimates
+  size_t m_memory= 0;
+  /// Version of the table when the estimates were made
+  ulonglong m_table_version= 0;
+  /// Buffer for the key of a range
+  std::string m_key;
+};
+
+
+void handler::free_range_estimate_cache()
+{
+  delete m_range_estimate_cache;
+  m_range_estimate_cache= nullptr;
+}
+
+
+void handler::records_in_ranges(uint inx, Range_estimate *ranges,
+                                uint n_ranges)
+{
+  for (uint i= 0; i < n_ranges; i++)
+    ranges[i].rows= records_in_range(inx, ranges[i].min_key,
+                                     ranges[i].max_key);
+}
+
+
+void handler::ha_records_in_ranges(uint inx, Range_estimate *ranges,
+                                   uint n_ranges)
+{
+  DBUG_ENTER("handler::ha_records_in_ranges");
+
+  /*
+    Temporary tables and tables with foreign keys have no versions, the
+    latter as cascading actions change them without locking them. The
+    estimates of a partitioned table are summed over the partitions left
+    after pruning, which the key of an estimate does not include.
+  */
+  if (!table_version_is_tracked(table_share) || table->part_info != nullptr ||
+      (m_range_estimate_cache == nullptr &&
+       !(m_range_estimate_cache= new (std::nothrow) Range_estimate_cache)))
+  {
+    records_in_ranges(inx, ranges, n_ranges);
+    DBUG_VOID_RETURN;
+  }
+  m_range_estimate_cache->validate(table_version(table_share));
+
+  /*
+    The ranges which are not cached are estimated with one call for each
+    RANGE_ESTIMATE_BATCH ranges, keeping their order.
+  */
+  Range_estimate misses[RANGE_ESTIMATE_BATCH];
+  uint miss_index[RANGE_ESTIMATE_BATCH];
+  for (uint first= 0; first < n_ranges; first+= RANGE_ESTIMATE_BATCH)
+  {
+    const uint end= std::min(n_ranges, first + RANGE_ESTIMATE_BATCH);
+    uint n_misses= 0;
+    for (uint i= first; i < end; i++)
+    {
+      ranges[i].rows= m_range_estimate_cache->find(inx, ranges[i]);
+      if (ranges[i].rows == HA_POS_ERROR)
+      {
+        misses[n_misses]= ranges[i];
+        miss_index[n_misses++]= i;
+      }
+    }
+    if (n_misses == 0)
+      continue;
+
+    records_in_ranges(inx, misses, n_misses);
+    for (uint j= 0; j < n_misses; j++)
+    {
+      ranges[miss_index[j]].rows= misses[j].rows;
+      if (misses[j].rows != HA_POS_ERROR)
+        m_range_estimate_cache->store(inx, misses[j]);
+    }
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Ranges collected by handler::multi_range_read_info_const() to be
+  estimated with one call to handler::ha_records_in_ranges(). The keys are
+  copied, as the range sequence reuses its buffers.
+*/
+
+class Range_estimate_batch
+{
+public:
+  Range_estimate_batch(handler *h, uint keyno)
+    : m_handler(h), m_keyno(keyno), m_size(0)
+  {}
+
+  bool is_full() const { return m_size == RANGE_ESTIMATE_BATCH; }
+
+  /**
+    Adds a range to the batch.
+
+    @param min_key  Start of the range, or NULL
+    @param max_key  End of the range, or NULL
+    @param sampled  Whether the range is a sample of the skipped ranges
+  */
+  void add(const key_range *min_key, const key_range *max_key, bool sampled)
+  {
+    DBUG_ASSERT(!is_full());
+    add_bound(min_key, &m_bounds[m_size][0], &m_key_offsets[m_size][0]);
+    add_bound(max_key, &m_bounds[m_size][1], &m_key_offsets[m_size][1]);
+    m_ranges[m_size].min_key= min_key ? &m_bounds[m_size][0] : NULL;
+    m_ranges[m_size].max_key= max_key ? &m_bounds[m_size][1] : NULL;
+    m_sampled[m_size]= sampled;
+    m_size++;
+  }
+
+  /**
+    Estimates the ranges in the batch, and empties it.
+
+    @param[in,out] total_rows    Incremented by the rows in all ranges
+    @param[in,out] sampled_rows  Incremented by the rows in sampled ranges
+
+    @retval true   The number of rows in some range cannot be estimated
+    @retval false  Success
+  */
+  bool estimate(ha_rows *total_rows, ha_rows *sampled_rows)
+  {
+    if (m_size == 0)
+      return false;
+
+    // The buffer may have been reallocated while the keys were added
+    for (uint i= 0; i < m_size; i++)
+    {
+      m_bounds[i][0].key= m_keys.data() + m_key_offsets[i][0];
+      m_bounds[i][1].key= m_keys.data() + m_key_offsets[i][1];
+    }
+    DBUG_EXECUTE_IF("crash_records_in_range", DBUG_SUICIDE(););
+    m_handler->ha_records_in_ranges(m_keyno, m_ranges, m_size);
+
+    const uint size= m_size;
+    m_size= 0;
+    m_keys.clear();
+    for (uint i= 0; i < size; i++)
+    {
+      /* Can't scan one range => can't do MRR scan at all */
+      if (m_ranges[i].rows == HA_POS_ERROR)
+        return true;
+      *total_rows+= m_ranges[i].rows;
+      if (m_sampled[i])
+        *sampled_rows+= m_ranges[i].rows;
+    }
+    return false;
+  }
+
+private:
+  void add_bound(const key_range *key, key_range *bound, size_t *offset)
+  {
+    *offset= m_keys.size();
+    if (key == NULL)
+      return;
+    *bound= *key;
+    m_keys.insert(m_keys.end(), key->key, key->key + key->length);
+  }
+
+  handler *const m_handler;
+  const uint m_keyno;
+  uint m_size;
+  Range_estimate m_ranges[RANGE_ESTIMATE_BATCH];
+  key_range m_bounds[RANGE_ESTIMATE_BATCH][2];
+  size_t m_key_offsets[RANGE_ESTIMATE_BATCH][2];
+  bool m_sampled[RANGE_ESTIMATE_BATCH];
+  /// Bytes of the keys of the ranges
+  std::vector<uchar> m_keys;
+};
+
+
+/**
+  Estimate the number of rows in a range from the histogram on the first
+  column of the index. This is used for ranges where records_in_range() is
+  not called, so that the estimate reflects the distribution of the values
+  in the range rather than the average number of rows per key value.
+
+  @param table         the table
+  @param keyno         the index the range is over
+  @param min_key       start of the range, NULL if there is no lower bound
+  @param max_key       end of the range, NULL if there is no upper bound
+  @param [out] rows    the estimated number of rows in the range
+
+  @return true if the range cannot be estimated from a histogram, false
+          otherwise
+*/
+static bool histogram_records_in_range(TABLE *table, uint keyno,
+                                       const key_range *min_key,
+                                       const key_range *max_key,
+                                       ha_rows *rows)
+{
+  const KEY_PART_INFO *const key_part= table->key_info[keyno].key_part;
+
+  // Only ranges over the whole first keypart can be estimated
+  if ((min_key && min_key->keypart_map != 1) ||
+      (max_key && max_key->keypart_map != 1) ||
+      (key_part->key_part_flag & HA_PART_KEY_SEG))
+    return true;
+
+  Field *const field= key_part->field;
+  const histograms::Histogram *const histogram=
+    table->s->find_histogram(field->field_index);
+  if (histogram == nullptr)
+    return true;
+
+  my_bitmap_map *old_sets[2];
+  dbug_tmp_use_all_columns(table, old_sets, table->read_set, table->write_set);
+
+  double selectivity= histogram->get_non_null_values_frequency();
+  double excluded= 0.0;
+  bool error= false;
+  if (min_key != NULL)
+  {
+    store_key_image_to_rec(field, const_cast<uchar*>(min_key->key),
+                           key_part->length);
+    // A NULL lower bound only excludes the NULL values
+    if (!field->is_null())
+    {
+      error= histogram->get_selectivity(field,
+                                        histograms::enum_operator::LESS_THAN,
+                                        &excluded);
+      selectivity-= excluded;
+      if (!error && min_key->flag == HA_READ_AFTER_KEY)
+      {
+        error= histogram->get_selectivity(field,
+                                          histograms::enum_operator::EQUALS_TO,
+                                          &excluded);
+        selectivity-= excluded;
+      }
+    }
+  }
+  if (!error && max_key != NULL)
+  {
+    store_key_image_to_rec(field, const_cast<uchar*>(max_key->key),
+                           key_part->length);
+    error= histogram->get_selectivity(field,
+                                      histograms::enum_operator::GREATER_THAN,
+                                      &excluded);
+    selectivity-= excluded;
+    if (!error && max_key->flag == HA_READ_BEFORE_KEY)
+    {
+      error= histogram->get_selectivity(field,
+                                        histograms::enum_operator::EQUALS_TO,
+                                        &excluded);
+      selectivity-= excluded;
+    }
+  }
+
+  dbug_tmp_restore_column_maps(table->read_set, table->write_set, old_sets);
+  if (error)
+    return true;
+
+  const double estimate= std::max(selectivity, 0.0) *
+                         table->file->stats.records;
+  *rows= std::max(static_cast<ha_rows>(estimate), ha_rows(1));
+  return false;
+}
+
 /**
   Get cost and other information about MRR scan over a known list of ranges
 
@@ -6444,6 +6828,15 @@ handler::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
   ha_rows rows, total_rows= 0;
   uint n_ranges=0;
   THD *thd= current_thd;
+  /*
+    Ranges which need records_in_range(), and how many of them have been
+    estimated from the sampled ones instead, see 3) below. The ranges
+    to estimate are collected in a batch.
+  */
+  Range_estimate_batch batch(this, keyno);
+  uint n_dive_ranges= 0, n_skipped_dives= 0;
+  uint n_sampled_dives= 0, dive_stride= 1;
+  ha_rows sampled_rows= 0;
 
   /* Default MRR implementation doesn't need buffer */
   *bufsz= 0;
@@ -6484,10 +6877,24 @@ handler::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
            because the number of rows with this value are likely to be
            very different than the values in the index statistics.
 
-      Note: With SKIP_RECORDS_IN_RANGE, use Index statistics if:
+      Note: With SKIP_RECORDS_IN_RANGE, use the histogram on the first
+            column of the index if the range is over the first keypart only
+            and there is a histogram on that column. Otherwise, use Index
+            statistics if:
             a) Index statistics is available.
             b) The range is an equality range but the index is either not
                unique or all of the keyparts are not used.
+
+        3) More than RANGE_DIVE_SAMPLE_THRESHOLD ranges have needed
+           records_in_range(). Beyond that, only every dive_stride-th range
+           is estimated with records_in_range(), and the other ranges are
+           assumed to have the average number of rows of these sampled
+           ranges. dive_stride is doubled after every RANGE_DIVE_SAMPLES
+           samples, so that a list of N ranges needs O(log N) dives past
+           the threshold.
+
+      The ranges for which records_in_range() is needed are estimated in
+      batches through ha_records_in_ranges().
     */
     int keyparts_used= 0;
     if ((range.range_flag & UNIQUE_RANGE) &&                        // 1)
@@ -6496,7 +6903,10 @@ handler::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
     else if (range.range_flag & SKIP_RECORDS_IN_RANGE &&            // 2)
              !(range.range_flag & NULL_RANGE))
     {
-      if ((range.range_flag & EQ_RANGE) &&
+      if (!histogram_records_in_range(table, keyno, min_endp, max_endp,
+                                      &rows))
+        ; /* rows has been estimated from the histogram */
+      else if ((range.range_flag & EQ_RANGE) &&
           (keyparts_used= my_count_bits(range.start_key.keypart_map)) &&
           table->key_info[keyno].has_records_per_key(keyparts_used-1))
       {
@@ -6513,21 +6923,41 @@ handler::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
         rows= 1;
       }
     }
+    else if (++n_dive_ranges > RANGE_DIVE_SAMPLE_THRESHOLD &&        // 3)
+             (n_dive_ranges - RANGE_DIVE_SAMPLE_THRESHOLD) % dive_stride)
+    {
+      n_skipped_dives++;
+      continue;
+    }
     else
     {
-      DBUG_EXECUTE_IF("crash_records_in_range", DBUG_SUICIDE(););
       DBUG_ASSERT(min_endp || max_endp);
-      if (HA_POS_ERROR == (rows= this->records_in_range(keyno, min_endp, 
-                                                        max_endp)))
+      const bool sampled= n_dive_ranges > RANGE_DIVE_SAMPLE_THRESHOLD;
+      if (sampled && ++n_sampled_dives % RANGE_DIVE_SAMPLES == 0)
+        dive_stride*= 2;
+      batch.add(min_endp, max_endp, sampled);
+      if (batch.is_full() && batch.estimate(&total_rows, &sampled_rows))
       {
-        /* Can't scan one range => can't do MRR scan at all */
         total_rows= HA_POS_ERROR;
         break;
       }
+      continue;
     }
     total_rows += rows;
   }
 
+  if (total_rows != HA_POS_ERROR &&
+      batch.estimate(&total_rows, &sampled_rows))
+    total_rows= HA_POS_ERROR;
+
+  if (total_rows != HA_POS_ERROR && n_skipped_dives > 0)
+  {
+    /* Ranges are skipped only after the first RANGE_DIVE_SAMPLES samples */
+    DBUG_ASSERT(n_sampled_dives >= RANGE_DIVE_SAMPLES);
+    total_rows+= static_cast<ha_rows>(
+      static_cast<double>(sampled_rows) * n_skipped_dives / n_sampled_dives);
+  }
+
   if (total_rows != HA_POS_ERROR)
   {
     const Cost_model_table *const cost_model= table->cost_model();
@@ -8274,6 +8704,31 @@ int handler::ha_external_lock(THD *thd, int lock_type)
 
   if (error == 0)
   {
+    /*
+      Invalidate the cached results which read the table both when it is
+      locked and unlocked for writing, as non-transactional changes are
+      visible in between. Transactional changes invalidate them again when
+      the transaction ends.
+    */
+    if (lock_type == F_WRLCK)
+      table_version_note_write(thd, table_share);
+    else if (lock_type == F_UNLCK && m_lock_type == F_WRLCK &&
+             table_share->tmp_table == NO_TMP_TABLE)
+      table_version_bump(table_share->table_cache_key.str,
+                         table_share->table_cache_key.length);
+
+    /*
+      Account for the changed rows when the table is unlocked, so that the
+      histograms are updated when enough rows have changed. The handlers of
+      the partitions are accounted for by the partitioning handler.
+    */
+    if (lock_type == F_UNLCK && m_changed_rows > 0)
+    {
+      if (table->file == this)
+        histograms::note_changed_rows(table_share, m_changed_rows,
+                                      stats.records);
+      m_changed_rows= 0;
+    }
     /*
       The lock type is needed by MRR when creating a clone of this handler
       object.
@@ -8346,6 +8801,8 @@ int handler::ha_write_row(uchar *buf)
   if (unlikely(error))
     DBUG_RETURN(error);
 
+  m_changed_rows++;
+
   if (unlikely((error= binlog_log_row(table, 0, buf, log_func))))
     DBUG_RETURN(error); /* purecov: inspected */
 
@@ -8380,6 +8837,7 @@ int handler::ha_update_row(const uchar *old_data, uchar *new_data)
 
   if (unlikely(error))
     return error;
+  m_changed_rows++;
   if (unlikely((error= binlog_log_row(table, old_data, new_data, log_func))))
     return error;
   return 0;
@@ -8411,6 +8869,7 @@ int handler::ha_delete_row(const uchar *buf)
 
   if (unlikely(error))
     return error;
+  m_changed_rows++;
   if (unlikely((error= binlog_log_row(table, buf, 0, log_func))))
     return error;
   return 0;
@@ -67,6 +67,7 @@ class Create_field;
 class Field;
 class Item;
 class Partition_handler;
+class Range_estimate_cache;
 class Record_buffer;
 class SE_cost_constants;     // see opt_costconstants.h
 class String;
@@ -3062,6 +3063,17 @@ public:
 };
 
 
+/**
+  A range whose number of rows is estimated by handler::records_in_ranges().
+*/
+struct Range_estimate
+{
+  key_range *min_key;       ///< Start of the range, NULL if unbounded
+  key_range *max_key;       ///< End of the range, NULL if unbounded
+  ha_rows rows;             ///< Estimated number of rows in the range
+};
+
+
 /**
   The handler class is the interface for dynamically loadable
   storage engines. Do not add ifdefs and take care when adding or
@@ -3296,6 +3308,7 @@ public:
     scan_time()
     read_time()
     records_in_range()
+    records_in_ranges()
     estimate_rows_upper_bound()
     records()
 
@@ -3499,6 +3512,11 @@ public:
   };
 private:
   Record_buffer *m_record_buffer= nullptr;     ///< Buffer for multi-row reads.
+  /// Recent estimates of records_in_ranges(), see ha_records_in_ranges()
+  Range_estimate_cache *m_range_estimate_cache= nullptr;
+  void free_range_estimate_cache();
+  /// Rows written, updated and deleted since the table was locked
+  ha_rows m_changed_rows= 0;
   /*
     Storage space for the end range value. Should only be accessed using
     the end_range pointer. The content is invalid when end_range is NULL.
@@ -3696,6 +3714,7 @@ public:
     DBUG_ASSERT(m_psi_locker == NULL);
     DBUG_ASSERT(m_lock_type == F_UNLCK);
     DBUG_ASSERT(inited == NONE);
+    free_range_estimate_cache();
   }
   /*
     @todo reorganize functions, make proper public/protected/private qualifiers
@@ -4362,6 +4381,34 @@ public:
                                    key_range *min_key MY_ATTRIBUTE((unused)),
                                    key_range *max_key MY_ATTRIBUTE((unused)))
     { return (ha_rows) 10; }
+
+  /**
+    Find number of records in each of a sequence of ranges of an index.
+
+    The ranges are disjoint and sorted on the index, as the range optimizer
+    produces them, which lets an engine share work between neighbouring
+    ranges, e.g. the B-tree pages visited for one range and the next. The
+    default implementation calls records_in_range() for every range.
+
+    @param inx       Index number
+    @param ranges    The ranges. The number of rows in each range, or
+                     HA_POS_ERROR if it cannot be estimated, is stored in
+                     Range_estimate::rows.
+    @param n_ranges  Number of ranges
+  */
+
+  virtual void records_in_ranges(uint inx, Range_estimate *ranges,
+                                 uint n_ranges);
+
+  /**
+    Find number of records in each of a sequence of ranges of an index
+    through records_in_ranges(), reusing the estimates that this handler
+    made for the same ranges recently.
+
+    @see records_in_ranges()
+  */
+
+  void ha_records_in_ranges(uint inx, Range_estimate *ranges, uint n_ranges);
   /*
     If HA_PRIMARY_KEY_REQUIRED_FOR_POSITION is set, then it sets ref
     (reference to the row, aka position, with the primary key given in
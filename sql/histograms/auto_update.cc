@@ -0,0 +1,434 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "sql/histograms/auto_update.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "lex_string.h"
+#include "my_command.h"
+#include "my_dbug.h"
+#include "my_sys.h"
+#include "my_thread.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_thread.h"
+#include "sql/auth/sql_security_ctx.h"
+#include "sql/current_thd.h"
+#include "sql/dd/cache/dictionary_client.h"
+#include "sql/dd/types/column_statistics.h"
+#include "sql/histograms/histogram.h"
+#include "sql/mdl.h"
+#include "sql/mysqld.h"                // read_only
+#include "sql/sql_base.h"              // tdc_remove_table
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"               // lex_start
+#include "sql/sql_parse.h"             // mysql_reset_thd_for_next_command
+#include "sql/sql_planner.h"           // invalidate_saved_join_orders
+#include "sql/system_variables.h"
+#include "sql/table.h"
+#include "thr_lock.h"
+
+ulong histogram_auto_update_threshold= 0;
+
+namespace {
+
+/// A table whose histograms are to be updated
+struct Auto_update_request
+{
+  std::string db;
+  std::string table_name;
+  std::vector<std::string> columns;
+};
+
+/// @returns the key of a table in changed_rows
+std::string table_key(const char *db, size_t db_length,
+                      const char *table_name, size_t table_name_length)
+{
+  std::string key(db, db_length);
+  key.push_back('\0');
+  key.append(table_name, table_name_length);
+  return key;
+}
+
+/**
+  Rows changed in each table since its histograms were updated. Tables that
+  are waiting in the queue are not counted until they have been updated.
+*/
+std::unordered_map<std::string, ha_rows> changed_rows;
+
+/// Keys of the tables in the queue
+std::unordered_set<std::string> queued_tables;
+
+/// Tables whose histograms are to be updated
+std::deque<Auto_update_request> queue;
+
+bool auto_update_inited= false;
+bool thread_started= false;
+bool thread_terminate= false;
+my_thread_handle auto_update_thread_id;
+
+/// The session of the background thread, while it exists
+THD *auto_update_thd= nullptr;
+
+/// Protects all of the above
+mysql_mutex_t LOCK_histogram_auto_update;
+mysql_cond_t COND_histogram_auto_update;
+
+#ifdef HAVE_PSI_INTERFACE
+PSI_mutex_key key_LOCK_histogram_auto_update;
+PSI_cond_key key_COND_histogram_auto_update;
+PSI_thread_key key_thread_histogram_auto_update;
+
+PSI_mutex_info auto_update_mutexes[]=
+{
+  { &key_LOCK_histogram_auto_update, "LOCK_histogram_auto_update",
+    PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME}
+};
+
+PSI_cond_info auto_update_conds[]=
+{
+  { &key_COND_histogram_auto_update, "COND_histogram_auto_update",
+    PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME}
+};
+
+PSI_thread_info auto_update_threads[]=
+{
+  { &key_thread_histogram_auto_update, "histogram_auto_update",
+    PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME}
+};
+#endif
+
+
+/**
+  Find the number of buckets of the histograms the table has now. Columns
+  whose histogram has been dropped since the request was queued are left out,
+  so that the update does not create them again.
+
+  @param thd             thread handle
+  @param request         the table and its columns
+  @param[out] columns    the columns, grouped by their number of buckets
+
+  @retval true on error
+  @retval false on success
+*/
+bool current_histograms(THD *thd, const Auto_update_request &request,
+                        std::map<int, histograms::columns_set> *columns)
+{
+  dd::cache::Dictionary_client::Auto_releaser releaser(thd->dd_client());
+  MDL_request_list mdl_requests;
+  for (const std::string &column : request.columns)
+  {
+    MDL_request *mdl_request= new (thd->mem_root) MDL_request;
+    dd::String_type mdl_key=
+      dd::Column_statistics::create_mdl_key(request.db.c_str(),
+                                            request.table_name.c_str(),
+                                            column.c_str());
+    MDL_REQUEST_INIT(mdl_request, MDL_key::COLUMN_STATISTICS, "",
+                     mdl_key.c_str(), MDL_SHARED_READ, MDL_STATEMENT);
+    mdl_requests.push_front(mdl_request);
+  }
+
+  if (thd->mdl_context.acquire_locks(&mdl_requests,
+                                     thd->variables.lock_wait_timeout))
+    return true;
+
+  bool error= false;
+  for (const std::string &column : request.columns)
+  {
+    const histograms::Histogram *histogram= nullptr;
+    if (histograms::find_histogram(thd, request.db, request.table_name,
+                                   column, &histogram))
+    {
+      error= true;
+      break;
+    }
+
+    if (histogram != nullptr)
+    {
+      int num_buckets=
+        static_cast<int>(histogram->get_num_buckets_specified());
+      (*columns)[num_buckets].emplace(column);
+    }
+  }
+
+  thd->mdl_context.release_transactional_locks();
+  return error;
+}
+
+
+/**
+  Update the histograms of a table, with the number of buckets that was
+  specified when each of them was created.
+
+  @param thd      thread handle
+  @param request  the table and its columns
+*/
+void update_histograms(THD *thd, const Auto_update_request &request)
+{
+  std::map<int, histograms::columns_set> columns;
+  bool error= current_histograms(thd, request, &columns);
+
+  bool updated= false;
+  for (auto it= columns.begin(); !error && it != columns.end(); ++it)
+  {
+    lex_start(thd);
+    mysql_reset_thd_for_next_command(thd);
+
+    /*
+      Read the table with TL_READ, so that the update does not block
+      concurrent changes to the table.
+    */
+    TABLE_LIST table;
+    table.init_one_table(request.db.c_str(), request.db.length(),
+                         request.table_name.c_str(),
+                         request.table_name.length(),
+                         request.table_name.c_str(), TL_READ);
+
+    histograms::results_map results;
+    error= histograms::update_histogram(thd, &table, it->second, it->first,
+                                        results);
+    updated|= !error;
+    lex_end(thd->lex);
+  }
+
+  if (updated)
+  {
+    /*
+      The histograms are cached in the TABLE_SHARE. Request it to go away, so
+      that new statements use the updated histograms.
+    */
+    tdc_remove_table(thd, TDC_RT_REMOVE_UNUSED, request.db.c_str(),
+                     request.table_name.c_str(), false);
+
+    // Join orders chosen with the old histograms are not reused
+    invalidate_saved_join_orders();
+  }
+
+  // Errors are not reported anywhere; the table is queued again later.
+  thd->clear_error();
+  thd->get_stmt_da()->reset_condition_info(thd);
+  free_root(thd->mem_root, MYF(MY_KEEP_PREALLOC));
+}
+
+
+extern "C" void *auto_update_thread(void *)
+{
+  my_thread_init();
+  DBUG_ENTER("auto_update_thread");
+
+  THD *thd= new THD;
+  thd->thread_stack= reinterpret_cast<char *>(&thd);
+  thd->set_new_thread_id();
+  mysql_thread_set_psi_id(thd->thread_id());
+  thd->set_command(COM_DAEMON);
+  thd->security_context()->skip_grants();
+  thd->system_thread= SYSTEM_THREAD_BACKGROUND;
+  thd->store_globals();
+
+  mysql_mutex_lock(&LOCK_histogram_auto_update);
+  auto_update_thd= thd;
+  for (;;)
+  {
+    while (queue.empty() && !thread_terminate)
+      mysql_cond_wait(&COND_histogram_auto_update,
+                      &LOCK_histogram_auto_update);
+    if (thread_terminate)
+      break;
+
+    Auto_update_request request= queue.front();
+    queue.pop_front();
+    mysql_mutex_unlock(&LOCK_histogram_auto_update);
+
+    // Do not try to update histograms when in read_only mode.
+    if (!read_only)
+    {
+      thd->set_time();
+      update_histograms(thd, request);
+    }
+
+    mysql_mutex_lock(&LOCK_histogram_auto_update);
+    queued_tables.erase(table_key(request.db.data(), request.db.length(),
+                                  request.table_name.data(),
+                                  request.table_name.length()));
+  }
+  auto_update_thd= nullptr;
+  mysql_mutex_unlock(&LOCK_histogram_auto_update);
+
+  thd->release_resources();
+  thd->restore_globals();
+  delete thd;
+  current_thd= nullptr;
+  DBUG_LEAVE;
+  my_thread_end();
+  my_thread_exit(0);
+  return 0;
+}
+
+
+/**
+  Start the background thread.
+
+  @pre LOCK_histogram_auto_update is held by the caller.
+*/
+void start_auto_update_thread()
+{
+  mysql_mutex_assert_owner(&LOCK_histogram_auto_update);
+  my_thread_attr_t attr;
+  if (my_thread_attr_init(&attr))
+    return;
+
+  /*
+    Do not try again if the thread cannot be created; the tables will just
+    not be updated automatically.
+  */
+  thread_started= true;
+  if (mysql_thread_create(key_thread_histogram_auto_update,
+                          &auto_update_thread_id, &attr,
+                          auto_update_thread, nullptr))
+    auto_update_thread_id.thread= 0;
+
+  (void) my_thread_attr_destroy(&attr);
+}
+
+} // namespace
+
+
+namespace histograms {
+
+void auto_update_init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", auto_update_mutexes,
+                       static_cast<int>(array_elements(auto_update_mutexes)));
+  mysql_cond_register("sql", auto_update_conds,
+                      static_cast<int>(array_elements(auto_update_conds)));
+  mysql_thread_register("sql", auto_update_threads,
+                        static_cast<int>(array_elements(auto_update_threads)));
+#endif
+  mysql_mutex_init(key_LOCK_histogram_auto_update,
+                   &LOCK_histogram_auto_update, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_histogram_auto_update,
+                  &COND_histogram_auto_update);
+  auto_update_thread_id.thread= 0;
+  auto_update_inited= true;
+}
+
+
+void auto_update_stop()
+{
+  if (!auto_update_inited)
+    return;
+
+  mysql_mutex_lock(&LOCK_histogram_auto_update);
+  thread_terminate= true;
+  if (auto_update_thd != nullptr)
+  {
+    // Interrupt any update that is in progress.
+    mysql_mutex_lock(&auto_update_thd->LOCK_thd_data);
+    auto_update_thd->awake(THD::KILL_CONNECTION);
+    mysql_mutex_unlock(&auto_update_thd->LOCK_thd_data);
+  }
+  mysql_cond_signal(&COND_histogram_auto_update);
+  mysql_mutex_unlock(&LOCK_histogram_auto_update);
+
+  if (auto_update_thread_id.thread != 0)
+  {
+    my_thread_join(&auto_update_thread_id, NULL);
+    auto_update_thread_id.thread= 0;
+  }
+}
+
+
+void auto_update_free()
+{
+  if (!auto_update_inited)
+    return;
+  auto_update_stop();
+  changed_rows.clear();
+  queued_tables.clear();
+  queue.clear();
+  mysql_cond_destroy(&COND_histogram_auto_update);
+  mysql_mutex_destroy(&LOCK_histogram_auto_update);
+  auto_update_inited= false;
+}
+
+
+void note_changed_rows(const TABLE_SHARE *share, ha_rows rows,
+                       ha_rows table_rows)
+{
+  const ulong threshold= histogram_auto_update_threshold;
+  if (threshold == 0 || !auto_update_inited ||
+      share->m_histograms == nullptr || share->m_histograms->empty() ||
+      share->tmp_table != NO_TMP_TABLE)
+    return;
+
+  std::string key= table_key(share->db.str, share->db.length,
+                             share->table_name.str, share->table_name.length);
+
+  mysql_mutex_lock(&LOCK_histogram_auto_update);
+  if (thread_terminate || queued_tables.count(key) != 0)
+  {
+    mysql_mutex_unlock(&LOCK_histogram_auto_update);
+    return;
+  }
+
+  ha_rows &changed= changed_rows[key];
+  changed+= rows;
+  if (changed * 100 < threshold * std::max<ha_rows>(table_rows, 1))
+  {
+    mysql_mutex_unlock(&LOCK_histogram_auto_update);
+    return;
+  }
+
+  Auto_update_request request;
+  request.db.assign(share->db.str, share->db.length);
+  request.table_name.assign(share->table_name.str, share->table_name.length);
+  for (const auto &histogram : *share->m_histograms)
+  {
+    const LEX_CSTRING column= histogram.second->get_column_name();
+    request.columns.emplace_back(column.str, column.length);
+  }
+
+  changed_rows.erase(key);
+  queued_tables.insert(key);
+  queue.push_back(request);
+
+  if (!thread_started)
+    start_auto_update_thread();
+  mysql_cond_signal(&COND_histogram_auto_update);
+  mysql_mutex_unlock(&LOCK_histogram_auto_update);
+}
+
+
+void forget_changed_rows(const char *db, size_t db_length,
+                         const char *table_name, size_t table_name_length)
+{
+  if (!auto_update_inited)
+    return;
+
+  std::string key= table_key(db, db_length, table_name, table_name_length);
+  mysql_mutex_lock(&LOCK_histogram_auto_update);
+  changed_rows.erase(key);
+  mysql_mutex_unlock(&LOCK_histogram_auto_update);
+}
+
+} // namespace histograms
@@ -0,0 +1,88 @@
+#ifndef HISTOGRAMS_AUTO_UPDATE_INCLUDED
+#define HISTOGRAMS_AUTO_UPDATE_INCLUDED
+
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file sql/histograms/auto_update.h
+  Automatic update of histograms.
+
+  The number of rows inserted, updated and deleted is counted for every table
+  that has histograms. When the count exceeds histogram_auto_update_threshold
+  percent of the rows in the table, the table is queued for a background
+  thread, which updates the histograms the table already has with the same
+  number of buckets, like ANALYZE TABLE ... UPDATE HISTOGRAM would.
+
+  The counts are kept in memory only, so they are lost at restart and are not
+  shared between the servers in a replication topology. Histograms updated in
+  the background are not written to the binary log.
+*/
+
+#include <stddef.h>
+
+#include "my_base.h"                   // ha_rows
+#include "my_inttypes.h"
+
+struct TABLE_SHARE;
+
+/**
+  Percentage of the rows of a table that must have changed since its
+  histograms were updated before they are updated in the background. 0
+  disables automatic updates.
+*/
+extern ulong histogram_auto_update_threshold;
+
+namespace histograms {
+
+/// Initialize the state of the automatic histogram updates
+void auto_update_init();
+
+/// Stop the background thread, if it has been started
+void auto_update_stop();
+
+/// Free the state of the automatic histogram updates
+void auto_update_free();
+
+/**
+  Account for rows changed in a table.
+
+  This is called at the end of every statement that has changed rows in a
+  table with histograms. The table is queued for the background thread when
+  enough rows have changed since its histograms were last updated. The
+  background thread is started on first use.
+
+  @param share          the table
+  @param changed_rows   number of rows inserted, updated or deleted
+  @param table_rows     estimated number of rows in the table
+*/
+void note_changed_rows(const TABLE_SHARE *share, ha_rows changed_rows,
+                       ha_rows table_rows);
+
+/**
+  Forget the rows changed in a table. This is called when the histograms of
+  the table have been updated.
+
+  @param db          the database name
+  @param db_length   length of the database name
+  @param table_name  the table name
+  @param table_name_length length of the table name
+*/
+void forget_changed_rows(const char *db, size_t db_length,
+                         const char *table_name, size_t table_name_length);
+
+} // namespace histograms
+
+#endif
@@ -21,6 +21,7 @@
 #include "sql/histograms/equi_height.h"
 
 #include <stdlib.h>
+#include <algorithm>        // std::max
 #include <cmath>            // std::lround
 #include <iterator>
 #include <new>
@@ -475,6 +476,25 @@ get_equal_to_selectivity(const T& value) const
 }
 
 
+template <class T>
+double Equi_height<T>::
+get_distinct_value_frequency(const T& value) const
+{
+  const auto found= std::lower_bound(m_buckets.begin(), m_buckets.end(), value,
+                                     Histogram_comparator());
+
+  if (found == m_buckets.end() ||
+      Histogram_comparator()(value, found->get_lower_inclusive()))
+    return 0.0;
+
+  double bucket_frequency= found->get_cumulative_frequency();
+  if (found != m_buckets.begin())
+    bucket_frequency-= std::prev(found, 1)->get_cumulative_frequency();
+
+  return bucket_frequency / found->get_num_distinct();
+}
+
+
 template <class T>
 double Equi_height<T>::
 get_less_than_equal_selectivity(const T& value) const
@@ -555,6 +575,58 @@ double Equi_height<T>::get_less_than_selectivity(const T& value) const
 }
 
 
+template <class T>
+double Equi_height<T>::get_join_selectivity(const Histogram &other) const
+{
+  double selectivity= 0.0;
+  double previous_cumulative_frequency= 0.0;
+  for (const auto &bucket : m_buckets)
+  {
+    const double bucket_frequency= bucket.get_cumulative_frequency() -
+                                   previous_cumulative_frequency;
+    previous_cumulative_frequency= bucket.get_cumulative_frequency();
+
+    // The fraction of values in the other column that falls in this bucket.
+    const double other_frequency=
+      other.get_non_null_values_frequency() -
+      other.get_less_than_selectivity_dispatcher(bucket.get_lower_inclusive()) -
+      other.get_greater_than_selectivity_dispatcher(
+        bucket.get_upper_inclusive());
+    if (other_frequency <= 0.0)
+      continue;
+
+    /*
+      Estimate the number of distinct values the other column has in this
+      bucket from its frequency per distinct value at the bucket endpoints. If
+      the endpoints are outside of its buckets, assume it has as many distinct
+      values as this bucket.
+    */
+    double other_num_distinct= static_cast<double>(bucket.get_num_distinct());
+    const double other_value_frequency=
+      std::max(other.get_distinct_value_frequency_dispatcher(
+                 bucket.get_lower_inclusive()),
+               other.get_distinct_value_frequency_dispatcher(
+                 bucket.get_upper_inclusive()));
+    if (other_value_frequency > 0.0)
+      other_num_distinct= other_frequency / other_value_frequency;
+
+    /*
+      Each of the distinct values present in both columns matches
+      (bucket_frequency / num_distinct) * (other_frequency /
+      other_num_distinct) of the row combinations, and the column with the
+      fewest distinct values is assumed to have all of them present in the
+      other column.
+    */
+    selectivity+= bucket_frequency * other_frequency /
+                  std::max({1.0,
+                            static_cast<double>(bucket.get_num_distinct()),
+                            other_num_distinct});
+  }
+
+  return selectivity;
+}
+
+
 // Explicit template instantiations.
 template class Equi_height<double>;
 template class Equi_height<String>;
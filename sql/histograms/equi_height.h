@@ -175,6 +175,31 @@ public:
   */
   double get_greater_than_selectivity(const T& value) const;
 
+  /**
+    Find the fraction of values equal to 'value', given that 'value' is present
+    in the column.
+
+    Unlike get_equal_to_selectivity(), this function does not take into account
+    the probability of the value existing in the bucket. It is used when the
+    value is known to be present, such as for values from a column this column
+    is joined with.
+
+    @param value The value to estimate the selectivity for.
+
+    @return the selectivity between 0.0 and 1.0 inclusive.
+  */
+  double get_distinct_value_frequency(const T& value) const;
+
+  /**
+    Find the join selectivity against another histogram.
+
+    @param other The histogram of the column this column is joined with.
+
+    @return the selectivity between 0.0 and 1.0 inclusive.
+    @see Histogram::get_join_selectivity
+  */
+  double get_join_selectivity(const Histogram &other) const;
+
   /**
     Equi-height constructor.
 
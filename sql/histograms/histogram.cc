@@ -52,6 +52,7 @@
 #include "sql/dd/types/table.h"         // dd::Table
 #include "sql/field.h"                  // Field
 #include "sql/handler.h"
+#include "sql/histograms/auto_update.h" // forget_changed_rows
 #include "sql/histograms/equi_height.h" // Equi_height<T>
 #include "sql/histograms/singleton.h"   // Singleton<T>
 #include "sql/histograms/value_map.h"   // Value_map
@@ -1200,6 +1201,11 @@ bool update_histogram(THD *thd, TABLE_LIST *table, const columns_set &columns,
   bool ret= trans_commit_stmt(thd) || trans_commit(thd);
   close_thread_tables(thd);
   tables_guard.commit();
+
+  // Start counting the changed rows from scratch.
+  if (!ret)
+    forget_changed_rows(table->db, table->db_length, table->table_name,
+                        table->table_name_length);
   return ret;
 }
 
@@ -1559,6 +1565,29 @@ double Histogram::get_equal_to_selectivity_dispatcher(const T& value) const
 }
 
 
+template <class T>
+double Histogram::get_distinct_value_frequency_dispatcher(const T& value) const
+{
+  switch (get_histogram_type())
+  {
+    case enum_histogram_type::SINGLETON:
+    {
+      const Singleton<T> *singleton= down_cast<const Singleton<T>*>(this);
+      return singleton->get_equal_to_selectivity(value);
+    }
+    case enum_histogram_type::EQUI_HEIGHT:
+    {
+      const Equi_height<T> *equi_height= down_cast<const Equi_height<T>*>(this);
+      return equi_height->get_distinct_value_frequency(value);
+    }
+  }
+  /* purecov: begin deadcode */
+  DBUG_ASSERT(false);
+  return 0.0;
+  /* purecov: end deadcode */
+}
+
+
 static bool get_temporal(Item *item, Value_map_type preferred_type,
                          MYSQL_TIME *time_value)
 {
@@ -2014,7 +2043,236 @@ bool Histogram::get_selectivity(Item **items, size_t item_count,
   /* purecov: end deadcode */
 }
 
+bool Histogram::get_selectivity(Field *field, enum_operator op,
+                                double *selectivity) const
+{
+  DBUG_ASSERT(op == enum_operator::EQUALS_TO ||
+              op == enum_operator::LESS_THAN ||
+              op == enum_operator::GREATER_THAN);
+
+  if (field->is_null())
+    return true;
+
+  switch (get_data_type())
+  {
+    case Value_map_type::INVALID:
+    {
+      /* purecov: begin deadcode */
+      DBUG_ASSERT(false);
+      return true;
+      /* purecov: end deadcode */
+    }
+    case Value_map_type::STRING:
+    {
+      if (field->charset()->number != get_character_set()->number)
+        return true; /* purecov: deadcode */
+
+      StringBuffer<MAX_FIELD_WIDTH> str_buf(field->charset());
+      const String *str= field->val_str(&str_buf);
+
+      *selectivity= apply_operator(op, str->substr(0, HISTOGRAM_MAX_COMPARE_LENGTH));
+      return false;
+    }
+    case Value_map_type::INT:
+    {
+      const longlong value= field->val_int();
+      *selectivity= apply_operator(op, value);
+      return false;
+    }
+    case Value_map_type::ENUM:
+    case Value_map_type::SET:
+    {
+      if (op != enum_operator::EQUALS_TO)
+        return true;
+
+      const longlong value= field->val_int();
+      *selectivity= get_equal_to_selectivity_dispatcher(value);
+      return false;
+    }
+    case Value_map_type::UINT:
+    {
+      const ulonglong value= static_cast<ulonglong>(field->val_int());
+      *selectivity= apply_operator(op, value);
+      return false;
+    }
+    case Value_map_type::DOUBLE:
+    {
+      const double value= field->val_real();
+      *selectivity= apply_operator(op, value);
+      return false;
+    }
+    case Value_map_type::DECIMAL:
+    {
+      my_decimal buffer;
+      const my_decimal *value= field->val_decimal(&buffer);
+      *selectivity= apply_operator(op, *value);
+      return false;
+    }
+    case Value_map_type::DATE:
+    {
+      MYSQL_TIME time_value;
+      TIME_from_longlong_date_packed(&time_value, field->val_date_temporal());
+      *selectivity= apply_operator(op, time_value);
+      return false;
+    }
+    case Value_map_type::TIME:
+    {
+      MYSQL_TIME time_value;
+      TIME_from_longlong_time_packed(&time_value, field->val_time_temporal());
+      *selectivity= apply_operator(op, time_value);
+      return false;
+    }
+    case Value_map_type::DATETIME:
+    {
+      MYSQL_TIME time_value;
+      TIME_from_longlong_datetime_packed(&time_value,
+                                         field->val_date_temporal());
+      *selectivity= apply_operator(op, time_value);
+      return false;
+    }
+  }
+
+  /* purecov: begin deadcode */
+  DBUG_ASSERT(false);
+  return true;
+  /* purecov: end deadcode */
+}
+
+
+template <class T>
+double Histogram::get_join_selectivity_dispatcher(const Histogram &other) const
+{
+  switch (get_histogram_type())
+  {
+    case enum_histogram_type::SINGLETON:
+    {
+      const Singleton<T> *singleton= down_cast<const Singleton<T>*>(this);
+      return singleton->get_join_selectivity(other);
+    }
+    case enum_histogram_type::EQUI_HEIGHT:
+    {
+      const Equi_height<T> *equi_height= down_cast<const Equi_height<T>*>(this);
+      return equi_height->get_join_selectivity(other);
+    }
+  }
+  /* purecov: begin deadcode */
+  DBUG_ASSERT(false);
+  return 0.0;
+  /* purecov: end deadcode */
+}
+
+
+bool Histogram::get_join_selectivity(const Histogram &other,
+                                     double *selectivity) const
+{
+  if (get_data_type() != other.get_data_type())
+    return true;
+
+  /*
+    Iterate over the values of a singleton histogram if there is one, since it
+    has the exact frequency of each value.
+  */
+  const bool swap= get_histogram_type() != enum_histogram_type::SINGLETON &&
+                   other.get_histogram_type() == enum_histogram_type::SINGLETON;
+  const Histogram &outer= swap ? other : *this;
+  const Histogram &inner= swap ? *this : other;
+
+  switch (get_data_type())
+  {
+    case Value_map_type::STRING:
+      // Values in different character sets cannot be compared.
+      if (get_character_set()->number != other.get_character_set()->number)
+        return true;
+      *selectivity= outer.get_join_selectivity_dispatcher<String>(inner);
+      break;
+    case Value_map_type::INT:
+      *selectivity= outer.get_join_selectivity_dispatcher<longlong>(inner);
+      break;
+    case Value_map_type::UINT:
+      *selectivity= outer.get_join_selectivity_dispatcher<ulonglong>(inner);
+      break;
+    case Value_map_type::DOUBLE:
+      *selectivity= outer.get_join_selectivity_dispatcher<double>(inner);
+      break;
+    case Value_map_type::DECIMAL:
+      *selectivity= outer.get_join_selectivity_dispatcher<my_decimal>(inner);
+      break;
+    case Value_map_type::DATE:
+    case Value_map_type::TIME:
+    case Value_map_type::DATETIME:
+      *selectivity= outer.get_join_selectivity_dispatcher<MYSQL_TIME>(inner);
+      break;
+    case Value_map_type::ENUM:
+    case Value_map_type::SET:
+      /*
+        ENUM and SET values are stored as indexes into the column definition,
+        which are unrelated between two columns.
+      */
+      return true;
+    case Value_map_type::INVALID:
+      /* purecov: begin deadcode */
+      DBUG_ASSERT(false);
+      return true;
+      /* purecov: end deadcode */
+  }
+
+  *selectivity= std::min(std::max(*selectivity, 0.0), 1.0);
+  return false;
+}
+
 // Explicit template instantiations.
+template double
+Histogram::get_less_than_selectivity_dispatcher(const double&) const;
+template double
+Histogram::get_less_than_selectivity_dispatcher(const String&) const;
+template double
+Histogram::get_less_than_selectivity_dispatcher(const ulonglong&) const;
+template double
+Histogram::get_less_than_selectivity_dispatcher(const longlong&) const;
+template double
+Histogram::get_less_than_selectivity_dispatcher(const MYSQL_TIME&) const;
+template double
+Histogram::get_less_than_selectivity_dispatcher(const my_decimal&) const;
+
+template double
+Histogram::get_greater_than_selectivity_dispatcher(const double&) const;
+template double
+Histogram::get_greater_than_selectivity_dispatcher(const String&) const;
+template double
+Histogram::get_greater_than_selectivity_dispatcher(const ulonglong&) const;
+template double
+Histogram::get_greater_than_selectivity_dispatcher(const longlong&) const;
+template double
+Histogram::get_greater_than_selectivity_dispatcher(const MYSQL_TIME&) const;
+template double
+Histogram::get_greater_than_selectivity_dispatcher(const my_decimal&) const;
+
+template double
+Histogram::get_equal_to_selectivity_dispatcher(const double&) const;
+template double
+Histogram::get_equal_to_selectivity_dispatcher(const String&) const;
+template double
+Histogram::get_equal_to_selectivity_dispatcher(const ulonglong&) const;
+template double
+Histogram::get_equal_to_selectivity_dispatcher(const longlong&) const;
+template double
+Histogram::get_equal_to_selectivity_dispatcher(const MYSQL_TIME&) const;
+template double
+Histogram::get_equal_to_selectivity_dispatcher(const my_decimal&) const;
+
+template double
+Histogram::get_distinct_value_frequency_dispatcher(const double&) const;
+template double
+Histogram::get_distinct_value_frequency_dispatcher(const String&) const;
+template double
+Histogram::get_distinct_value_frequency_dispatcher(const ulonglong&) const;
+template double
+Histogram::get_distinct_value_frequency_dispatcher(const longlong&) const;
+template double
+Histogram::get_distinct_value_frequency_dispatcher(const MYSQL_TIME&) const;
+template double
+Histogram::get_distinct_value_frequency_dispatcher(const my_decimal&) const;
+
 template Histogram *
 build_histogram(MEM_ROOT *, const Value_map<double>&, size_t,
                 const std::string&, const std::string&, const std::string&);
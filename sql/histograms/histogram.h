@@ -52,6 +52,7 @@
 #include "sql_string.h"
 
 
+class Field;
 class Item;
 class Json_dom;
 class Json_object;
@@ -290,6 +291,10 @@ private:
   template <class T> double
   get_equal_to_selectivity_dispatcher(const T& value) const;
 
+  /// @see Equi_height::get_distinct_value_frequency
+  template <class T> double
+  get_distinct_value_frequency_dispatcher(const T& value) const;
+
   /**
     An internal function for applying the correct function for the given
     operator.
@@ -301,6 +306,27 @@ private:
   */
   template <class T>
   double apply_operator(const enum_operator op, const T& value) const;
+
+  /**
+    An internal function for getting the join selectivity estimation.
+
+    This function will cast the histogram to the correct class (using down_cast)
+    and let that class compare its buckets against the other histogram.
+
+    @param other The histogram of the column this column is joined with. It
+                 must have the same data type as this histogram.
+
+    @return The estimated join selectivity, between 0.0 and 1.0 inclusive.
+  */
+  template <class T>
+  double get_join_selectivity_dispatcher(const Histogram &other) const;
+
+  /*
+    The subclasses need the selectivity estimation functions of the histogram
+    they are joined with, see get_join_selectivity().
+  */
+  template <class T> friend class Singleton;
+  template <class T> friend class Equi_height;
 public:
   /**
     Constructor.
@@ -463,6 +489,53 @@ public:
   bool get_selectivity(Item **items, size_t item_count,
                        enum_operator op, double *selectivity) const;
 
+  /**
+    Get selectivity estimation for the current value of a field.
+
+    This function will estimate the selectivity for a predicate on the form
+    "COLUMN OPERATOR CONSTANT", where the constant is the value currently
+    stored in the provided field. This is used by the range optimizer, which
+    has the constant available as a key image only.
+
+    @param field            the field holding the constant value. It must be
+                            the column this histogram represents.
+    @param op               the predicate operator. Only EQUALS_TO, LESS_THAN
+                            and GREATER_THAN are supported.
+    @param[out] selectivity the calculated selectivity
+
+    @retval true if the value could not be used (it is NULL, or the operator is
+            not supported for the data type).
+    @return false if success
+  */
+  bool get_selectivity(Field *field, enum_operator op,
+                       double *selectivity) const;
+
+  /**
+    Get join selectivity estimation.
+
+    This function will estimate the selectivity for a join predicate on the
+    form "COLUMN1 = COLUMN2", where this histogram represents COLUMN1 and the
+    other histogram represents COLUMN2. The selectivity is the fraction of all
+    row combinations from the two tables that satisfies the predicate, so the
+    number of rows from the other table matched by each row in this table is
+    estimated as the selectivity times the number of rows in the other table.
+
+    The estimation assumes that the values within a bucket are uniformly
+    distributed, and that the column with the fewest distinct values within a
+    bucket has all its values present in the other column. If one of the
+    histograms is a singleton histogram, its exact value frequencies are used.
+
+    @param other            the histogram of the column this column is joined
+                            with
+    @param[out] selectivity the calculated selectivity
+
+    @retval true if the histograms cannot be compared (different data types or
+            character sets, or ENUM/SET columns with unrelated definitions).
+    @return false if success
+  */
+  bool get_join_selectivity(const Histogram &other,
+                            double *selectivity) const;
+
   /**
     @return the fraction of non-null values in the histogram.
   */
@@ -404,6 +404,29 @@ double Singleton<T>::get_greater_than_selectivity(const T& value) const
 }
 
 
+template <class T>
+double Singleton<T>::get_join_selectivity(const Histogram &other) const
+{
+  /*
+    Every value in this histogram matches the fraction of rows in the other
+    column that has the same value. The value is assumed to be present in the
+    other column if it is covered by one of its buckets.
+  */
+  double selectivity= 0.0;
+  double previous_cumulative_frequency= 0.0;
+  for (const auto &bucket : m_buckets)
+  {
+    const double frequency= bucket.second - previous_cumulative_frequency;
+    previous_cumulative_frequency= bucket.second;
+
+    selectivity+= frequency *
+                  other.get_distinct_value_frequency_dispatcher(bucket.first);
+  }
+
+  return selectivity;
+}
+
+
 // Explicit template instantiations.
 template class Singleton<double>;
 template class Singleton<String>;
@@ -217,6 +217,16 @@ public:
     @return the selectivity between 0.0 and 1.0 inclusive.
   */
   double get_greater_than_selectivity(const T& value) const;
+
+  /**
+    Find the join selectivity against another histogram.
+
+    @param other The histogram of the column this column is joined with.
+
+    @return the selectivity between 0.0 and 1.0 inclusive.
+    @see Histogram::get_join_selectivity
+  */
+  double get_join_selectivity(const Histogram &other) const;
 private:
   /**
     Add value to a JSON bucket
@@ -237,6 +237,25 @@ static void my_coll_agg_error(DTCollation &c1, DTCollation &c2,
 }
 
 
+/**
+  Cond_traverser which sets *arg if the item has a value which may change
+  between executions of the statement: a parameter, a variable of a stored
+  program or an expression which is not a literal.
+*/
+static void find_variable_value(const Item *item, void *arg)
+{
+  if (item == nullptr || item->type() == Item::FIELD_ITEM)
+    return;
+  // The arguments of a function are visited on their own
+  if (item->type() == Item::FUNC_ITEM &&
+      down_cast<const Item_func*>(item)->argument_count() > 0)
+    return;
+  if (item->type() == Item::PARAM_ITEM || item->is_splocal() ||
+      !item->basic_const_item())
+    *static_cast<bool*>(arg)= true;
+}
+
+
 static bool get_histogram_selectivity(THD *thd, Field *field,
                                       Item **args, size_t arg_count,
                                       histograms::enum_operator op,
@@ -252,6 +271,17 @@ static bool get_histogram_selectivity(THD *thd, Field *field,
     {
       if (unlikely(thd->opt_trace.is_started()))
         write_histogram_to_trace(thd, item_func, *selectivity);
+
+      /*
+        A selectivity computed from the values of parameters makes the join
+        order depend on them, so that it must not be reused by the next
+        execution of the statement.
+      */
+      bool variable= false;
+      for (size_t i= 0; i < arg_count && !variable; i++)
+        args[i]->traverse_cond(&find_variable_value, &variable, Item::PREFIX);
+      if (variable)
+        thd->histogram_param_selectivities++;
       return false;
     }
   }
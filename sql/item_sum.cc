@@ -2973,6 +2973,9 @@ void Item_sum_hybrid::clear()
   null_value= 1;
   m_cnt= 0;
   m_saved_last_value_at= 0;
+  m_frame_values.clear();
+  m_frame_added= 0;
+  m_frame_removed= 0;
 }
 
 
@@ -3013,7 +3016,16 @@ bool Item_sum_hybrid::wf_semantics(THD *thd, SELECT_LEX *select,
       }
     }
   }
-  if (!m_optimize)
+  /*
+    Otherwise, a frame which moves is evaluated by adding the rows entering
+    it and removing the rows leaving it, cf. add_moving(), for the types
+    whose values can be kept in Frame_value.
+  */
+  m_moving= !m_optimize && f != nullptr &&
+    (r->row_optimizable || r->range_optimizable) &&
+    (hybrid_type == INT_RESULT || hybrid_type == REAL_RESULT);
+
+  if (!m_optimize && !m_moving)
   {
     r->row_optimizable= false;
     r->range_optimizable= false;
@@ -3022,6 +3034,84 @@ bool Item_sum_hybrid::wf_semantics(THD *thd, SELECT_LEX *select,
 
 }
 
+
+/**
+  Compares two values of rows in a moving frame.
+
+  @returns -1, 0 or 1 if a is less than, equal to or greater than b
+*/
+int Item_sum_hybrid::cmp_frame_values(const Frame_value &a,
+                                      const Frame_value &b) const
+{
+  if (hybrid_type == REAL_RESULT)
+    return a.m_real < b.m_real ? -1 : (a.m_real == b.m_real ? 0 : 1);
+  if (unsigned_flag)
+  {
+    const ulonglong ua= static_cast<ulonglong>(a.m_int);
+    const ulonglong ub= static_cast<ulonglong>(b.m_int);
+    return ua < ub ? -1 : (ua == ub ? 0 : 1);
+  }
+  return a.m_int < b.m_int ? -1 : (a.m_int == b.m_int ? 0 : 1);
+}
+
+
+/**
+  Evaluates min/max over a moving frame incrementally. When the frame
+  moves, the caller adds the rows entering it and removes, with
+  Window::do_inverse(), the rows leaving it, in the order they entered
+  it. Rather than visiting all the rows of the frame again, we keep the
+  values which may still become the result in m_frame_values: a value
+  can be forgotten once a better value, or an equal one, has entered the
+  frame after it, since the later row will leave the frame last. Each
+  row is then added and removed at most once, so the cost per row is
+  constant on average, regardless of the size of the frame.
+*/
+void Item_sum_hybrid::add_moving()
+{
+  if (!m_window->dont_aggregate())
+  {
+    if (m_window->do_inverse())
+    {
+      if (!m_frame_values.empty() &&
+          m_frame_values.front().m_seq == m_frame_removed)
+        m_frame_values.pop_front();
+      m_frame_removed++;
+    }
+    else
+    {
+      Frame_value v;
+      v.m_seq= m_frame_added++;
+      v.m_int= 0;
+      v.m_real= 0.0;
+      if (hybrid_type == INT_RESULT)
+        v.m_int= args[0]->val_int();
+      else
+        v.m_real= args[0]->val_real();
+
+      if (!args[0]->null_value)
+      {
+        // cmp_sign is 1 for min() and -1 for max()
+        while (!m_frame_values.empty() &&
+               cmp_frame_values(m_frame_values.back(), v) * cmp_sign >= 0)
+          m_frame_values.pop_back();
+        m_frame_values.push_back(v);
+      }
+    }
+  }
+
+  if (m_frame_values.empty())
+  {
+    null_value= true;
+    return;
+  }
+  null_value= false;
+  const Frame_value &best= m_frame_values.front();
+  if (hybrid_type == INT_RESULT)
+    down_cast<Item_cache_int*>(value)->store_value(this, best.m_int);
+  else
+    down_cast<Item_cache_real*>(value)->store_value(this, best.m_real);
+}
+
 /**
   This function implements the optimized version of retrieving min/max
   value. When we have "ordered ASC" results in a window, min will always
@@ -3163,6 +3253,8 @@ double Item_sum_hybrid::val_real()
       return 0.0;
     if (m_optimize)
       compute();
+    else if (m_moving)
+      add_moving();
     else
       add();
   }
@@ -3183,6 +3275,8 @@ longlong Item_sum_hybrid::val_int()
       return 0;
     if (m_optimize)
       compute();
+    else if (m_moving)
+      add_moving();
     else
       add();
   }
@@ -3228,6 +3322,8 @@ my_decimal *Item_sum_hybrid::val_decimal(my_decimal *val)
       return nullptr;
     if (m_optimize)
       compute();
+    else if (m_moving)
+      add_moving();
     else
       add();
   }
@@ -3268,6 +3364,8 @@ Item_sum_hybrid::val_str(String *str)
       return nullptr;
     if (m_optimize)
       compute();
+    else if (m_moving)
+      add_moving();
     else
       add();
   }
@@ -3312,6 +3410,7 @@ void Item_sum_hybrid::cleanup()
   forced_const= FALSE;
   destroy(cmp);
   cmp= 0;
+  m_frame_values.clear();
   /*
     by default it is TRUE to avoid TRUE reporting by
     Item_func_not_all/Item_func_nop_all if this item was never called.
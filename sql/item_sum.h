@@ -23,6 +23,7 @@
 #include <math.h>
 #include <stddef.h>
 #include <sys/types.h>
+#include <deque>
 #include <utility>          // std::forward
 
 #include "binary_log_types.h"
@@ -1518,23 +1519,54 @@ protected:
   */
   int64 m_saved_last_value_at;
 
+  /**
+    Set to true when min/max over a moving frame is evaluated incrementally,
+    see add_moving().
+  */
+  bool m_moving;
+
+  /// A non-NULL value of a row in the moving frame
+  struct Frame_value
+  {
+    int64 m_seq;        ///< Number of the row in the order of entering the frame
+    longlong m_int;     ///< The value, if hybrid_type is INT_RESULT
+    double m_real;      ///< The value, if hybrid_type is REAL_RESULT
+  };
+
+  /**
+    Execution state for m_moving: the rows of the frame which may still
+    become the result, in the order they entered the frame. Every value
+    is strictly better, i.e. smaller for min() and larger for max(), than
+    the values before it, so the first value is the result.
+    Valid only when m_moving is true.
+  */
+  std::deque<Frame_value> m_frame_values;
+  /// Number of rows which have entered the moving frame
+  int64 m_frame_added;
+  /// Number of rows which have left the moving frame
+  int64 m_frame_removed;
+
   bool wf_semantics(THD *thd, SELECT_LEX *select,
                     Window::Evaluation_requirements *r,
                     bool min);
+  void add_moving();
+  int cmp_frame_values(const Frame_value &a, const Frame_value &b) const;
 
 public:
   Item_sum_hybrid(Item *item_par,int sign)
     :Item_sum(item_par), value(0), arg_cache(0), cmp(0),
     hybrid_type(INT_RESULT), cmp_sign(sign), was_values(true),
     m_nulls_first(false), m_optimize(false), m_want_first(false), m_cnt(0),
-    m_saved_last_value_at(0)
+    m_saved_last_value_at(0), m_moving(false), m_frame_added(0),
+    m_frame_removed(0)
   { collation.set(&my_charset_bin); }
 
   Item_sum_hybrid(const POS &pos, Item *item_par,int sign, PT_window *w)
     :Item_sum(pos, item_par, w), value(0), arg_cache(0), cmp(0),
     hybrid_type(INT_RESULT), cmp_sign(sign), was_values(true),
     m_nulls_first(false), m_optimize(false), m_want_first(false), m_cnt(0),
-    m_saved_last_value_at(0)
+    m_saved_last_value_at(0), m_moving(false), m_frame_added(0),
+    m_frame_removed(0)
   { collation.set(&my_charset_bin); }
 
   Item_sum_hybrid(THD *thd, Item_sum_hybrid *item)
@@ -1543,7 +1575,8 @@ public:
     cmp_sign(item->cmp_sign), was_values(item->was_values),
     m_nulls_first(item->m_nulls_first), m_optimize(item->m_optimize),
     m_want_first(item->m_want_first), m_cnt(item->m_cnt),
-    m_saved_last_value_at(0)
+    m_saved_last_value_at(0), m_moving(item->m_moving), m_frame_added(0),
+    m_frame_removed(0)
   {}
   
   bool fix_fields(THD *, Item **) override;
@@ -17,12 +17,16 @@
 #include "sql/mdl.h"
 
 #include <time.h>
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
 #include <algorithm>
 #include <atomic>
 #include <functional>
 
 #include "lf.h"
 #include "m_ctype.h"
+#include "my_config.h"
 #include "my_dbug.h"
 #include "my_macros.h"
 #include "my_murmur3.h"
@@ -830,7 +834,8 @@ public:
     MDL_lock::reinit(). So @sa MDL_lock::reiniti()
   */
   MDL_lock()
-    : m_obtrusive_locks_granted_waiting_count(0)
+    : m_obtrusive_locks_granted_waiting_count(0),
+      m_fast_path_slots(NULL)
   {
     mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
   }
@@ -839,6 +844,7 @@ public:
 
   ~MDL_lock()
   {
+    delete[] m_fast_path_slots;
     mysql_prlock_destroy(&m_rwlock);
   }
 
@@ -996,6 +1002,116 @@ public:
     m_fast_path_state.store(0);
   }
 
+  /** Number of elements in m_fast_path_slots. */
+  static const uint FAST_PATH_SLOTS= 64;
+
+  /**
+    Counter of "fast path" locks padded to the size of a cache line,
+    so that updates of different slots do not contend.
+  */
+  struct Fast_path_slot
+  {
+    std::atomic<fast_path_state_t> m_counter;
+    char m_pad[CPU_LEVEL1_DCACHE_LINESIZE -
+               sizeof(std::atomic<fast_path_state_t>)];
+  };
+
+  /**
+    Array of FAST_PATH_SLOTS counters which replace the packed counters in
+    m_fast_path_state for singleton locks acquired by every DML statement
+    (GLOBAL and COMMIT). Such locks are taken in IX mode by all connections
+    at once, so a single counter would be bounced between the caches of
+    all CPUs. Each connection increments the slot of the CPU it runs on
+    instead, and the counters are only summed when an "obtrusive" lock
+    is requested. NULL for all other locks.
+
+    Unlike the counters in m_fast_path_state slots are changed without
+    holding m_rwlock even when HAS_OBTRUSIVE is set, i.e. invariant [INV1]
+    doesn't hold for them. Instead:
+
+    *) The thread requesting an "obtrusive" lock sets HAS_OBTRUSIVE and
+       then sums the slots in can_grant_lock(), while the thread taking
+       a "fast path" lock increments its slot and then re-checks the flag,
+       backing off to "slow path" if it is set. All these operations are
+       sequentially consistent, so at least one of the threads sees the
+       change made by the other.
+    *) The thread releasing a "fast path" lock decrements its slot and then
+       checks the flag. If it is set, it acquires m_rwlock and wakes up the
+       waiters, which may have seen the lock being released as granted.
+
+    @sa fast_path_slot_acquire(), fast_path_slot_release().
+  */
+  Fast_path_slot *m_fast_path_slots;
+
+  /**
+    Allocate m_fast_path_slots for singleton MDL_lock object.
+    If allocation fails, the lock keeps using m_fast_path_state.
+  */
+  void create_fast_path_slots()
+  {
+    m_fast_path_slots= new (std::nothrow) Fast_path_slot[FAST_PATH_SLOTS];
+    if (m_fast_path_slots)
+    {
+      for (uint i= 0; i < FAST_PATH_SLOTS; i++)
+        m_fast_path_slots[i].m_counter= 0;
+    }
+  }
+
+  /**
+    Sum of packed counters of "fast path" locks from m_fast_path_state
+    and m_fast_path_slots, without the flags.
+
+    @sa MDL_lock::fast_path_granted_bitmap() for explanation about why it
+        is safe to call it while holding m_rwlock.
+  */
+  fast_path_state_t fast_path_counters() const
+  {
+    fast_path_state_t result= m_fast_path_state &
+                              ~(IS_DESTROYED | HAS_OBTRUSIVE | HAS_SLOW_PATH);
+    if (m_fast_path_slots)
+    {
+      for (uint i= 0; i < FAST_PATH_SLOTS; i++)
+        result+= m_fast_path_slots[i].m_counter.load();
+    }
+    return result;
+  }
+
+  /**
+    Try to acquire "unobtrusive" lock using "fast path" by incrementing
+    one of m_fast_path_slots.
+
+    @retval true  - Lock was acquired.
+    @retval false - There are "obtrusive" locks, "slow path" must be used.
+  */
+  bool fast_path_slot_acquire(uint slot, fast_path_state_t increment)
+  {
+    if (m_fast_path_state.load() & HAS_OBTRUSIVE)
+      return false;
+    m_fast_path_slots[slot].m_counter.fetch_add(increment);
+    if (m_fast_path_state.load() & HAS_OBTRUSIVE)
+    {
+      /* Obtrusive lock might have seen our increment and wait for it. */
+      fast_path_slot_release(slot, increment);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+    Release "unobtrusive" lock acquired by fast_path_slot_acquire().
+  */
+  void fast_path_slot_release(uint slot, fast_path_state_t increment)
+  {
+    m_fast_path_slots[slot].m_counter.fetch_sub(increment);
+    if (m_fast_path_state.load() & HAS_OBTRUSIVE)
+    {
+      mysql_prlock_wrlock(&m_rwlock);
+      if (m_obtrusive_locks_granted_waiting_count)
+        reschedule_waiters();
+      mysql_prlock_unlock(&m_rwlock);
+    }
+  }
+
   /**
     Pointer to strategy object which defines how different types of lock
     requests should be handled for the namespace to which this lock belongs.
@@ -1012,8 +1128,7 @@ public:
   */
   static bitmap_t scoped_lock_fast_path_granted_bitmap(const MDL_lock &lock)
   {
-    return (lock.m_fast_path_state & 0xFFFFFFFFFFFFFFFULL) ?
-            MDL_BIT(MDL_INTENTION_EXCLUSIVE) : 0;
+    return lock.fast_path_counters() ? MDL_BIT(MDL_INTENTION_EXCLUSIVE) : 0;
   }
 
   /**
@@ -1038,7 +1153,7 @@ public:
   static bitmap_t object_lock_fast_path_granted_bitmap(const MDL_lock &lock)
   {
     bitmap_t result= 0;
-    fast_path_state_t fps= lock.m_fast_path_state;
+    fast_path_state_t fps= lock.fast_path_counters();
     if (fps & 0xFFFFFULL)
       result|= MDL_BIT(MDL_SHARED);
     if (fps & (0xFFFFFULL << 20))
@@ -1188,6 +1303,13 @@ void MDL_map::init()
   m_acl_cache_lock= MDL_lock::create(&acl_cache_lock_key);
   m_backup_lock= MDL_lock::create(&backup_lock_key);
 
+  /*
+    IX locks in GLOBAL and COMMIT namespaces are acquired by every statement
+    changing data. Use per-CPU "fast path" counters for them.
+  */
+  m_global_lock->create_fast_path_slots();
+  m_commit_lock->create_fast_path_slots();
+
   m_unused_lock_objects= 0;
 
   lf_hash_init2(&m_locks, sizeof(MDL_lock), LF_HASH_UNIQUE,
@@ -1512,7 +1634,28 @@ MDL_context::MDL_context()
   m_pins(NULL),
   m_rand_state(UINT_MAX32)
 {
+  static std::atomic<uint> next_fast_path_slot(0);
+
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  m_fast_path_slot= next_fast_path_slot++ % MDL_lock::FAST_PATH_SLOTS;
+}
+
+
+/**
+  Get element of MDL_lock::m_fast_path_slots to be used for "fast path"
+  lock acquired by this context. This is the slot for the CPU on which
+  the thread runs, if known, so threads running concurrently on
+  different CPUs don't update the same counter.
+*/
+
+inline uint MDL_context::fast_path_slot() const
+{
+#ifdef HAVE_SCHED_GETCPU
+  const int cpu= sched_getcpu();
+  if (cpu >= 0)
+    return static_cast<uint>(cpu) % MDL_lock::FAST_PATH_SLOTS;
+#endif
+  return m_fast_path_slot;
 }
 
 
@@ -3022,6 +3165,12 @@ void MDL_context::materialize_fast_path_locks()
           to enforce invariant [INV1].
         */
         MDL_lock::fast_path_state_t old_state= lock->m_fast_path_state;
+        if (lock->m_fast_path_slots)
+        {
+          lock->m_fast_path_slots[ticket->m_fast_path_slot].m_counter.
+            fetch_sub(unobtrusive_lock_increment);
+          unobtrusive_lock_increment= 0;
+        }
         while (! lock->fast_path_state_cas(&old_state,
                          ((old_state - unobtrusive_lock_increment) |
                           MDL_lock::HAS_SLOW_PATH)))
@@ -3224,6 +3373,21 @@ retry:
     MDL_lock::fast_path_state_t old_state= lock->m_fast_path_state;
     bool first_use;
 
+    if (lock->m_fast_path_slots)
+    {
+      /*
+        Singleton with per-CPU counters. It is never destroyed or counted
+        as unused, so we only need to check for "obtrusive" locks.
+      */
+      DBUG_ASSERT(! pinned);
+      const uint slot= fast_path_slot();
+      if (! lock->fast_path_slot_acquire(slot, unobtrusive_lock_increment))
+        goto slow_path;
+      ticket->m_fast_path_slot= slot;
+      first_use= false;
+      goto fast_path_granted;
+    }
+
     do
     {
       /*
@@ -3270,6 +3434,7 @@ retry:
     while (! lock->fast_path_state_cas(&old_state,
                                        old_state + unobtrusive_lock_increment));
 
+fast_path_granted:
     /*
       Lock has been acquired. Since this can only be an "unobtrusive" lock and
       there were no active/pending requests for "obtrusive" locks, we don't need
@@ -3534,7 +3699,14 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
       invariant [INV1].
     */
     mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
-    ticket->m_lock->fast_path_state_add(unobtrusive_lock_increment);
+    if (ticket->m_lock->m_fast_path_slots)
+    {
+      ticket->m_fast_path_slot= mdl_request->ticket->m_fast_path_slot;
+      ticket->m_lock->m_fast_path_slots[ticket->m_fast_path_slot].m_counter.
+        fetch_add(unobtrusive_lock_increment);
+    }
+    else
+      ticket->m_lock->fast_path_state_add(unobtrusive_lock_increment);
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     ticket->m_is_fast_path= true;
   }
@@ -4029,8 +4201,12 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
       MDL_lock::m_rwlock, so nobody will see results of this decrement until
       m_rwlock is released.
     */
-    lock->fast_path_state_add(
-            -lock->get_unobtrusive_lock_increment(mdl_ticket->m_type));
+    if (lock->m_fast_path_slots)
+      lock->m_fast_path_slots[mdl_ticket->m_fast_path_slot].m_counter.
+        fetch_sub(lock->get_unobtrusive_lock_increment(mdl_ticket->m_type));
+    else
+      lock->fast_path_state_add(
+              -lock->get_unobtrusive_lock_increment(mdl_ticket->m_type));
     mdl_ticket->m_is_fast_path= false;
   }
   else
@@ -4406,6 +4582,16 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
     MDL_lock::fast_path_state_t old_state= lock->m_fast_path_state;
     bool last_use;
 
+    if (lock->m_fast_path_slots)
+    {
+      /* Singleton with per-CPU counters, it is never counted as unused. */
+      DBUG_ASSERT(is_singleton);
+      lock->fast_path_slot_release(ticket->m_fast_path_slot,
+                                   unobtrusive_lock_increment);
+      last_use= false;
+      goto end_fast_path;
+    }
+
     do
     {
       if (old_state & MDL_lock::HAS_OBTRUSIVE)
@@ -791,6 +791,7 @@ private:
      m_ctx(ctx_arg),
      m_lock(NULL),
      m_is_fast_path(false),
+     m_fast_path_slot(0),
      m_hton_notified(false),
      m_psi(NULL)
   {}
@@ -834,6 +835,12 @@ private:
   */
   bool m_is_fast_path;
 
+  /**
+    Element of MDL_lock::m_fast_path_slots which accounts for the lock
+    if it was acquired using "fast path" and the MDL_lock has such slots.
+  */
+  uint m_fast_path_slot;
+
   /**
     Indicates that ticket corresponds to lock request which required
     storage engine notification during its acquisition and requires
@@ -1200,12 +1207,18 @@ private:
     when searching for unused objects to free.
   */
   uint m_rand_state;
+  /**
+    Element of MDL_lock::m_fast_path_slots used by this context when
+    the CPU it runs on is unknown.
+  */
+  uint m_fast_path_slot;
 
 private:
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
   void release_locks_stored_before(enum_mdl_duration duration, MDL_ticket *sentinel);
   void release_lock(enum_mdl_duration duration, MDL_ticket *ticket);
+  inline uint fast_path_slot() const;
   bool try_acquire_lock_impl(MDL_request *mdl_request,
                              MDL_ticket **out_ticket);
   void materialize_fast_path_locks();
@@ -442,7 +442,9 @@
 #include "sql/derror.h"
 #include "sql/event_data_objects.h"     // init_scheduler_psi_keys
 #include "sql/events.h"                 // Events
+#include "sql/filesort_utils.h"         // sort_worker_pool_init
 #include "sql/handler.h"
+#include "sql/histograms/auto_update.h"  // histograms::auto_update_init
 #include "sql/histograms/value_map.h"
 #include "sql/hostname.h"               // hostname_cache_init
 #include "sql/init.h"                   // unireg_init
@@ -468,6 +470,7 @@
 #include "sql/query_options.h"
 #include "sql/replication.h"            // thd_enter_cond
 #include "sql/resourcegroups/resource_group_mgr.h" // init, post_init
+#include "sql/result_cache.h"           // result_cache_init
 #include "sql/rpl_filter.h"
 #include "sql/rpl_gtid.h"
 #include "sql/rpl_gtid_persist.h"       // Gtid_table_persistor
@@ -1969,6 +1972,9 @@ static void clean_up(bool print_message)
   acl_free(1);
   grant_free();
   hostname_cache_free();
+  result_cache_free();
+  histograms::auto_update_free();
+  sort_worker_pool_free();
   range_optimizer_free();
   item_func_sleep_free();
   lex_free();       /* Free some memory */
@@ -4335,6 +4341,9 @@ static int init_server_components()
   partitioning_init();
   if (table_def_init() | hostname_cache_init(host_cache_size))
     unireg_abort(MYSQLD_ABORT_EXIT);
+  result_cache_init();
+  histograms::auto_update_init();
+  sort_worker_pool_init();
 
   /*
     Timers not needed if only starting with --help.
@@ -6082,6 +6091,7 @@ int mysqld_main(int argc, char **argv)
                      MYSQLD_SUCCESS_EXIT);
 
   terminate_compress_gtid_table_thread();
+  histograms::auto_update_stop();
   /*
     Save set of GTIDs of the last binlog into gtid_executed table
     on server shutdown.
@@ -7722,8 +7732,11 @@ SHOW_VAR status_vars[]= {
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count,                     SHOW_FUNC,               SHOW_SCOPE_GLOBAL},
   {"Queries",                  (char*) &show_queries,                                 SHOW_FUNC,               SHOW_SCOPE_ALL},
   {"Questions",                (char*) offsetof(System_status_var, questions),               SHOW_LONGLONG_STATUS,    SHOW_SCOPE_ALL},
+  {"Result_cache_hits",        (char*) offsetof(System_status_var, result_cache_hits),       SHOW_LONGLONG_STATUS,    SHOW_SCOPE_ALL},
+  {"Result_cache_inserts",     (char*) offsetof(System_status_var, result_cache_inserts),    SHOW_LONGLONG_STATUS,    SHOW_SCOPE_ALL},
   {"Select_full_join",         (char*) offsetof(System_status_var, select_full_join_count),  SHOW_LONGLONG_STATUS,    SHOW_SCOPE_ALL},
   {"Select_full_range_join",   (char*) offsetof(System_status_var, select_full_range_join_count), SHOW_LONGLONG_STATUS, SHOW_SCOPE_ALL},
+  {"Select_plan_reuse",        (char*) offsetof(System_status_var, select_plan_reuse_count), SHOW_LONGLONG_STATUS,   SHOW_SCOPE_ALL},
   {"Select_range",             (char*) offsetof(System_status_var, select_range_count),       SHOW_LONGLONG_STATUS,   SHOW_SCOPE_ALL},
   {"Select_range_check",       (char*) offsetof(System_status_var, select_range_check_count), SHOW_LONGLONG_STATUS,   SHOW_SCOPE_ALL},
   {"Select_scan",	       (char*) offsetof(System_status_var, select_scan_count),              SHOW_LONGLONG_STATUS,   SHOW_SCOPE_ALL},
@@ -31,6 +31,7 @@
 #include "sql/sql_class.h"                // THD
 #include "sql/sql_const.h"
 #include "sql/sql_lex.h"                  // lex_start/lex_end
+#include "sql/sql_planner.h"              // invalidate_saved_join_orders
 #include "sql/sql_tmp_table.h"            // init_cache_tmp_engine_properties
 #include "sql/table.h"                    // TABLE
 #include "sql/transaction.h"              // trans_commit_stmt
@@ -509,4 +510,6 @@ void reload_optimizer_cost_constants()
 {
   if (cost_constant_cache)
     cost_constant_cache->reload();
+  // Join orders chosen with the old cost constants are not reused
+  invalidate_saved_join_orders();
 }
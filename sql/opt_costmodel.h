@@ -193,6 +193,8 @@ public:
 
 protected:
   friend class Cost_model_table;
+  // Compares the cost constants of a saved join order with the current ones
+  friend class Optimize_table_order;
   /**
     Return a pointer to the object containing the current cost constants.
 
@@ -0,0 +1,250 @@
+#ifndef OPT_JOIN_ORDER_INCLUDED
+#define OPT_JOIN_ORDER_INCLUDED
+
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file sql/opt_join_order.h
+  Join order search by dynamic programming over sets of tables.
+
+  The search is independent of the cost model: the caller supplies the
+  join graph and a function that extends a partial plan with one table.
+  Optimize_table_order uses it with best_access_path(), and the unit tests
+  use it with a synthetic cost model.
+*/
+
+#include <stddef.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "my_alloc.h"
+#include "my_bit.h"                     // my_count_bits
+#include "my_dbug.h"
+#include "my_inttypes.h"
+#include "my_sys.h"                     // free_root
+#include "my_table_map.h"
+#include "sql/memroot_allocator.h"
+
+/**
+  Find a join order for a set of tables by dynamic programming.
+
+  The tables are placed in blocks. For each block, the best plan is found
+  for every set of one table, of two tables, and so on, that extends the
+  tables placed so far, keeping only the cheapest order for each set of
+  tables. The search for a block stops when the sets have max_block_size
+  tables, or when the next size would require considering more than
+  max_partial_plans partial plans. The cheapest plan of the largest size is
+  then placed, and the search continues with the next block. Thus the search
+  is exhaustive if the tables fit in one block, and becomes greedy by blocks
+  for joins with many tables.
+
+  A partial plan is only extended with a table that is joined to one of its
+  tables, unless no such table remains, so that Cartesian products are not
+  considered needlessly. This keeps the number of sets small for chain and
+  star shaped joins. A table is only placed after the tables it depends on.
+
+  @tparam Plan     State of a partial plan after one of its tables.
+  @tparam Extend   Function with the signature
+
+                   bool extend(uint position, table_map prefix_tables,
+                               uint tableno, double *cost)
+
+                   that extends the partial plan in plans[0 .. position),
+                   which contains the tables 'prefix_tables', with table
+                   number 'tableno', stores the state of the extended plan
+                   in plans[position] and its cost in 'cost', and returns
+                   true if the search is to be aborted.
+
+  @param mem_root           memory for the search; blocks are marked as free
+                            after each block
+  @param tables             tables to join
+  @param neighbours         tables that each table is joined to, by number
+  @param dependencies       tables that must precede each table, by number
+  @param max_block_size     maximum number of tables placed at a time
+  @param max_partial_plans  maximum number of partial plans to consider for
+                            a block; a block has at least one table
+  @param extend             see above
+  @param[out] plans         plan after each table, in join order; also
+                            holds the partial plan being extended
+  @param[out] partial_plans number of partial plans considered
+
+  @retval true if extend() aborted the search
+  @retval false on success
+*/
+template <class Plan, class Extend>
+bool join_order_dp_search(MEM_ROOT *mem_root, table_map tables,
+                          const table_map *neighbours,
+                          const table_map *dependencies,
+                          uint max_block_size, ulonglong max_partial_plans,
+                          Extend &&extend, Plan *plans,
+                          ulonglong *partial_plans)
+{
+  struct Entry
+  {
+    Plan plan;
+    double cost;
+    table_map tables;       ///< Tables of the plan in this block
+    table_map neighbours;   ///< Tables joined to the tables of the plan
+    uint tableno;           ///< Last table of the plan
+    size_t prev;            ///< Entry of the plan without its last table
+  };
+  typedef Memroot_allocator<std::pair<const table_map, size_t>>
+    Entry_index_allocator;
+  typedef std::unordered_map<table_map, size_t, std::hash<table_map>,
+                             std::equal_to<table_map>, Entry_index_allocator>
+    Entry_index;
+
+  const size_t NO_ENTRY= ~static_cast<size_t>(0);
+  const uint table_count= my_count_bits(tables);
+  uint placed= 0;
+  table_map placed_tables= 0;
+  table_map placed_neighbours= 0;
+
+  while (placed < table_count)
+  {
+    {
+      /*
+        Tables the plan with 'plan_tables' in this block may be extended
+        with: those whose dependencies have been placed, and of those the
+        ones joined to the plan if there are any.
+      */
+      auto candidates= [&](table_map plan_tables, table_map plan_neighbours)
+      {
+        const table_map left= tables & ~placed_tables & ~plan_tables;
+        table_map allowed= 0;
+        for (table_map m= left; m != 0; m&= m - 1)
+        {
+          const table_map bit= m & (~m + 1);
+          if (!(dependencies[my_count_bits(bit - 1)] & left))
+            allowed|= bit;
+        }
+        const table_map joined= allowed & plan_neighbours;
+        return joined != 0 ? joined : allowed;
+      };
+
+      /*
+        Entry 0 is the empty plan, which ends with the last table placed so
+        far. The plans of the previous size are [layer_begin, layer_end).
+      */
+      std::deque<Entry, Memroot_allocator<Entry>>
+        entries((Memroot_allocator<Entry>(mem_root)));
+      Entry root;
+      root.cost= 0.0;
+      root.tables= 0;
+      root.neighbours= placed_neighbours;
+      root.tableno= 0;
+      root.prev= 0;
+      entries.push_back(root);
+
+      /*
+        Copy the plan of an entry to plans[], after the tables placed so
+        far. 'materialized' tells which entry each position holds, so that
+        plans which share a prefix need not copy it again.
+      */
+      size_t materialized[sizeof(table_map) * 8];
+      std::fill(materialized, materialized + table_count - placed, NO_ENTRY);
+      auto materialize= [&](size_t i)
+      {
+        for (uint pos= my_count_bits(entries[i].tables); i != 0;
+             i= entries[i].prev)
+        {
+          if (materialized[--pos] == i)
+            break;
+          plans[placed + pos]= entries[i].plan;
+          materialized[pos]= i;
+        }
+      };
+
+      size_t layer_begin= 0;
+      size_t layer_end= 1;
+      uint block_size= 0;
+      ulonglong block_plans= 0;
+      const uint max_size= std::min(max_block_size, table_count - placed);
+      for (uint size= 1; size <= max_size; size++)
+      {
+        // Count the extensions first, to stay within max_partial_plans.
+        ulonglong size_plans= 0;
+        for (size_t i= layer_begin; i < layer_end; i++)
+          size_plans+= my_count_bits(candidates(entries[i].tables,
+                                                entries[i].neighbours));
+        if (size > 1 && block_plans + size_plans > max_partial_plans)
+          break;
+
+        Entry_index index((Entry_index_allocator(mem_root)));
+        const size_t next_begin= entries.size();
+        for (size_t i= layer_begin; i < layer_end; i++)
+        {
+          materialize(i);
+          const table_map prev_tables= entries[i].tables;
+          const table_map prev_neighbours= entries[i].neighbours;
+
+          const table_map next= candidates(prev_tables, prev_neighbours);
+          for (table_map m= next; m != 0; m&= m - 1)
+          {
+            const table_map bit= m & (~m + 1);
+            const uint tableno= my_count_bits(bit - 1);
+            Entry entry;
+            if (extend(placed + size - 1, placed_tables | prev_tables,
+                       tableno, &entry.cost))
+              return true;
+            entry.plan= plans[placed + size - 1];
+            entry.tables= prev_tables | bit;
+            entry.neighbours= prev_neighbours | neighbours[tableno];
+            entry.tableno= tableno;
+            entry.prev= i;
+
+            // Keep the cheapest order of each set of tables.
+            auto it= index.find(entry.tables);
+            if (it == index.end())
+            {
+              index.emplace(entry.tables, entries.size());
+              entries.push_back(entry);
+            }
+            else if (entry.cost < entries[it->second].cost)
+              entries[it->second]= entry;
+          }
+          materialized[size - 1]= NO_ENTRY;
+        }
+        block_plans+= size_plans;
+
+        layer_begin= next_begin;
+        layer_end= entries.size();
+        block_size= size;
+      }
+
+      // There is always a candidate, since dependencies are not cyclic.
+      DBUG_ASSERT(block_size > 0 && layer_end > layer_begin);
+
+      size_t best= layer_begin;
+      for (size_t i= layer_begin + 1; i < layer_end; i++)
+        if (entries[i].cost < entries[best].cost)
+          best= i;
+
+      materialize(best);
+      placed_tables|= entries[best].tables;
+      placed_neighbours= entries[best].neighbours;
+      placed+= block_size;
+      *partial_plans+= block_plans;
+    }
+    free_root(mem_root, MYF(MY_MARK_BLOCKS_FREE));
+  }
+  return false;
+}
+
+#endif /* OPT_JOIN_ORDER_INCLUDED */
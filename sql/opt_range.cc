@@ -6704,6 +6704,134 @@ static SEL_TREE *get_ne_mm_tree(RANGE_OPT_PARAM *param, Item_func *cond_func,
 }
 
 
+/**
+  Builds the SEL_TREE for "field IN (c1, c2, ...)" without creating a
+  SEL_TREE for every value and OR-ing them together one by one.
+
+  For every index with a key part on field, the single-point intervals of
+  all values are sorted, duplicates are removed, and the intervals are
+  inserted into one interval list in order. With N values this costs
+  O(N log N) comparisons instead of N calls to tree_or(), which makes long
+  IN lists cheap to analyze.
+
+  @param       param  Information on 'just about everything'.
+  @param       op     The 'in' operator.
+  @param       field  The field which is the predicand of op.
+  @param[out]  tree   The SEL_TREE, or NULL if no index can be used.
+
+  @retval true   *tree has been built.
+  @retval false  Some value is not constant, or does not give a single-point
+                 interval. The tree must be built value by value.
+*/
+static bool get_in_list_mm_tree(RANGE_OPT_PARAM *param, Item_func_in *op,
+                                Field *field, SEL_TREE **tree)
+{
+  *tree= NULL;
+  if (field->table != param->table)
+    return true;
+
+  for (uint i= 1; i < op->argument_count(); i++)
+  {
+    if (op->arguments()[i]->used_tables() & ~param->read_tables)
+      return false;
+  }
+
+  Mem_root_array<KEY_PART *> key_parts(param->mem_root);
+  for (KEY_PART *key_part= param->key_parts;
+       key_part != param->key_parts_end; key_part++)
+  {
+    if (field->eq(key_part->field) && key_parts.push_back(key_part))
+      return true;                              // OOM
+  }
+  if (key_parts.empty())
+    return true;
+
+  /*
+    The interval of every value on every key part: the intervals of the
+    first value on all key parts come first, then those of the second
+    value, and so on. Values which cannot match are left out, as tree_or()
+    would drop their IMPOSSIBLE trees.
+  */
+  const size_t n_key_parts= key_parts.size();
+  Mem_root_array<SEL_ROOT *> intervals(param->mem_root);
+  if (intervals.reserve((op->argument_count() - 1) * n_key_parts))
+    return true;                                // OOM
+  for (uint i= 1; i < op->argument_count(); i++)
+  {
+    const size_t first= intervals.size();
+    bool impossible= false;
+    for (KEY_PART *key_part : key_parts)
+    {
+      SEL_ROOT *sel_root= get_mm_leaf(param, op, key_part->field, key_part,
+                                      Item_func::EQ_FUNC, op->arguments()[i]);
+      if (param->has_errors())
+        return true;
+      if (sel_root == NULL)
+        return false;
+      if (sel_root->type == SEL_ROOT::Type::IMPOSSIBLE)
+      {
+        impossible= true;
+        break;
+      }
+      if (sel_root->type != SEL_ROOT::Type::KEY_RANGE ||
+          sel_root->elements != 1 ||
+          sel_root->root->next_key_part != NULL ||
+          !sel_root->root->is_singlepoint())
+        return false;
+      sel_root->root->part= (uchar) key_part->part;
+      intervals.push_back(sel_root);
+    }
+    if (impossible)
+      intervals.resize(first);
+  }
+
+  if (intervals.empty())
+  {
+    *tree= new (param->mem_root) SEL_TREE(SEL_TREE::IMPOSSIBLE,
+                                          param->mem_root, param->keys);
+    return true;
+  }
+  if (!(*tree= new (param->mem_root) SEL_TREE(param->mem_root, param->keys)))
+    return true;                                // OOM
+
+  const size_t n_values= intervals.size() / n_key_parts;
+  Mem_root_array<SEL_ROOT *> points(param->mem_root);
+  if (points.reserve(n_values))
+  {
+    *tree= NULL;
+    return true;                                // OOM
+  }
+  for (size_t k= 0; k < n_key_parts; k++)
+  {
+    points.clear();
+    for (size_t i= 0; i < n_values; i++)
+      points.push_back(intervals[i * n_key_parts + k]);
+    std::sort(points.begin(), points.end(),
+              [](const SEL_ROOT *a, const SEL_ROOT *b)
+              { return a->root->cmp_min_to_min(b->root) < 0; });
+
+    SEL_ROOT *sel_root= points[0];
+    SEL_ARG *last= sel_root->root;
+    uint8 maybe_flag= last->maybe_flag;
+    for (size_t i= 1; i < n_values; i++)
+    {
+      SEL_ARG *point= points[i]->root;
+      maybe_flag|= point->maybe_flag;
+      if (point->cmp_min_to_min(last) == 0)
+        continue;                               // Duplicate value
+      sel_root->insert(point);
+      last= point;
+    }
+    sel_root->root->maybe_flag= maybe_flag;
+
+    const uint key= key_parts[k]->key;
+    (*tree)->set_key(key, sel_add((*tree)->release_key(key), sel_root));
+    (*tree)->keys_map.set_bit(key);
+  }
+  return true;
+}
+
+
 /**
   Factory function to build a SEL_TREE from an @<in predicate@>
 
@@ -6900,8 +7028,13 @@ static SEL_TREE *get_func_mm_tree_from_in_predicate(RANGE_OPT_PARAM *param,
   {
     // The expression is (<column>) IN (...)
     Field *field= static_cast<Item_field*>(predicand)->field;
-    SEL_TREE *tree= get_mm_parts(param, op, field, Item_func::EQ_FUNC,
-                                 op->arguments()[1]);
+    SEL_TREE *tree;
+    if (op->argument_count() > 2 &&
+        get_in_list_mm_tree(param, op, field, &tree))
+      return tree;
+
+    tree= get_mm_parts(param, op, field, Item_func::EQ_FUNC,
+                       op->arguments()[1]);
     if (tree)
     {
       Item **arg, **end;
@@ -44,6 +44,7 @@ PSI_memory_key key_memory_Gis_read_stream_err_msg;
 PSI_memory_key key_memory_Gtid_state_to_string;
 PSI_memory_key key_memory_HASH_ROW_ENTRY;
 PSI_memory_key key_memory_JOIN_CACHE;
+PSI_memory_key key_memory_join_order_search;
 PSI_memory_key key_memory_JSON;
 PSI_memory_key key_memory_LOG_POS_COORD;
 PSI_memory_key key_memory_LOG_name;
@@ -102,6 +103,7 @@ PSI_memory_key key_memory_binlog_statement_buffer;
 PSI_memory_key key_memory_binlog_ver_1_event;
 PSI_memory_key key_memory_bison_stack;
 PSI_memory_key key_memory_blob_mem_storage;
+PSI_memory_key key_memory_create_ondisk_from_heap;
 PSI_memory_key key_memory_db_worker_hash_entry;
 PSI_memory_key key_memory_delegate;
 PSI_memory_key key_memory_errmsgs;
@@ -133,6 +135,7 @@ PSI_memory_key key_memory_quick_index_merge_root;
 PSI_memory_key key_memory_quick_range_select_root;
 PSI_memory_key key_memory_quick_ror_intersect_select_root;
 PSI_memory_key key_memory_quick_ror_union_select_root;
+PSI_memory_key key_memory_range_estimate_cache;
 PSI_memory_key key_memory_rpl_filter;
 PSI_memory_key key_memory_rpl_slave_check_temp_dir;
 PSI_memory_key key_memory_rpl_slave_command_buffer;
@@ -191,9 +194,12 @@ static PSI_memory_info all_server_memory[]=
   { &key_memory_quick_ror_union_select_root, "QUICK_ROR_UNION_SELECT::alloc", PSI_FLAG_THREAD, 0, PSI_DOCUMENT_ME},
   { &key_memory_quick_group_min_max_select_root, "QUICK_GROUP_MIN_MAX_SELECT::alloc", PSI_FLAG_THREAD, 0, PSI_DOCUMENT_ME},
   { &key_memory_test_quick_select_exec, "test_quick_select", PSI_FLAG_THREAD, 0, PSI_DOCUMENT_ME},
+  { &key_memory_join_order_search, "Optimize_table_order::dp_search", PSI_FLAG_THREAD, 0, PSI_DOCUMENT_ME},
   { &key_memory_prune_partitions_exec, "prune_partitions::exec", 0, 0, PSI_DOCUMENT_ME},
+  { &key_memory_range_estimate_cache, "Range_estimate_cache", 0, 0, PSI_DOCUMENT_ME},
   { &key_memory_binlog_recover_exec, "MYSQL_BIN_LOG::recover", 0, 0, PSI_DOCUMENT_ME},
   { &key_memory_blob_mem_storage, "Blob_mem_storage::storage", 0, 0, PSI_DOCUMENT_ME},
+  { &key_memory_create_ondisk_from_heap, "create_ondisk_from_heap", 0, 0, PSI_DOCUMENT_ME},
 
   { &key_memory_NAMED_ILINK_name, "NAMED_ILINK::name", 0, 0, PSI_DOCUMENT_ME},
   { &key_memory_String_value, "String::value", 0, 0, PSI_DOCUMENT_ME},
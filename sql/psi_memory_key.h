@@ -67,6 +67,7 @@ extern PSI_memory_key key_memory_Geometry_objects_data;
 extern PSI_memory_key key_memory_Gis_read_stream_err_msg;
 extern PSI_memory_key key_memory_HASH_ROW_ENTRY;
 extern PSI_memory_key key_memory_JOIN_CACHE;
+extern PSI_memory_key key_memory_join_order_search;
 extern PSI_memory_key key_memory_JSON;
 extern PSI_memory_key key_memory_LOG_POS_COORD;
 extern PSI_memory_key key_memory_LOG_name;
@@ -124,6 +125,7 @@ extern PSI_memory_key key_memory_binlog_statement_buffer;
 extern PSI_memory_key key_memory_binlog_ver_1_event;
 extern PSI_memory_key key_memory_bison_stack;
 extern PSI_memory_key key_memory_blob_mem_storage;
+extern PSI_memory_key key_memory_create_ondisk_from_heap;
 extern PSI_memory_key key_memory_db_worker_hash_entry;
 extern PSI_memory_key key_memory_delegate;
 extern PSI_memory_key key_memory_errmsgs;
@@ -155,6 +157,7 @@ extern PSI_memory_key key_memory_quick_index_merge_root;
 extern PSI_memory_key key_memory_quick_range_select_root;
 extern PSI_memory_key key_memory_quick_ror_intersect_select_root;
 extern PSI_memory_key key_memory_quick_ror_union_select_root;
+extern PSI_memory_key key_memory_range_estimate_cache;
 extern PSI_memory_key key_memory_rpl_filter;
 extern PSI_memory_key key_memory_rpl_slave_check_temp_dir;
 extern PSI_memory_key key_memory_rpl_slave_command_buffer;
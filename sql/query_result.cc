@@ -41,6 +41,8 @@
 #include "sql/mysqld.h"        // key_select_to_file
 #include "sql/parse_tree_nodes.h" // PT_select_var
 #include "sql/protocol.h"
+#include "sql/protocol_classic.h"
+#include "sql/result_cache.h"  // Result_cache_query
 #include "sql/sp_rcontext.h"   // sp_rcontext
 #include "sql/sql_class.h"     // THD
 #include "sql/sql_const.h"
@@ -98,6 +100,8 @@ bool Query_result_send::send_data(List<Item> &items)
     protocol->abort_row();
     DBUG_RETURN(TRUE);
   }
+  if (m_cache_query != NULL)
+    m_cache_query->add_row(thd->get_protocol_classic()->get_output_packet());
 
   thd->inc_sent_row_count(1);
   DBUG_RETURN(protocol->end_row());
@@ -35,6 +35,7 @@
 class Item;
 class Item_subselect;
 class PT_select_var;
+class Result_cache_query;
 class THD;
 
 
@@ -76,6 +77,8 @@ public:
   }
   /// @return true if an interceptor object is needed for EXPLAIN
   virtual bool need_explain_interceptor() const { return false; }
+  /// @return true if the rows are sent to the client as a result set
+  virtual bool sends_result_set() const { return false; }
 
   /**
     Perform preparation specific to the query expression or DML statement.
@@ -175,9 +178,13 @@ class Query_result_send : public Query_result {
     set with an eof or error packet
   */
   bool is_result_set_started;
+  /// If not NULL, records the rows sent in the result cache
+  Result_cache_query *m_cache_query;
 public:
   Query_result_send(THD *thd)
-    : Query_result(thd), is_result_set_started(false) {}
+    : Query_result(thd), is_result_set_started(false), m_cache_query(NULL) {}
+  bool sends_result_set() const override { return true; }
+  void set_cache_query(Result_cache_query *query) { m_cache_query= query; }
   bool send_result_set_metadata(List<Item> &list, uint flags) override;
   bool send_data(List<Item> &items) override;
   bool send_eof() override;
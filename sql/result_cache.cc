@@ -0,0 +1,420 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "sql/result_cache.h"
+
+#include <string.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "m_ctype.h"
+#include "my_byteorder.h"
+#include "my_dbug.h"
+#include "my_macros.h"
+#include "my_murmur3.h"
+#include "my_sqlcommand.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "sql/handler.h"
+#include "sql/protocol.h"
+#include "sql/protocol_classic.h"
+#include "sql/query_options.h"     // OPTION_AUTO_IS_NULL
+#include "sql/query_result.h"
+#include "sql/sql_base.h"          // get_table_def_key
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/sql_locale.h"
+#include "sql/system_variables.h"
+#include "sql/table.h"
+#include "sql/table_version.h"
+#include "sql/tztime.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+ulonglong result_cache_size= 0;
+
+namespace {
+
+/// Number of shards of the cache
+const uint RESULT_CACHE_SHARDS= 16;
+
+#ifdef HAVE_PSI_INTERFACE
+PSI_mutex_key key_LOCK_result_cache;
+
+PSI_mutex_info result_cache_mutexes[]=
+{
+  { &key_LOCK_result_cache, "LOCK_result_cache", 0, 0, PSI_DOCUMENT_ME}
+};
+#endif
+
+/// A cached result set
+struct Result_cache_entry
+{
+  std::string key;
+  std::vector<std::pair<uint, ulonglong>> versions;
+  ulonglong epoch;
+  std::string rows;
+  ulonglong row_count;
+  ulonglong found_rows;
+
+  /// @returns the memory accounted for the entry
+  size_t size() const
+  {
+    return 2 * key.size() + rows.size() +
+           versions.size() * sizeof(versions[0]) + sizeof(*this);
+  }
+
+  /// @returns whether none of the tables read has changed
+  bool is_valid() const
+  {
+    if (table_versions_epoch() != epoch)
+      return false;
+    for (const auto &version : versions)
+    {
+      if (table_version_of_slot(version.first) != version.second)
+        return false;
+    }
+    return true;
+  }
+};
+
+typedef std::shared_ptr<const Result_cache_entry> Entry_ptr;
+
+
+/**
+  One shard of the cache: a map from statement keys to entries, with the
+  entries in LRU order. Entries are shared with the sessions sending them,
+  so that the rows are sent without holding the mutex.
+*/
+class Result_cache_shard
+{
+public:
+  void init()
+  {
+    mysql_mutex_init(key_LOCK_result_cache, &m_lock, MY_MUTEX_INIT_FAST);
+    m_size= 0;
+    m_capacity= 0;
+  }
+
+  void destroy()
+  {
+    clear(0);
+    mysql_mutex_destroy(&m_lock);
+  }
+
+  /// @returns the valid entry for key, or an empty pointer
+  Entry_ptr find(const std::string &key)
+  {
+    Entry_ptr entry;
+    mysql_mutex_lock(&m_lock);
+    auto it= m_entries.find(key);
+    if (it != m_entries.end())
+    {
+      if ((*it->second)->is_valid())
+      {
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        entry= *it->second;
+      }
+      else
+        remove(it);
+    }
+    mysql_mutex_unlock(&m_lock);
+    return entry;
+  }
+
+  /// Inserts an entry, replacing the one with the same key if any
+  void insert(const Entry_ptr &entry)
+  {
+    const size_t size= entry->size();
+    mysql_mutex_lock(&m_lock);
+    if (size <= m_capacity)
+    {
+      auto it= m_entries.find(entry->key);
+      if (it != m_entries.end())
+        remove(it);
+      m_lru.push_front(entry);
+      m_entries.emplace(entry->key, m_lru.begin());
+      m_size+= size;
+      while (m_size > m_capacity)
+        remove(m_entries.find(m_lru.back()->key));
+    }
+    mysql_mutex_unlock(&m_lock);
+  }
+
+  /// Removes all entries and sets the capacity of the shard
+  void clear(size_t capacity)
+  {
+    mysql_mutex_lock(&m_lock);
+    m_entries.clear();
+    m_lru.clear();
+    m_size= 0;
+    m_capacity= capacity;
+    mysql_mutex_unlock(&m_lock);
+  }
+
+  /// @returns the capacity of the shard, which bounds the size of an entry
+  size_t capacity()
+  {
+    mysql_mutex_lock(&m_lock);
+    const size_t capacity= m_capacity;
+    mysql_mutex_unlock(&m_lock);
+    return capacity;
+  }
+
+private:
+  typedef std::list<Entry_ptr> Lru_list;
+  typedef std::unordered_map<std::string, Lru_list::iterator> Entry_map;
+
+  void remove(Entry_map::iterator it)
+  {
+    m_size-= (*it->second)->size();
+    m_lru.erase(it->second);
+    m_entries.erase(it);
+  }
+
+  mysql_mutex_t m_lock;
+  /// Entries, the most recently used first
+  Lru_list m_lru;
+  Entry_map m_entries;
+  /// Memory accounted for the entries
+  size_t m_size;
+  size_t m_capacity;
+};
+
+Result_cache_shard shards[RESULT_CACHE_SHARDS];
+
+bool result_cache_inited= false;
+
+
+Result_cache_shard *shard_for(const std::string &key)
+{
+  return &shards[murmur3_32(pointer_cast<const uchar*>(key.data()),
+                            key.size(), 0) % RESULT_CACHE_SHARDS];
+}
+
+
+/**
+  The variables, besides the query text and the current database, that
+  affect the rows of a result set as sent to the client.
+*/
+struct Result_cache_env
+{
+  sql_mode_t sql_mode;
+  ulonglong option_bits;
+  ha_rows select_limit;
+  ulong client_capabilities;
+  ulong div_precincrement;
+  ulong default_week_format;
+  ulong group_concat_max_len;
+  ulong max_sort_length;
+  uint character_set_client;
+  uint character_set_results;
+  uint collation_connection;
+  uint lc_time_names;
+  bool windowing_use_high_precision;
+};
+
+} // namespace
+
+
+void result_cache_init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", result_cache_mutexes,
+                       static_cast<int>(array_elements(result_cache_mutexes)));
+#endif
+  for (Result_cache_shard &shard : shards)
+    shard.init();
+  result_cache_inited= true;
+  result_cache_resize();
+}
+
+
+void result_cache_free()
+{
+  if (!result_cache_inited)
+    return;
+  for (Result_cache_shard &shard : shards)
+    shard.destroy();
+  result_cache_inited= false;
+}
+
+
+void result_cache_resize()
+{
+  for (Result_cache_shard &shard : shards)
+    shard.clear(static_cast<size_t>(result_cache_size / RESULT_CACHE_SHARDS));
+}
+
+
+bool Result_cache_query::prepare(LEX *lex, Query_result *result)
+{
+  DBUG_ENTER("Result_cache_query::prepare");
+  THD *const thd= m_thd;
+
+  if (result_cache_size == 0 || !thd->variables.result_cache ||
+      lex->sql_command != SQLCOM_SELECT || lex->is_explain() ||
+      !lex->safe_to_cache_query || lex->uses_stored_routines() ||
+      lex->query_tables == NULL || !result->sends_result_set() ||
+      !thd->stmt_arena->is_conventional() || thd->sp_runtime_ctx != NULL ||
+      thd->in_sub_stmt || thd->locked_tables_mode ||
+      thd->in_multi_stmt_transaction_mode() ||
+      thd->tx_isolation == ISO_READ_UNCOMMITTED ||
+      !thd->is_classic_protocol() ||
+      thd->get_protocol()->type() != Protocol::PROTOCOL_TEXT)
+    DBUG_RETURN(false);
+
+  /*
+    Only base tables and views may be read. Their versions are read before
+    the statement is executed: a change committed after this point either
+    is seen by the execution or invalidates the stored result.
+
+    Temporary tables and tables with foreign keys are not cached, as their
+    versions are not maintained.
+  */
+  m_epoch= table_versions_epoch();
+  for (TABLE_LIST *tl= lex->query_tables; tl != NULL; tl= tl->next_global)
+  {
+    if (tl->is_derived())
+      continue;
+    if (tl->schema_table != NULL ||
+        (!tl->is_view() &&
+         (tl->table == NULL || !table_version_is_tracked(tl->table->s))) ||
+        is_perfschema_db(tl->db, tl->db_length) ||
+        !my_strcasecmp(system_charset_info, tl->db, MYSQL_SCHEMA_NAME.str))
+      DBUG_RETURN(false);
+    const char *key;
+    const size_t key_length= get_table_def_key(tl, &key);
+    const uint slot= table_version_slot(key, key_length);
+    m_versions.emplace_back(slot, table_version_of_slot(slot));
+  }
+
+  Result_cache_env env;
+  memset(&env, 0, sizeof(env));
+  const System_variables &vars= thd->variables;
+  env.sql_mode= vars.sql_mode;
+  env.option_bits= vars.option_bits & OPTION_AUTO_IS_NULL;
+  env.select_limit= vars.select_limit;
+  env.client_capabilities= thd->get_protocol()->get_client_capabilities();
+  env.div_precincrement= vars.div_precincrement;
+  env.default_week_format= vars.default_week_format;
+  env.group_concat_max_len= vars.group_concat_max_len;
+  env.max_sort_length= vars.max_sort_length;
+  env.character_set_client= vars.character_set_client->number;
+  env.character_set_results= vars.character_set_results != NULL ?
+                             vars.character_set_results->number : 0;
+  env.collation_connection= vars.collation_connection->number;
+  env.lc_time_names= vars.lc_time_names->number;
+  env.windowing_use_high_precision= vars.windowing_use_high_precision;
+
+  const String *tz_name= vars.time_zone->get_name();
+  const size_t db_length= thd->db().str != NULL ? thd->db().length : 0;
+  m_key.reserve(sizeof(env) + 1 + tz_name->length() + 1 + db_length + 1 +
+                thd->query().length);
+  m_key.append(pointer_cast<const char*>(&env), sizeof(env));
+  m_key.append(1, static_cast<char>(tz_name->length()));
+  m_key.append(tz_name->ptr(), tz_name->length());
+  m_key.append(1, static_cast<char>(db_length));
+  m_key.append(thd->db().str != NULL ? thd->db().str : "", db_length);
+  m_key.append(thd->query().str, thd->query().length);
+
+  DBUG_RETURN(true);
+}
+
+
+bool Result_cache_query::send_cached_result(LEX *lex, Query_result *result)
+{
+  DBUG_ENTER("Result_cache_query::send_cached_result");
+  THD *const thd= m_thd;
+  Result_cache_shard *const shard= shard_for(m_key);
+
+  const Entry_ptr entry= shard->find(m_key);
+  if (!entry)
+  {
+    m_capturing= true;
+    m_row_count= 0;
+    m_max_size= shard->capacity();
+    DBUG_RETURN(false);
+  }
+
+  /*
+    The metadata is regenerated from the prepared select list, rather
+    than cached, as it depends only on the statement and the variables
+    in the key.
+  */
+  if (result->send_result_set_metadata(*lex->unit->get_unit_column_types(),
+                                       Protocol::SEND_NUM_ROWS |
+                                       Protocol::SEND_EOF))
+    DBUG_RETURN(true);
+
+  Protocol_classic *const protocol= thd->get_protocol_classic();
+  const char *pos= entry->rows.data();
+  const char *const end= pos + entry->rows.size();
+  while (pos < end && protocol->connection_alive())
+  {
+    const size_t length= uint4korr(pos);
+    if (protocol->write(pointer_cast<const uchar*>(pos + 4), length))
+      break;
+    pos+= 4 + length;
+  }
+  thd->inc_sent_row_count(entry->row_count);
+  thd->current_found_rows= entry->found_rows;
+  thd->status_var.result_cache_hits++;
+
+  result->send_eof();
+  DBUG_RETURN(true);
+}
+
+
+void Result_cache_query::add_row(const String *packet)
+{
+  if (!m_capturing)
+    return;
+  if (m_rows.size() + 4 + packet->length() > m_max_size)
+  {
+    // Too large to be cached
+    m_capturing= false;
+    std::string().swap(m_rows);
+    return;
+  }
+  char length[4];
+  int4store(length, static_cast<uint32>(packet->length()));
+  m_rows.append(length, sizeof(length));
+  m_rows.append(packet->ptr(), packet->length());
+  m_row_count++;
+}
+
+
+void Result_cache_query::store()
+{
+  DBUG_ENTER("Result_cache_query::store");
+  THD *const thd= m_thd;
+  if (!m_capturing || thd->is_error() || thd->killed ||
+      thd->get_stmt_da()->current_statement_cond_count() != 0)
+    DBUG_VOID_RETURN;
+  m_capturing= false;
+
+  std::shared_ptr<Result_cache_entry> entry=
+    std::make_shared<Result_cache_entry>();
+  entry->key.swap(m_key);
+  entry->versions.swap(m_versions);
+  entry->epoch= m_epoch;
+  entry->rows.swap(m_rows);
+  entry->row_count= m_row_count;
+  entry->found_rows= thd->current_found_rows;
+  shard_for(entry->key)->insert(entry);
+  thd->status_var.result_cache_inserts++;
+  DBUG_VOID_RETURN;
+}
@@ -0,0 +1,118 @@
+#ifndef RESULT_CACHE_INCLUDED
+#define RESULT_CACHE_INCLUDED
+
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file sql/result_cache.h
+  Cache of the result sets of SELECT statements.
+
+  The result cache stores the rows of a SELECT statement as the packets of
+  the text protocol that were sent to the client, and sends them again when
+  an identical statement is executed in the same environment. It is used
+  only when @@global.result_cache_size is not zero and the statement opts
+  in with @@session.result_cache, usually through the hint
+  SET_VAR(result_cache=ON).
+
+  The cache is split into shards, each with its own mutex and LRU list, so
+  that concurrent lookups of different statements do not serialize.
+
+  Entries are invalidated through the table versions of sql/table_version.h:
+  every cached result records the versions of the tables it read, and the
+  epoch, and is used only if none of them has changed since. Statements
+  which read temporary tables or tables with foreign keys are never cached,
+  as the versions of these tables are not maintained.
+*/
+
+#include <stddef.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "my_inttypes.h"
+
+class Query_result;
+class String;
+class THD;
+struct LEX;
+
+/// Size of the result cache in bytes, 0 if disabled
+extern ulonglong result_cache_size;
+
+void result_cache_init();
+void result_cache_free();
+/// Removes all entries and applies a new value of result_cache_size
+void result_cache_resize();
+
+
+/**
+  The use of the result cache by one execution of a SELECT statement.
+*/
+class Result_cache_query
+{
+public:
+  explicit Result_cache_query(THD *thd)
+    : m_thd(thd), m_epoch(0), m_row_count(0), m_capturing(false),
+      m_max_size(0)
+  {}
+
+  /**
+    Checks whether the statement may use the result cache, and if so
+    computes its key and reads the versions of its tables. Must be called
+    after the tables have been opened, locked and the statement prepared.
+
+    @param lex     the statement
+    @param result  where the statement sends its rows
+
+    @returns true if the statement may use the cache
+  */
+  bool prepare(LEX *lex, Query_result *result);
+
+  /**
+    Looks up the statement in the cache, and if a valid result is found
+    sends it to the client. Otherwise starts recording the rows sent.
+
+    @returns true if the result has been sent from the cache
+  */
+  bool send_cached_result(LEX *lex, Query_result *result);
+
+  /// Records a row packet sent to the client
+  void add_row(const String *packet);
+
+  /**
+    Stores the recorded result in the cache, if the statement completed
+    without errors or warnings.
+  */
+  void store();
+
+private:
+  THD *const m_thd;
+  /// Query text and the variables which affect the result
+  std::string m_key;
+  /// Version slots of the tables read, and their versions
+  std::vector<std::pair<uint, ulonglong>> m_versions;
+  /// Value of the cache epoch before execution
+  ulonglong m_epoch;
+  /// Row packets, each prefixed with its length in 4 bytes
+  std::string m_rows;
+  ulonglong m_row_count;
+  /// Whether rows are recorded
+  bool m_capturing;
+  /// Maximum size of the recorded rows
+  size_t m_max_size;
+};
+
+#endif /* RESULT_CACHE_INCLUDED */
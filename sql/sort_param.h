@@ -281,6 +281,7 @@ public:
   TABLE *sort_form;           // For quicker make_sortkey.
   bool use_hash;              // Whether to use hash to distinguish cut JSON
   bool m_force_stable_sort;   // Keep relative order of equal elements
+  uint m_sort_threads;        // Max number of threads sorting a buffer
 
   /**
     ORDER BY list with some precalculated info for filesort.
@@ -414,7 +415,8 @@ public:
   enum enum_sort_algorithm {
     FILESORT_ALG_NONE,
     FILESORT_ALG_STD_SORT,
-    FILESORT_ALG_STD_STABLE
+    FILESORT_ALG_STD_STABLE,
+    FILESORT_ALG_RADIX
   };
   enum_sort_algorithm m_sort_algorithm;
 
@@ -67,6 +67,7 @@
 #include "sql/sql_list.h"
 #include "sql/sql_parse.h"                   // check_table_access
 #include "sql/sql_partition.h"               // set_part_state
+#include "sql/sql_planner.h"                 // invalidate_saved_join_orders
 #include "sql/sql_prepare.h"                 // mysql_test_show
 #include "sql/sql_table.h"                   // mysql_recreate_table
 #include "sql/system_variables.h"
@@ -1457,6 +1458,9 @@ bool Sql_cmd_analyze_table::execute(THD *thd)
                            &handler::ha_analyze, 0, m_alter_info);
   }
 
+  // The statistics used to choose saved join orders may have changed
+  invalidate_saved_join_orders();
+
   /* ! we write after unlocking the table */
   if (!res && !thd->lex->no_write_to_binlog)
   {
@@ -121,6 +121,7 @@
 #include "sql/table.h"                // TABLE_LIST
 #include "sql/table_cache.h"          // table_cache_manager
 #include "sql/table_trigger_dispatcher.h" // Table_trigger_dispatcher
+#include "sql/table_version.h"        // table_version_bump
 #include "sql/thr_malloc.h"
 #include "sql/transaction.h"          // trans_rollback_stmt
 #include "sql/transaction_info.h"
@@ -1819,7 +1820,7 @@ void close_thread_tables(THD *thd)
 */
 static void release_or_close_table(THD *thd, TABLE *table)
 {
-  Table_cache *tc= table_cache_manager.get_cache(thd);
+  Table_cache *tc= table_cache_manager.get_cache(table);
 
   tc->lock();
 
@@ -10616,6 +10617,8 @@ void tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
 
   key_length= create_table_def_key(thd, key, db, table_name, false);
 
+  table_version_bump(key, key_length);
+
   auto it= table_def_cache->find(string(key, key_length));
   if (it != table_def_cache->end())
   {
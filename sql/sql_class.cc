@@ -381,6 +381,7 @@ THD::THD(bool enable_plugins)
    m_idle_psi(NULL),
    m_server_idle(false),
    user_var_events(key_memory_user_var_entry),
+   written_table_versions(PSI_NOT_INSTRUMENTED),
    next_to_commit(NULL),
    binlog_need_explicit_defaults_ts(false),
    kill_immunizer(NULL),
@@ -393,6 +394,7 @@ THD::THD(bool enable_plugins)
    got_warning(false),
    derived_tables_processing(FALSE),
    parsing_system_view(false),
+   histogram_param_selectivities(0),
    sp_runtime_ctx(NULL),
    m_parser_state(NULL),
    work_part_info(NULL),
@@ -2234,6 +2234,12 @@ public:
   Prealloced_array<Binlog_user_var_event*, 2> user_var_events;
   MEM_ROOT      *user_var_events_alloc; /* Allocate above array elements here */
 
+  /**
+    Version counters of the tables written by the current transaction,
+    incremented when the transaction ends. See sql/table_version.h.
+  */
+  Prealloced_array<uint, 4> written_table_versions;
+
   /**
     Used by MYSQL_BIN_LOG to maintain the commit queue for binary log
     group commit.
@@ -2416,6 +2422,12 @@ public:
   bool       derived_tables_processing;
   // Set while parsing INFORMATION_SCHEMA system views.
   bool       parsing_system_view;
+  /**
+    Number of filtering effects computed from a histogram for a predicate
+    whose value may change between executions, such as a comparison with a
+    parameter, cf. Optimize_table_order::save_join_order().
+  */
+  ulonglong  histogram_param_selectivities;
 
   /** Current SP-runtime context. */
   sp_rcontext *sp_runtime_ctx;
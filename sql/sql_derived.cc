@@ -23,6 +23,7 @@
 #include "sql/sql_derived.h"
 
 #include <stddef.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include "my_base.h"
@@ -111,6 +112,9 @@ class Opt_trace_context;
    call.
    - The Server code handling tmp table creation must also be informed:
    see how Query_result_union::create_result_table() disables PK promotion.
+   (4) Materialized view referenced more than once:
+   All of (2) applies. A Common_table_expr object is made to link the
+   references when the second one is set up, see share_view_tmp_table().
 
    How InnoDB manages the uses above
    =================================
@@ -508,6 +512,68 @@ bool TABLE_LIST::setup_materialized_derived(THD *thd)
 }
 
 
+/**
+  Makes a reference to a materialized view share the tmp table of another
+  reference to the same view in the statement, if there is one, like
+  references to a CTE do. The view's query expression is then evaluated
+  once per execution instead of once per reference.
+
+  The Common_table_expr object which links the references is created when
+  the second reference is set up, and is detached from them by
+  destroy_materialized() at the end of the execution.
+
+  The tmp table is not shared if:
+  - the view's query expression is non-deterministic or has side effects:
+  each reference must evaluate it on its own;
+  - the on-disk tmp table engine can't share a table between several TABLE
+  objects (CTEs report ER_SWITCH_TMP_ENGINE in that case);
+  - the other reference's tmp table is already instantiated or has keys,
+  which Common_table_expr::clone_tmp_table() doesn't support.
+
+  @param thd       Thread handler
+  @param view_ref  Reference to a materialized view, without tmp table yet
+
+  @returns true if error
+*/
+static bool share_view_tmp_table(THD *thd, TABLE_LIST *view_ref)
+{
+  DBUG_ASSERT(view_ref->is_view() && view_ref->common_table_expr() == nullptr);
+
+  /*
+    LEX::set_uncacheable() doesn't flag the query blocks of the view's own
+    LEX, but clears its safe_to_cache_query.
+  */
+  if (!view_ref->view_query()->safe_to_cache_query ||
+      (view_ref->derived_unit()->uncacheable &
+       (UNCACHEABLE_RAND | UNCACHEABLE_SIDEEFFECT)) ||
+      internal_tmp_disk_storage_engine != TMP_TABLE_INNODB)
+    return false;
+
+  for (TABLE_LIST *tl= thd->lex->query_tables; tl; tl= tl->next_global)
+  {
+    if (tl == view_ref || !tl->is_view() || tl->table == nullptr ||
+        !tl->uses_materialization() || tl->table->is_created() ||
+        tl->table->s->keys > 0 ||
+        strcmp(tl->get_db_name(), view_ref->get_db_name()) != 0 ||
+        strcmp(tl->get_table_name(), view_ref->get_table_name()) != 0)
+      continue;
+
+    Common_table_expr *cte= tl->common_table_expr();
+    if (cte == nullptr)
+    {
+      // 'tl' is the first reference: its tmp table is the one to share.
+      cte= new (thd->mem_root) Common_table_expr(thd->mem_root);
+      if (cte == nullptr || cte->tmp_tables.push_back(tl))
+        return true;                            /* purecov: inspected */
+      tl->set_common_table_expr(cte);
+    }
+    view_ref->set_common_table_expr(cte);
+    break;
+  }
+  return false;
+}
+
+
 /**
   Sets up the tmp table to contain the derived table's rows.
   @param  thd   THD pointer
@@ -534,6 +600,10 @@ bool TABLE_LIST::setup_materialized_derived_tmp_table(THD *thd)
   // From resolver POV, columns of this table are readonly
   set_readonly();
 
+  if (is_view() && m_common_table_expr == nullptr &&
+      share_view_tmp_table(thd, this))
+    DBUG_RETURN(true);                          /* purecov: inspected */
+
   if (m_common_table_expr && m_common_table_expr->tmp_tables.size() > 0)
   {
     trace_derived.add("reusing_tmp_table", true);
@@ -46,6 +46,7 @@
 #include "my_dbug.h"
 #include "my_loglevel.h"
 #include "my_macros.h"
+#include "my_murmur3.h"
 #include "my_pointer_arithmetic.h"
 #include "my_sqlcommand.h"
 #include "my_sys.h"
@@ -57,6 +58,7 @@
 #include "sql/derror.h"
 #include "sql/enum_query_type.h"
 #include "sql/field.h"
+#include "sql/field_cond_filter.h" // Field_cond_filter
 #include "sql/filesort.h"     // Filesort
 #include "sql/handler.h"
 #include "sql/item_cmpfunc.h"
@@ -1896,7 +1898,11 @@ evaluate_join_record(JOIN *join, QEP_TAB *const qep_tab)
 
   if (condition)
   {
-    found= condition->val_int();
+    const Field_cond_filter *const filter= qep_tab->cond_filter;
+    if (filter != NULL && filter->condition() == condition)
+      found= filter->matches();
+    else
+      found= condition->val_int();
 
     if (join->thd->killed)
     {
@@ -4512,7 +4518,8 @@ bool process_two_pass_wfs(THD *thd,
   defined on the window.
 
   Moving (sliding) frames can be executed using a naive or optimized strategy
-  for aggregate window functions, like SUM or AVG (but not MAX, or MIN).
+  for aggregate window functions, like SUM or AVG, and MAX or MIN over numeric
+  values.
   In the naive approach, for each row considered for processing from the buffer,
   we visit all the rows defined in the frame for that row, essentially leading
   to N*M complexity, where N is the number of rows in the result set, and M is
@@ -4523,6 +4530,8 @@ bool process_two_pass_wfs(THD *thd,
   the contribution to the aggregate by the row(s) leaving the frame, and then
   use the normal aggregate function to add the contribution of the rows moving
   into the frame. The present method contains code paths for both strategies.
+  MAX and MIN have no inverse function, so they keep the values of the frame
+  which may still become the result instead, cf. Item_sum_hybrid::add_moving.
 
   For integral data types, this is safe in the sense that the result will be the
   same if no overflow occurs during normal evaluation. For floating numbers,
@@ -5655,6 +5664,10 @@ end_write(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
       if (!check_unique_constraint(table))
         goto end; // skip it
 
+      Sort_limit_filter *const limit_filter= qep_tab->sort_limit_filter;
+      if (limit_filter && limit_filter->is_rejected())
+        goto end; // not among the rows returned by the sort
+
       if ((error=table->file->ha_write_row(table->record[0])))
       {
         if (table->file->is_ignorable_error(error))
@@ -5665,6 +5678,8 @@ end_write(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
 				    error, TRUE, NULL))
 	  DBUG_RETURN(NESTED_LOOP_ERROR);        // Not a table_is_full error
       }
+      if (limit_filter)
+        limit_filter->add_row();
       if (++qep_tab->send_records >=
             tmp_tbl->end_write_records &&
 	  join->do_send_rows)
@@ -5873,7 +5888,12 @@ end_update(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
   DBUG_ENTER("end_update");
 
   if (end_of_records)
+  {
+    // Write the groups kept in memory before the tmp table is read
+    if (qep_tab->group_cache != NULL && qep_tab->group_cache->flush())
+      DBUG_RETURN(NESTED_LOOP_ERROR);
     DBUG_RETURN(NESTED_LOOP_OK);
+  }
   if (join->thd->killed)			// Aborted by user
   {
     join->thd->send_kill_message();
@@ -5902,15 +5922,32 @@ end_update(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
   }
   else
   {
+    Group_row_cache *const cache= qep_tab->group_cache;
     for (group=table->group ; group ; group=group->next)
     {
       Item *item= *group->item;
       item->save_org_in_field(group->field);
       /* Store in the used key if the field was 0 */
       if (item->maybe_null)
+      {
         group->buff[-1]= (char) group->field->is_null();
+        // The cache compares keys byte by byte, ignore the value of NULL
+        if (cache != NULL && group->buff[-1])
+          memset(group->buff, 0, group->field->pack_length());
+      }
     }
     const uchar *key= tmp_tbl->group_buff;
+    if (cache != NULL)
+    {
+      uchar *const row= cache->find(key);
+      if (row != NULL)
+      {
+        memcpy(table->record[0], row, table->s->reclength);
+        update_tmptable_sum_func(join->sum_funcs, table);
+        cache->update();
+        DBUG_RETURN(NESTED_LOOP_OK);
+      }
+    }
     if (!table->file->ha_index_read_map(table->record[1],
                                         key,
                                         HA_WHOLE_KEY,
@@ -5926,11 +5963,15 @@ end_update(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
                                           table->record[0])))
     {
       // Old and new records are the same, ok to ignore
-      if (error == HA_ERR_RECORD_IS_THE_SAME)
-        DBUG_RETURN(NESTED_LOOP_OK);
-      table->file->print_error(error, MYF(0));   /* purecov: inspected */
-      DBUG_RETURN(NESTED_LOOP_ERROR);            /* purecov: inspected */
+      if (error != HA_ERR_RECORD_IS_THE_SAME)
+      {
+        table->file->print_error(error, MYF(0)); /* purecov: inspected */
+        DBUG_RETURN(NESTED_LOOP_ERROR);          /* purecov: inspected */
+      }
     }
+    if (qep_tab->group_cache != NULL &&
+        qep_tab->group_cache->store(tmp_tbl->group_buff))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
     DBUG_RETURN(NESTED_LOOP_OK);
   }
 
@@ -5972,10 +6013,166 @@ end_update(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
     }
   }
   qep_tab->send_records++;
+  if (qep_tab->group_cache != NULL &&
+      qep_tab->group_cache->store(tmp_tbl->group_buff))
+    DBUG_RETURN(NESTED_LOOP_ERROR);
   DBUG_RETURN(NESTED_LOOP_OK);
 }
 
 
+/// Maximum number of groups in a Group_row_cache
+static const uint GROUP_CACHE_MAX_SLOTS= 256;
+/// Maximum size of the rows of a Group_row_cache
+static const size_t GROUP_CACHE_MAX_SIZE= 256 * 1024;
+/// Minimum number of groups for a Group_row_cache to be worth it
+static const uint GROUP_CACHE_MIN_SLOTS= 16;
+
+
+Group_row_cache *
+Group_row_cache::create(THD *thd, TABLE *table, Temp_table_param *param)
+{
+  if (table->hash_field || table->s->blob_fields > 0 || table->group == NULL)
+    return NULL;
+
+  /*
+    Group keys must be equal byte by byte if and only if the groups are
+    equal: integer and temporal columns, whose NULL values end_update()
+    clears.
+  */
+  for (ORDER *group= table->group; group; group= group->next)
+  {
+    switch (group->field->real_type())
+    {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_NEWDATE:
+    case MYSQL_TYPE_TIME2:
+    case MYSQL_TYPE_DATETIME2:
+    case MYSQL_TYPE_TIMESTAMP2:
+      break;
+    default:
+      return NULL;
+    }
+  }
+
+  const uint key_length= param->group_length;
+  const size_t slot_size= key_length + table->s->reclength;
+  const uint num_slots=
+    static_cast<uint>(std::min<size_t>(GROUP_CACHE_MAX_SLOTS,
+                                       GROUP_CACHE_MAX_SIZE / slot_size));
+  if (num_slots < GROUP_CACHE_MIN_SLOTS)
+    return NULL;
+
+  Slot *const slots= static_cast<Slot*>(thd->alloc(num_slots * sizeof(Slot)));
+  uchar *const data=
+    static_cast<uchar*>(thd->alloc(num_slots * slot_size +
+                                   table->s->reclength));
+  if (slots == NULL || data == NULL)
+    return NULL;                                /* purecov: inspected */
+  for (uint i= 0; i < num_slots; i++)
+    slots[i].data= data + i * slot_size;
+
+  Group_row_cache *const cache= new (thd->mem_root)
+    Group_row_cache(table, key_length, slots, num_slots,
+                    data + num_slots * slot_size);
+  if (cache != NULL)
+    cache->reset();
+  return cache;
+}
+
+
+void Group_row_cache::reset()
+{
+  for (uint i= 0; i < m_num_slots; i++)
+    m_slots[i].used= m_slots[i].dirty= false;
+}
+
+
+Group_row_cache::Slot *Group_row_cache::slot_for(const uchar *key) const
+{
+  return m_slots + murmur3_32(key, m_key_length, 0) % m_num_slots;
+}
+
+
+uchar *Group_row_cache::find(const uchar *key)
+{
+  Slot *const slot= slot_for(key);
+  if (!slot->used || memcmp(slot->data, key, m_key_length) != 0)
+    return NULL;
+  m_found= slot;
+  return slot->data + m_key_length;
+}
+
+
+void Group_row_cache::update()
+{
+  DBUG_ASSERT(m_found != NULL && m_found->used);
+  memcpy(m_found->data + m_key_length, m_table->record[0],
+         m_table->s->reclength);
+  m_found->dirty= true;
+}
+
+
+bool Group_row_cache::store(const uchar *key)
+{
+  Slot *const slot= slot_for(key);
+  if (slot->dirty && write_back(slot))
+    return true;
+  memcpy(slot->data, key, m_key_length);
+  memcpy(slot->data + m_key_length, m_table->record[0],
+         m_table->s->reclength);
+  slot->used= true;
+  slot->dirty= false;
+  return false;
+}
+
+
+bool Group_row_cache::flush()
+{
+  for (uint i= 0; i < m_num_slots; i++)
+  {
+    if (m_slots[i].dirty && write_back(m_slots + i))
+      return true;
+  }
+  return false;
+}
+
+
+/**
+  Updates the row of the group of a slot in the tmp table with the cached
+  row. record[0] and record[1] are used for the update, record[0] is
+  restored afterwards.
+*/
+
+bool Group_row_cache::write_back(Slot *slot)
+{
+  const size_t reclength= m_table->s->reclength;
+  handler *const file= m_table->file;
+  memcpy(m_save_buff, m_table->record[0], reclength);
+  int error= file->ha_index_read_map(m_table->record[1], slot->data,
+                                     HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+  if (error == 0)
+  {
+    memcpy(m_table->record[0], slot->data + m_key_length, reclength);
+    error= file->ha_update_row(m_table->record[1], m_table->record[0]);
+    if (error == HA_ERR_RECORD_IS_THE_SAME)
+      error= 0;
+  }
+  memcpy(m_table->record[0], m_save_buff, reclength);
+  if (error)
+  {
+    file->print_error(error, MYF(0));           /* purecov: inspected */
+    return true;                                /* purecov: inspected */
+  }
+  slot->dirty= false;
+  return false;
+}
+
+
 	/* ARGSUSED */
 enum_nested_loop_state
 end_write_group(JOIN *join, QEP_TAB *const qep_tab, bool end_of_records)
@@ -7105,6 +7302,45 @@ QEP_tmp_table::prepare_tmp_table()
     DBUG_RETURN(true);
   }
 
+  /*
+    Keep the rows of recent groups in memory, to save looking them up and
+    updating them in the table for every row.
+  */
+  if (write_func == end_update)
+  {
+    if (qep_tab->group_cache == NULL)
+      qep_tab->group_cache=
+        Group_row_cache::create(join->thd, table, tmp_tbl);
+    else
+      qep_tab->group_cache->reset();
+  }
+
+  /*
+    If the table is only read by a filesort with a LIMIT, the rows which
+    cannot be among the sorted rows returned need not be written. Not
+    done if rows are removed before or while sorting (duplicates or a
+    condition), or if they all must be counted.
+  */
+  Filesort *const filesort= qep_tab->filesort;
+  if (write_func == end_write && filesort != NULL &&
+      filesort->limit != HA_POS_ERROR && !qep_tab->distinct &&
+      qep_tab->condition() == NULL && !join->calc_found_rows)
+  {
+    if (qep_tab->sort_limit_filter == NULL)
+    {
+      Sort_limit_filter *const filter=
+        new (join->thd->mem_root) Sort_limit_filter;
+      if (filter == NULL)
+        DBUG_RETURN(true);                      /* purecov: inspected */
+      qep_tab->sort_limit_filter= filter;
+      Switch_ref_item_slice slice_switch(join, qep_tab->ref_item_slice);
+      if (filter->init(join->thd, filesort))
+        DBUG_RETURN(true);
+    }
+    else
+      qep_tab->sort_limit_filter->reset();
+  }
+
   DBUG_RETURN(false);
 }
 
@@ -41,14 +41,17 @@
 #include "sql/temp_table_param.h"  // Temp_table_param
 
 class Field;
+class Field_cond_filter;
 class Field_longlong;
 class Filesort;
+class Group_row_cache;
 class Item_sum;
 class JOIN;
 class Opt_trace_context;
 class Opt_trace_object;
 class QEP_TAB;
 class QUICK_SELECT_I;
+class Sort_limit_filter;
 struct st_cache_field;
 struct st_join_table;
 template <class T> class List;
@@ -298,6 +301,104 @@ private:
 };
 
 
+/**
+  A cache in memory of rows of a tmp table which is grouped by
+  end_update().
+
+  Rows of a few hundred groups are kept in slots chosen by a hash of the
+  group key. A row read for a group in the cache updates the aggregate
+  functions of the cached row, instead of looking up the group in the
+  tmp table and updating it there. Cached rows are written back to the
+  tmp table when their slot is taken by another group, and at the end of
+  the grouping.
+
+  A group must never be both in the cache and, with other aggregate
+  values, looked up in the tmp table. So the cache is used only if equal
+  group keys are equal byte by byte, see Group_row_cache::create().
+*/
+
+class Group_row_cache : public Sql_alloc
+{
+public:
+  /**
+    Creates a cache for the groups of a tmp table.
+
+    @param thd     thread handler
+    @param table   the tmp table, grouped by its first key
+    @param param   parameters of the tmp table
+
+    @returns the cache, or NULL if the group key or the rows are not
+             suitable for caching, or if out of memory.
+  */
+  static Group_row_cache *create(THD *thd, TABLE *table,
+                                 Temp_table_param *param);
+
+  /// Empties the cache, without writing the cached rows.
+  void reset();
+
+  /**
+    Finds the cached row of a group.
+
+    @param key  the group key, as in Temp_table_param::group_buff
+
+    @returns the cached row, or NULL if the group is not in the cache
+  */
+  uchar *find(const uchar *key);
+
+  /**
+    Replaces the row returned by the last find() with record[0], where its
+    aggregate values have been updated.
+  */
+  void update();
+
+  /**
+    Caches record[0], which has just been written to the tmp table, as the
+    row of a group. The row of another group which had the same slot is
+    written back to the tmp table if it has changed.
+
+    @param key  the group key
+
+    @returns true if writing back a row failed, false otherwise
+  */
+  bool store(const uchar *key);
+
+  /**
+    Writes all changed rows back to the tmp table.
+
+    @returns true if writing a row failed, false otherwise
+  */
+  bool flush();
+
+private:
+  struct Slot
+  {
+    /// Group key, followed by the row
+    uchar *data;
+    bool used;
+    /// Whether the row has been changed since written to the tmp table
+    bool dirty;
+  };
+
+  Group_row_cache(TABLE *table, uint key_length, Slot *slots,
+                  uint num_slots, uchar *save_buff)
+    : m_table(table), m_key_length(key_length), m_slots(slots),
+      m_num_slots(num_slots), m_save_buff(save_buff), m_found(NULL)
+  {}
+
+  Slot *slot_for(const uchar *key) const;
+  bool write_back(Slot *slot);
+
+  TABLE *const m_table;
+  const uint m_key_length;
+  Slot *const m_slots;
+  const uint m_num_slots;
+  /// Holds record[0] while a row is written back
+  uchar *const m_save_buff;
+  /// The slot of the row returned by the last find()
+  Slot *m_found;
+};
+
+
 void setup_tmptable_write_func(QEP_TAB *tab, uint phase,
                                Opt_trace_object *trace);
 enum_nested_loop_state sub_select_op(JOIN *join, QEP_TAB *qep_tab, bool
@@ -439,6 +540,9 @@ public:
     op(NULL),
     tmp_table_param(NULL),
     filesort(NULL),
+    sort_limit_filter(NULL),
+    group_cache(NULL),
+    cond_filter(NULL),
     fields(NULL),
     all_fields(NULL),
     ref_item_slice(REF_SLICE_SAVE),
@@ -665,6 +769,15 @@ public:
   /* Sorting related info */
   Filesort *filesort;
 
+  /// Skips rows written to this tmp table that filesort's LIMIT would drop
+  Sort_limit_filter *sort_limit_filter;
+
+  /// Rows of groups kept in memory when this tmp table is grouped
+  Group_row_cache *group_cache;
+
+  /// condition() compiled to simple terms, see Field_cond_filter
+  Field_cond_filter *cond_filter;
+
   /**
     List of topmost expressions in the select list. The *next* JOIN TAB
     in the plan should use it to obtain correct values. Same applicable to
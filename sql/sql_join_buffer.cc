@@ -38,6 +38,7 @@
 #include "my_table_map.h"
 #include "sql/field.h"
 #include "sql/item.h"
+#include "sql/item_cmpfunc.h"
 #include "sql/key.h"
 #include "sql/opt_trace.h"  // Opt_trace_object
 #include "sql/psi_memory_key.h" // key_memory_JOIN_CACHE
@@ -641,6 +642,154 @@ void JOIN_CACHE::restore_virtual_gcol_base_cols()
   }
 }
 
+/**
+  Check whether the records of the join buffer can be hashed on a column
+  that is compared for equality with a column of the joined table.
+
+  Values that are equal according to the comparison of the two columns
+  must give the same hash value. That holds for integer columns, hashed
+  on their integer value, and for character columns of the same
+  character set and collation, hashed with the collation.
+
+  @param inner  column of the joined table
+  @param outer  column of a table whose records are in the join buffer
+  @return whether the columns can be used to hash the join buffer
+*/
+
+static bool bnl_hash_key_compatible(const Field *inner, const Field *outer)
+{
+  switch (inner->real_type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+    switch (outer->real_type()) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+      return true;
+    default:
+      return false;
+    }
+  case MYSQL_TYPE_STRING:
+  case MYSQL_TYPE_VARCHAR:
+  case MYSQL_TYPE_VAR_STRING:
+    switch (outer->real_type()) {
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+      return inner->charset() == outer->charset();
+    default:
+      return false;
+    }
+  default:
+    return false;
+  }
+}
+
+
+/**
+  Find the equalities usable to hash the records of a BNL join buffer.
+
+  Only equalities that are conjuncts of the condition attached to the
+  joined table are used: a record of the join buffer whose columns differ
+  from the ones of the current row of the joined table cannot match it,
+  so it does not need to be read from the buffer.
+*/
+
+void JOIN_CACHE_BNL::find_hash_key_parts()
+{
+  hash_key_parts= 0;
+
+  Item *const cond= qep_tab->condition();
+  if (cond == NULL)
+    return;
+
+  const table_map inner_map= qep_tab->table_ref->map();
+
+  auto add_equality= [&](Item *item)
+  {
+    if (hash_key_parts == MAX_REF_PARTS ||
+        item->type() != Item::FUNC_ITEM ||
+        ((Item_func *) item)->functype() != Item_func::EQ_FUNC)
+      return;
+
+    Item **const args= ((Item_func *) item)->arguments();
+    Item *inner= args[0]->real_item();
+    Item *outer= args[1]->real_item();
+    if (inner->type() != Item::FIELD_ITEM || outer->type() != Item::FIELD_ITEM)
+      return;
+    if (outer->used_tables() == inner_map)
+      std::swap(inner, outer);
+    if (inner->used_tables() != inner_map ||
+        (outer->used_tables() & (inner_map | PSEUDO_TABLE_BITS)))
+      return;
+
+    Field *const inner_field= ((Item_field *) inner)->field;
+    Field *const outer_field= ((Item_field *) outer)->field;
+    if (inner_field->table != qep_tab->table() ||
+        !bnl_hash_key_compatible(inner_field, outer_field))
+      return;
+
+    hash_inner_fields[hash_key_parts]= inner_field;
+    hash_outer_fields[hash_key_parts]= outer_field;
+    hash_key_parts++;
+  };
+
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond *) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator<Item> it(*((Item_cond *) cond)->argument_list());
+    Item *item;
+    while ((item= it++))
+      add_equality(item);
+  }
+  else
+    add_equality(cond);
+}
+
+
+/**
+  Calculate the hash value of the equality columns of a record.
+
+  @param      key_fields  the columns to hash, hash_key_parts of them
+  @param[out] hash        the hash value
+  @return whether any of the columns is NULL, then there is no match
+*/
+
+bool JOIN_CACHE_BNL::calc_hash_key(Field **key_fields, uint32 *hash) const
+{
+  ulong nr1= 1, nr2= 4;
+  for (uint i= 0; i < hash_key_parts; i++)
+  {
+    Field *const field= key_fields[i];
+    if (field->is_null())
+      return true;
+    if (field->result_type() == INT_RESULT)
+    {
+      uchar buf[8];
+      int8store(buf, field->val_int());
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buf, sizeof(buf),
+                                     &nr1, &nr2);
+    }
+    else
+    {
+      const CHARSET_INFO *const cs= field->charset();
+      char buf[STRING_BUFFER_USUAL_SIZE];
+      String tmp(buf, sizeof(buf), cs);
+      const String *const str= field->val_str(&tmp);
+      cs->coll->hash_sort(cs, pointer_cast<const uchar *>(str->ptr()),
+                          str->length(), &nr1, &nr2);
+    }
+  }
+  *hash= static_cast<uint32>(nr1);
+  return false;
+}
+
+
 /* 
   Initialize a BNL cache       
 
@@ -698,6 +847,8 @@ int JOIN_CACHE_BNL::init()
 
   restore_virtual_gcol_base_cols();
 
+  find_hash_key_parts();
+
   set_constants();
 
   if (alloc_buffer())
@@ -2037,6 +2188,9 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
   // See setup_join_buffering(=: dynamic range => no cache.
   DBUG_ASSERT(!(qep_tab->dynamic_range() && qep_tab->quick()));
 
+  /* Hash the records of the join buffer on the equality columns */
+  const bool hashed= hash_key_parts && build_hash_table(skip_last);
+
   /* Start retrieving all records of the joined table */
   if ((error= (*qep_tab->read_first_record)(qep_tab)))
     return error < 0 ? NESTED_LOOP_OK : NESTED_LOOP_ERROR;
@@ -2069,6 +2223,14 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
         if (!consider_record)
           continue;
       }
+      if (hashed)
+      {
+        /* Read only the records with the same hash value */
+        rc= join_hashed_records();
+        if (rc != NESTED_LOOP_OK)
+          return rc;
+      }
+      else
       {
         /* Prepare to read records from the join buffer */
         reset_cache(false);
@@ -2098,6 +2260,102 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
 }
 
 
+/**
+  Hash the records of a BNL join buffer.
+
+  The hash table is placed right after the last record of the buffer, in
+  the space reserved by reserve_aux_buffer(). It consists of an array of
+  bucket heads followed by an entry for each record with non-NULL values of
+  the equality columns. An entry contains the hash value, the position of
+  the record and the number of the next entry of the same bucket. The
+  entries of a bucket are chained in the order of the records in the
+  buffer, so that the matches are found in the same order as when all
+  records of the buffer are read.
+
+  @param skip_last  whether to leave out the last record of the buffer
+  @return whether the hash table has been built, false if there is not
+          enough space for it
+*/
+
+bool JOIN_CACHE_BNL::build_hash_table(bool skip_last)
+{
+  const uint n_recs= records - skip_last;
+  if (n_recs == 0 || aux_buff_size < ulong(n_recs) * hash_entry_size())
+    return false;
+
+  const uint rec_ofs_size= get_size_of_rec_offset();
+  const uint entry_size= hash_entry_size() - sizeof(uint32);
+
+  hash_buckets= n_recs;
+  hash_bucket_heads= end_pos;
+  hash_entries= hash_bucket_heads + hash_buckets * sizeof(uint32);
+  DBUG_ASSERT(hash_entries + n_recs * entry_size <= buff + buff_size);
+  memset(hash_bucket_heads, 0, hash_buckets * sizeof(uint32));
+
+  /* Hash the equality columns of each record of the buffer */
+  reset_cache(false);
+  uint n_entries= 0;
+  for (uint cnt= n_recs; cnt; cnt--)
+  {
+    get_record();
+    uint32 hash;
+    if (calc_hash_key(hash_outer_fields, &hash))
+      continue;                                 // NULL never matches
+    uchar *const entry= hash_entries + n_entries * entry_size;
+    int4store(entry, hash);
+    store_offset(rec_ofs_size, entry + sizeof(uint32),
+                 ulong(get_curr_rec() - buff));
+    n_entries++;
+  }
+
+  /* Chain the entries of each bucket, first record first */
+  for (uint i= n_entries; i > 0; i--)
+  {
+    uchar *const entry= hash_entries + (i - 1) * entry_size;
+    uchar *const head= hash_bucket_heads +
+                       (uint4korr(entry) % hash_buckets) * sizeof(uint32);
+    int4store(entry + sizeof(uint32) + rec_ofs_size, uint4korr(head));
+    int4store(head, i);
+  }
+  return true;
+}
+
+
+enum_nested_loop_state JOIN_CACHE_BNL::join_hashed_records()
+{
+  uint32 hash;
+  if (calc_hash_key(hash_inner_fields, &hash))
+    return NESTED_LOOP_OK;                      // NULL never matches
+
+  const uint rec_ofs_size= get_size_of_rec_offset();
+  const uint entry_size= hash_entry_size() - sizeof(uint32);
+
+  for (uint i= uint4korr(hash_bucket_heads +
+                         (hash % hash_buckets) * sizeof(uint32)); i; )
+  {
+    const uchar *const entry= hash_entries + (i - 1) * entry_size;
+    i= uint4korr(entry + sizeof(uint32) + rec_ofs_size);
+    if (uint4korr(entry) != hash)
+      continue;
+
+    uchar *const rec_ptr= buff + get_offset(rec_ofs_size,
+                                            entry + sizeof(uint32));
+    /*
+      If only the first match is needed and it has been already found for
+      this record then the record is skipped.
+    */
+    if (check_only_first_match && get_match_flag_by_pos(rec_ptr))
+      continue;
+
+    get_record_by_pos(rec_ptr);
+    const enum_nested_loop_state rc= generate_full_extensions(rec_ptr);
+    if (rc != NESTED_LOOP_OK)
+      return rc;
+  }
+  return NESTED_LOOP_OK;
+}
+
+
 bool JOIN_CACHE::calc_check_only_first_match(const QEP_TAB *t) const
 {
   if ((t->last_sj_inner() == t->idx() &&
@@ -552,6 +552,19 @@ public:
   friend class JOIN_CACHE_BKA_UNIQUE;
 };
 
+/**
+  The class JOIN_CACHE_BNL supports the Block Nested Loops join algorithm.
+
+  If the condition attached to the joined table contains equalities
+  between columns of the joined table and columns of the tables whose
+  records are in the join buffer, the records of the buffer are hashed on
+  the values of these columns every time the buffer has been filled. Each
+  row of the joined table is then compared only with the records of the
+  buffer that have the same hash value, instead of with all of them.
+  The hash table is placed at the end of the join buffer and takes
+  hash_entry_size() bytes per record.
+*/
+
 class JOIN_CACHE_BNL final :public JOIN_CACHE
 {
 
@@ -560,17 +573,97 @@ protected:
   enum_nested_loop_state join_matching_records(bool skip_last)
     override;
 
+  /// Reserve space for the hash table entry of a record.
+  void reserve_aux_buffer() override
+  {
+    if (!hash_key_parts)
+      return;
+    if (auto rem= rem_space())
+      aux_buff_size+= pack_length + hash_entry_size() < rem ?
+                      hash_entry_size() : rem;
+  }
+
+  /// @return the minimum size for the hash table
+  uint aux_buffer_min_size() const override
+  {
+    return hash_key_parts ? hash_entry_size() : 0;
+  }
+
 public:
   JOIN_CACHE_BNL(JOIN *j, QEP_TAB *qep_tab_arg, JOIN_CACHE *prev)
-    : JOIN_CACHE(j, qep_tab_arg, prev), const_cond(NULL)
+    : JOIN_CACHE(j, qep_tab_arg, prev), const_cond(NULL),
+      hash_key_parts(0), aux_buff_size(0), hash_buckets(0),
+      hash_bucket_heads(NULL), hash_entries(NULL)
   {}
 
   int init() override;
 
+  void reset_cache(bool for_writing) override
+  {
+    JOIN_CACHE::reset_cache(for_writing);
+    if (for_writing)
+      aux_buff_size= 0;
+  }
+
+  /// @return how much space is remaining in the join buffer
+  ulong rem_space() const override
+  {
+    const auto space= JOIN_CACHE::rem_space();
+    DBUG_ASSERT(space >= aux_buff_size);
+    return space - aux_buff_size;
+  }
+
   enum_join_cache_type cache_type() const override { return ALG_BNL; }
 
 private:
+  /// Find the equalities usable to hash the records of the join buffer.
+  void find_hash_key_parts();
+
+  /**
+    Calculate the hash value of the equality columns of a record.
+    @param      key_fields  the columns to hash, hash_key_parts of them
+    @param[out] hash        the hash value
+    @return whether any of the columns is NULL, then there is no match
+  */
+  bool calc_hash_key(Field **key_fields, uint32 *hash) const;
+
+  /// @return the number of bytes of the hash table used for a record
+  uint hash_entry_size() const
+  {
+    /* bucket head, hash value, record offset and link to the next entry */
+    return 3 * sizeof(uint32) + get_size_of_rec_offset();
+  }
+
+  /**
+    Hash the records of the join buffer.
+    @param skip_last  whether to leave out the last record of the buffer
+    @return whether the hash table has been built
+  */
+  bool build_hash_table(bool skip_last);
+
+  /**
+    Find matches for the current row of the joined table among the records
+    of the join buffer with the same hash value.
+    @return nested loop state
+  */
+  enum_nested_loop_state join_hashed_records();
+
   Item *const_cond;
+
+  /// Number of equalities usable to hash the records of the join buffer
+  uint hash_key_parts;
+  /// Columns of the joined table in these equalities
+  Field *hash_inner_fields[MAX_REF_PARTS];
+  /// Columns of the tables of the join buffer in these equalities
+  Field *hash_outer_fields[MAX_REF_PARTS];
+  /// Size of the space reserved for the hash table at the buffer's end
+  ulong aux_buff_size;
+  /// Number of buckets of the hash table
+  uint hash_buckets;
+  /// Heads of the bucket chains of the hash table
+  uchar *hash_bucket_heads;
+  /// Entries of the hash table, one per hashed record
+  uchar *hash_entries;
 };
 
 class JOIN_CACHE_BKA :public JOIN_CACHE
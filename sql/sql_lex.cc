@@ -2364,6 +2364,7 @@ SELECT_LEX::SELECT_LEX(Item *where, Item *having)
   select_list_tables(0),
   outer_join(0),
   opt_hints_qb(NULL),
+  saved_join_order(NULL),
   m_agg_func_used(false),
   m_json_agg_func_used(false),
   m_empty_query(false),
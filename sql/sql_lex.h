@@ -118,6 +118,7 @@ class SELECT_LEX_UNIT;
 class Select_lex_visitor;
 class THD;
 class Window;
+struct Saved_join_order;
 
 typedef Parse_tree_node_tmpl<struct Alter_tablespace_parse_context>
     PT_alter_tablespace_option_base;
@@ -1268,6 +1269,13 @@ public:
   /// Query-block-level hints, for this query block
   Opt_hints_qb *opt_hints_qb;
 
+  /**
+    Join order chosen when this query block was last optimized, for reuse
+    by later executions of the prepared statement or stored program.
+    NULL if none, cf. Optimize_table_order::reuse_join_order().
+  */
+  Saved_join_order *saved_join_order;
+
 
   /**
     @note the group_by and order_by lists below will probably be added to the
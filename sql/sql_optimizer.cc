@@ -51,6 +51,7 @@
 #include "sql/debug_sync.h"      // DEBUG_SYNC
 #include "sql/derror.h"          // ER_THD
 #include "sql/enum_query_type.h"
+#include "sql/field_cond_filter.h" // Field_cond_filter
 #include "sql/handler.h"
 #include "sql/item_cmpfunc.h"
 #include "sql/item_func.h"
@@ -830,6 +831,19 @@ JOIN::optimize()
       DBUG_RETURN(1);
   }
 
+  /*
+    Compile the conditions of tables which are simple enough to be
+    evaluated without the Item tree. A condition which is replaced later
+    is evaluated as usual, see evaluate_join_record().
+  */
+  for (uint i= const_tables; i < primary_tables; i++)
+  {
+    QEP_TAB *const tab= qep_tab + i;
+    if (tab->condition() != NULL && tab->table() != NULL)
+      tab->cond_filter=
+        Field_cond_filter::create(thd, tab->condition(), tab->table());
+  }
+
   // Update m_current_query_cost to reflect actual need of filesort.
   if (sort_cost > 0.0 && !explain_flags.any(ESP_USING_FILESORT))
   {
@@ -44,15 +44,18 @@
 #include "sql/enum_query_type.h"
 #include "sql/field.h"
 #include "sql/handler.h"
+#include "sql/histograms/histogram.h" // Histogram
 #include "sql/item.h"
 #include "sql/item_cmpfunc.h"
 #include "sql/key.h"
 #include "sql/merge_sort.h"     // merge_sort
 #include "sql/opt_costmodel.h"
 #include "sql/opt_hints.h"      // hint_table_state
+#include "sql/opt_join_order.h" // join_order_dp_search
 #include "sql/opt_range.h"      // QUICK_SELECT_I
 #include "sql/opt_trace.h"      // Opt_trace_object
 #include "sql/opt_trace_context.h"
+#include "sql/psi_memory_key.h"  // key_memory_join_order_search
 #include "sql/query_options.h"
 #include "sql/sql_bitmap.h"
 #include "sql/sql_class.h"      // THD
@@ -71,6 +74,25 @@
 using std::max;
 using std::min;
 
+/**
+  Version of the statistics of the tables. A join order saved with an older
+  version is not reused, cf. Saved_join_order.
+*/
+static std::atomic<ulonglong> saved_join_order_version(0);
+
+/**
+  Number of tables up to which the search for a join order is exhaustive by
+  default, cf. determine_search_depth(). With optimizer_prune_level=2, joins
+  with more tables are ordered by dp_search() when possible.
+*/
+static const uint max_tables_for_exhaustive_opt= 7;
+
+/**
+  Maximum number of partial plans that dp_search() considers for placing a
+  block of tables.
+*/
+static const ulonglong max_dp_partial_plans= 10000;
+
 static double prev_record_reads(JOIN *join, uint idx, table_map found_ref);
 static void trace_plan_prefix(JOIN *join, uint idx,
                               table_map excluded_tables);
@@ -114,6 +136,62 @@ cache_record_length(JOIN *join,uint idx)
 }
 
 
+/**
+  Estimate the fanout of 'ref' access on a single keypart from histograms.
+
+  If the keypart is looked up with the value of a column from an earlier
+  table in the plan ("t1.keypart1 = t2.col"), and both columns have a
+  histogram, the number of matching rows per lookup is estimated from the
+  join selectivity of the two histograms. Unlike records_per_key, which is an
+  average over all values in the index, this takes into account which values
+  the other column actually has, so that skewed columns get a realistic
+  estimate.
+
+  @param tab           the table accessed with 'ref'
+  @param keyuse        the equality predicate used for the first keypart
+  @param [out] fanout  the estimated number of rows per lookup
+
+  @return true if no estimate could be made, false otherwise
+*/
+static bool get_histogram_ref_fanout(const JOIN_TAB *tab,
+                                     const Key_use *keyuse, double *fanout)
+{
+  if (keyuse == NULL || keyuse->keypart != 0)
+    return true;
+
+  const Item *const val= keyuse->val->real_item();
+  if (val->type() != Item::FIELD_ITEM)
+    return true;
+
+  TABLE *const table= tab->table();
+  const Field *const field= table->key_info[keyuse->key].key_part[0].field;
+  const Field *const other_field= down_cast<const Item_field*>(val)->field;
+
+  const histograms::Histogram *const histogram=
+    table->s->find_histogram(field->field_index);
+  if (histogram == nullptr)
+    return true;
+
+  const histograms::Histogram *const other_histogram=
+    other_field->table->s->find_histogram(other_field->field_index);
+  if (other_histogram == nullptr)
+    return true;
+
+  double selectivity;
+  if (histogram->get_join_selectivity(*other_histogram, &selectivity))
+    return true;
+
+  /*
+    The selectivity is relative to all rows in the other table, including
+    those that have no match in this table, so the fanout may well be less
+    than one row. Never go below that, since histograms may be out of date
+    and 'ref' access still has to read the index.
+  */
+  *fanout= max(tab->records() * selectivity, 1.0);
+  return false;
+}
+
+
 Optimize_table_order::Optimize_table_order(THD *thd_arg, JOIN *join_arg,
                                            TABLE_LIST *sjm_nest_arg)
 : thd(thd_arg), join(join_arg),
@@ -125,7 +203,8 @@ Optimize_table_order::Optimize_table_order(THD *thd_arg, JOIN *join_arg,
                    (join->all_table_map & ~emb_sjm_nest->sj_inner_tables) : 0) |
                   (join->allow_outer_refs ? 0 : OUTER_REF_TABLE_BIT)),
   has_sj(!(join->select_lex->sj_nests.is_empty() || emb_sjm_nest)),
-  test_all_ref_keys(false), found_plan_with_allowed_sj(false)
+  test_all_ref_keys(false), found_plan_with_allowed_sj(false),
+  histogram_param_selectivities(thd->histogram_param_selectivities)
 {}
 
 
@@ -246,6 +325,8 @@ Key_use* Optimize_table_order::find_best_ref(const JOIN_TAB *tab,
     // Calculate how many key segments of the current key we can use
     Key_use *const start_key= keyuse;
     start_key->bound_keyparts= 0;  // Initially, no ref access is possible
+    // The best equality predicate for the first keypart, if any
+    const Key_use *first_keypart_keyuse= NULL;
 
     // For each keypart
     while (keyuse->table_ref == tab->table_ref && keyuse->key == key)
@@ -303,6 +384,8 @@ Key_use* Optimize_table_order::find_best_ref(const JOIN_TAB *tab,
           */
           cur_keypart_table_deps= keyuse->used_tables & ~join->const_table_map;
           best_distinct_prefix_rowcount= cur_distinct_prefix_rowcount;
+          if (keypart == 0)
+            first_keypart_keyuse= keyuse;
         }
         if (distinct_keys_est > keyuse->ref_table_rows)
           distinct_keys_est= keyuse->ref_table_rows;
@@ -411,8 +494,17 @@ Key_use* Optimize_table_order::find_best_ref(const JOIN_TAB *tab,
           }
           else
           {
+            double histogram_fanout;
+            // Use histograms on the joined columns if available
+            if (actual_key_parts(keyinfo) == 1 &&
+                !get_histogram_ref_fanout(tab, first_keypart_keyuse,
+                                          &histogram_fanout))
+            {
+              cur_fanout= histogram_fanout;
+            }
             // Use records per key statistics if available
-            if (keyinfo->has_records_per_key(actual_key_parts(keyinfo) - 1))
+            else if (keyinfo->has_records_per_key(actual_key_parts(keyinfo) -
+                                                  1))
             {
               cur_fanout=
                 keyinfo->records_per_key(actual_key_parts(keyinfo) - 1);
@@ -532,8 +624,16 @@ Key_use* Optimize_table_order::find_best_ref(const JOIN_TAB *tab,
         }
         else
         {
+          double histogram_fanout;
+          // Check if we have histograms on the joined columns
+          if (cur_used_keyparts == 1 && table_deps &&
+              !get_histogram_ref_fanout(tab, first_keypart_keyuse,
+                                        &histogram_fanout))
+          {
+            tmp_fanout= cur_fanout= histogram_fanout;
+          }
           // Check if we have statistic about the distribution
-          if (keyinfo->has_records_per_key(cur_used_keyparts - 1))
+          else if (keyinfo->has_records_per_key(cur_used_keyparts - 1))
           {
             cur_fanout= keyinfo->records_per_key(cur_used_keyparts - 1);
 
@@ -1935,6 +2035,12 @@ bool Optimize_table_order::choose_table_order()
     join_tables= join->all_table_map & ~join->const_table_map;
   }
 
+  /*
+    A join order saved by an earlier execution of the statement makes the
+    search unnecessary, if it is still valid.
+  */
+  const bool reuse_order= !straight_join && reuse_join_order();
+
   Opt_trace_object wrapper(&join->thd->opt_trace);
   Opt_trace_array
     trace_plan(&join->thd->opt_trace, "considered_execution_plans",
@@ -1955,12 +2061,19 @@ bool Optimize_table_order::choose_table_order()
                            Item::WALK_POSTFIX, NULL);
   }
 
-  if (straight_join)
+  if (straight_join || reuse_order)
     optimize_straight_join(join_tables);
+  else if (use_dp_search(join_tables))
+  {
+    if (dp_search(join_tables))
+      DBUG_RETURN(true);
+    save_join_order();
+  }
   else
   {
     if (greedy_search(join_tables))
       DBUG_RETURN(true);
+    save_join_order();
   }
 
   // Remaining part of this function not needed when processing semi-join nests.
@@ -2013,8 +2126,6 @@ uint Optimize_table_order::determine_search_depth(uint search_depth,
 {
   if (search_depth > 0)
     return search_depth;
-  /* TODO: this value should be determined dynamically, based on statistics: */
-  const uint max_tables_for_exhaustive_opt= 7;
 
   if (table_count <= max_tables_for_exhaustive_opt)
     search_depth= table_count+1; // use exhaustive for small number of tables
@@ -2029,6 +2140,156 @@ uint Optimize_table_order::determine_search_depth(uint search_depth,
 }
 
 
+void invalidate_saved_join_orders()
+{
+  saved_join_order_version++;
+}
+
+
+/**
+  Checks whether the join order of the query block may be saved, and saves
+  it in the memory of the statement, for reuse_join_order().
+
+  The order is saved only for prepared statements and stored programs, which
+  are optimized again for every execution. It is not saved if the row
+  estimates of a table came from the range optimizer, or if the filtering
+  effect of a predicate with a parameter came from a histogram, since these
+  depend on the values of the constants, and thus on the values of the
+  parameters of the statement: another execution would possibly choose
+  another order. The estimates from index statistics and the number of
+  rows in the tables do not depend on the parameters.
+*/
+
+void Optimize_table_order::save_join_order()
+{
+  SELECT_LEX *const select_lex= join->select_lex;
+  Saved_join_order *saved= select_lex->saved_join_order;
+  const uint table_count= join->tables - join->const_tables;
+
+  // Only the order of the complete plan of the query block is saved
+  if (emb_sjm_nest != NULL || !join->allow_outer_refs)
+    return;
+
+  if (saved != NULL)
+    saved->table_count= 0;                      // Invalidate the old order
+
+  if (!select_lex->sj_nests.is_empty() || table_count < 2 ||
+      thd->stmt_arena->is_conventional() ||
+      thd->histogram_param_selectivities != histogram_param_selectivities)
+    return;
+
+  for (uint idx= join->const_tables; idx < join->tables; idx++)
+  {
+    if (!join->best_positions[idx].table->table()->quick_keys.is_clear_all())
+      return;
+  }
+
+  if (saved == NULL)
+  {
+    // Allocate for all tables, as the number of constant tables may vary
+    Prepared_stmt_arena_holder ps_arena_holder(thd);
+    saved= new (thd->mem_root) Saved_join_order;
+    if (saved == NULL)
+      return;                                   /* purecov: inspected */
+    saved->tablenos=
+      static_cast<uint*>(thd->alloc(join->tables * sizeof(uint)));
+    saved->table_rows=
+      static_cast<ha_rows*>(thd->alloc(join->tables * sizeof(ha_rows)));
+    if (saved->tablenos == NULL || saved->table_rows == NULL)
+      return;                                   /* purecov: inspected */
+    saved->table_count= 0;
+    select_lex->saved_join_order= saved;
+  }
+
+  for (uint i= 0; i < table_count; i++)
+  {
+    const JOIN_TAB *const tab=
+      join->best_positions[join->const_tables + i].table;
+    saved->tablenos[i]= tab->table_ref->tableno();
+    saved->table_rows[i]= tab->table()->file->stats.records;
+  }
+  saved->const_tables= join->const_table_map;
+  saved->optimizer_switch= thd->variables.optimizer_switch;
+  saved->optimizer_search_depth= thd->variables.optimizer_search_depth;
+  saved->optimizer_prune_level= thd->variables.optimizer_prune_level;
+  saved->cost_constants= thd->cost_model()->get_cost_constants();
+  saved->version= saved_join_order_version;
+  saved->table_count= table_count;
+}
+
+
+/**
+  Reuses the join order saved by an earlier execution of the statement,
+  see save_join_order(), by putting the tables of join->best_ref in this
+  order.
+
+  The order is reused if the same tables are constant, the variables
+  optimizer_switch, optimizer_search_depth and optimizer_prune_level and
+  the cost constants are the same, and the statistics of the tables have
+  not changed: no ANALYZE TABLE has been run, and the number of rows in
+  each table is within a factor of two of what it was. The cost constants
+  are compared by address: as FLUSH OPTIMIZER_COSTS invalidates the saved
+  orders, a new set of constants cannot take the address of the old one
+  while the order is valid. Changes to the definitions of the
+  tables are not checked for, since they make the statement be prepared
+  again, with new query blocks. The order is not reused when the optimizer
+  is traced, so that the trace shows the search.
+
+  @returns true if the order has been reused, false if it should be searched
+*/
+
+bool Optimize_table_order::reuse_join_order()
+{
+  const Saved_join_order *const saved= join->select_lex->saved_join_order;
+
+  if (saved == NULL || saved->table_count == 0 ||
+      thd->opt_trace.is_started() ||
+      emb_sjm_nest != NULL || !join->allow_outer_refs ||
+      !join->select_lex->sj_nests.is_empty() ||
+      saved->const_tables != join->const_table_map ||
+      saved->table_count != join->tables - join->const_tables ||
+      saved->optimizer_switch != thd->variables.optimizer_switch ||
+      saved->optimizer_search_depth !=
+        thd->variables.optimizer_search_depth ||
+      saved->optimizer_prune_level != thd->variables.optimizer_prune_level ||
+      saved->cost_constants != thd->cost_model()->get_cost_constants() ||
+      saved->version != saved_join_order_version)
+    return false;
+
+  JOIN_TAB **const tabs= join->best_ref + join->const_tables;
+  bool valid= true;
+  for (uint i= 0; valid && i < saved->table_count; i++)
+  {
+    // Find the table among the ones not yet in order, and move it into place
+    uint j= i;
+    while (j < saved->table_count &&
+           tabs[j]->table_ref->tableno() != saved->tablenos[i])
+      j++;
+    if (j == saved->table_count)
+    {
+      valid= false;                             /* purecov: deadcode */
+      break;
+    }
+    std::swap(tabs[i], tabs[j]);
+
+    const ha_rows rows= tabs[i]->table()->file->stats.records;
+    valid= rows <= 2 * saved->table_rows[i] + 1 &&
+           saved->table_rows[i] <= 2 * rows + 1;
+  }
+
+  if (!valid)
+  {
+    // Restore the initial order of the tables, which the search depends on
+    merge_sort(join->best_ref + join->const_tables,
+               join->best_ref + join->tables,
+               Join_tab_compare_default());
+    return false;
+  }
+  thd->status_var.select_plan_reuse_count++;
+  return true;
+}
+
+
 /**
   Select the best ways to access the tables in a query without reordering them.
 
@@ -2360,6 +2621,222 @@ bool Optimize_table_order::greedy_search(table_map remaining_tables)
 }
 
 
+/**
+  Find the tables that each table is joined to, and the tables that each
+  table depends on.
+
+  Two tables are joined if a key of one of them may be looked up with
+  values from the other, or if a conjunct of the WHERE condition refers to
+  both of them.
+
+  @param join              the join
+  @param tables            the tables to be ordered
+  @param[out] tabs         JOIN_TAB of each table, by table number
+  @param[out] neighbours   tables in 'tables' joined to each table
+  @param[out] dependencies tables in 'tables' that each table depends on
+*/
+
+static void find_join_graph(JOIN *join, table_map tables, JOIN_TAB **tabs,
+                            table_map *neighbours, table_map *dependencies)
+{
+  auto add_edges= [tables, neighbours](table_map map)
+  {
+    map&= tables;
+    if (my_count_bits(map) < 2)
+      return;
+    for (table_map m= map; m != 0; m&= m - 1)
+    {
+      const table_map bit= m & (~m + 1);
+      neighbours[my_count_bits(bit - 1)]|= map & ~bit;
+    }
+  };
+
+  for (uint i= join->const_tables; i < join->tables; i++)
+  {
+    JOIN_TAB *const tab= join->best_ref[i];
+    const uint tableno= tab->table_ref->tableno();
+    tabs[tableno]= tab;
+    neighbours[tableno]= 0;
+    dependencies[tableno]= tab->dependent & tables;
+  }
+
+  for (uint i= join->const_tables; i < join->tables; i++)
+  {
+    const JOIN_TAB *const tab= join->best_ref[i];
+    for (const Key_use *keyuse= tab->keyuse();
+         keyuse != NULL && keyuse->table_ref == tab->table_ref;
+         keyuse++)
+      add_edges(keyuse->used_tables | tab->table_ref->map());
+  }
+
+  Item *const cond= join->where_cond;
+  if (cond == NULL)
+    return;
+  if (cond->type() == Item::COND_ITEM &&
+      down_cast<Item_cond *>(cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator<Item> it(*down_cast<Item_cond *>(cond)->argument_list());
+    Item *item;
+    while ((item= it++))
+      add_edges(item->used_tables());
+  }
+  else
+    add_edges(cond->used_tables());
+}
+
+
+/**
+  Check whether the join order is to be found by dp_search() rather than
+  by greedy_search().
+
+  This is asked for with optimizer_prune_level=2. Joins with few tables
+  keep the exhaustive search of greedy_search(). Semi-joins and outer
+  joins are also left to greedy_search(), since it keeps track of the
+  semi-join strategies and of the nested join state for each prefix.
+
+  @param join_tables  the tables to be ordered
+
+  @return true if dp_search() is to be used
+*/
+
+bool Optimize_table_order::use_dp_search(table_map join_tables) const
+{
+  return prune_level == 2 &&
+         emb_sjm_nest == NULL &&
+         join->select_lex->sj_nests.is_empty() &&
+         join->select_lex->outer_join == 0 &&
+         my_count_bits(join_tables) > max_tables_for_exhaustive_opt;
+}
+
+
+/**
+  Find a good join order by dynamic programming over the sets of tables.
+
+  The tables are placed in blocks of at most search_depth tables by
+  join_order_dp_search(). For each block it finds the cheapest order of
+  every set of tables that extends the plan so far, using
+  best_access_path() to extend a plan with a table like greedy_search()
+  does. A block is smaller if the next set size would need more than
+  max_dp_partial_plans partial plans. Plans are only extended with tables
+  that are joined to them, as found by find_join_graph(), unless there are
+  none.
+
+  This takes time proportional to the number of connected sets of tables
+  rather than to the number of orders, so it scales to star and snowflake
+  joins of many tables where the depth-first search of greedy_search()
+  would have to be limited to a small depth.
+
+  The result is stored like for greedy_search(): in 'join->best_positions',
+  with its cost in 'join->best_read'.
+
+  @param join_tables  the tables to be ordered
+
+  @return false if successful, true if error
+*/
+
+bool Optimize_table_order::dp_search(table_map join_tables)
+{
+  DBUG_ENTER("Optimize_table_order::dp_search");
+
+  const uint idx= join->const_tables;
+  const uint table_count= my_count_bits(join_tables);
+  const Cost_model_server *const cost_model= join->cost_model();
+  Opt_trace_context * const trace= &thd->opt_trace;
+
+  JOIN_TAB *tabs[MAX_TABLES];
+  table_map neighbours[MAX_TABLES];
+  table_map dependencies[MAX_TABLES];
+  find_join_graph(join, join_tables, tabs, neighbours, dependencies);
+
+  /*
+    Extend the partial plan in join->positions[] with a table. Like in
+    greedy_search(), 'join->best_ref' lists the tables of the partial plan
+    first, in order, since best_access_path() relies on it.
+  */
+  auto extend= [&](uint position_no, table_map prefix_tables, uint tableno,
+                   double *cost)
+  {
+    DBUG_EXECUTE_IF("bug13820776_2", thd->killed= THD::KILL_QUERY;);
+    if (thd->killed)  // Abort
+      return true;
+
+    const uint pos_idx= idx + position_no;
+    POSITION *const position= join->positions + pos_idx;
+
+    JOIN_TAB **ref= join->best_ref + idx;
+    for (uint i= idx; i < pos_idx; i++)
+      *ref++= join->positions[i].table;
+    for (table_map m= join_tables & ~prefix_tables; m != 0; m&= m - 1)
+      *ref++= tabs[my_count_bits((m & (~m + 1)) - 1)];
+
+    JOIN_TAB *const s= tabs[tableno];
+    Opt_trace_object trace_one_table(trace);
+    if (unlikely(trace->is_started()))
+    {
+      trace_plan_prefix(join, pos_idx, excluded_tables);
+      trace_one_table.add_utf8_table(s->table_ref);
+    }
+
+    best_access_path(s, join_tables & ~prefix_tables, pos_idx, false,
+                     pos_idx ? (position - 1)->prefix_rowcount : 1.0,
+                     position);
+    position->set_prefix_join_cost(pos_idx, cost_model);
+    position->no_semijoin();
+
+    trace_one_table.
+      add("condition_filtering_pct", position->filter_effect * 100).
+      add("rows_for_plan", position->prefix_rowcount).
+      add("cost_for_plan", position->prefix_cost);
+
+    *cost= position->prefix_cost;
+    return false;
+  };
+
+  MEM_ROOT mem_root;
+  init_sql_alloc(key_memory_join_order_search, &mem_root, 8192, 0);
+  ulonglong partial_plans= 0;
+  const bool error=
+    join_order_dp_search(&mem_root, join_tables, neighbours, dependencies,
+                         search_depth, max_dp_partial_plans, extend,
+                         join->positions + idx, &partial_plans);
+  free_root(&mem_root, MYF(0));
+  if (error)
+    DBUG_RETURN(true);
+
+  for (uint i= 0; i < table_count; i++)
+    join->best_ref[idx + i]= join->positions[idx + i].table;
+  memcpy(join->best_positions, join->positions,
+         sizeof(POSITION) * (idx + table_count));
+
+  // Account for sorting like consider_plan() does.
+  const POSITION *const last_pos= join->best_positions + idx + table_count - 1;
+  double cost= last_pos->prefix_cost;
+  double sort_cost= join->sort_cost;
+  if (join->sort_by_table &&
+      join->sort_by_table != join->best_positions[idx].table->table())
+  {
+    cost+= last_pos->prefix_rowcount;
+    sort_cost= last_pos->prefix_rowcount;
+  }
+
+  /*
+    If many plans have identical cost, which one will be used
+    depends on how compiler optimizes floating-point calculations.
+    this fix adds repeatability to the optimizer.
+    (Similar code in best_extension_by_li...)
+  */
+  join->best_read= cost - 0.001;
+  join->best_rowcount= (ha_rows) last_pos->prefix_rowcount;
+  join->sort_cost= sort_cost;
+
+  DBUG_EXECUTE("opt", print_plan(join, idx + table_count,
+                                 last_pos->prefix_rowcount, cost, cost,
+                                 "optimal"););
+  DBUG_PRINT("info", ("partial plans considered: %llu", partial_plans));
+  DBUG_RETURN(false);
+}
+
+
 /**
   Calculate a cost of given partial join order
  
@@ -2738,7 +3215,7 @@ bool Optimize_table_order::best_extension_by_limited_search(
         Prune some less promising partial plans. This heuristic may miss
         the optimal QEPs, thus it results in a non-exhaustive search.
       */
-      if (prune_level == 1)
+      if (prune_level >= 1)
       {
         if (best_rowcount > position->prefix_rowcount ||
             best_cost > position->prefix_cost ||
@@ -2780,7 +3257,7 @@ bool Optimize_table_order::best_extension_by_limited_search(
             2) and, There are tables joined by (EQ_)REF key.
             3) and, There is a 1::1 relation between those tables
         */
-        if (prune_level == 1 &&                             // 1)
+        if (prune_level >= 1 &&                             // 1)
             position->key != NULL &&                        // 2)
             position->rows_fetched <= 1.0)                  // 3)
         {
@@ -23,9 +23,11 @@
 
 #include <sys/types.h>
 
+#include "my_base.h"
 #include "my_inttypes.h"
 #include "my_table_map.h"
 
+class Cost_model_constants;
 class JOIN;
 class JOIN_TAB;
 class Key_use;
@@ -36,6 +38,41 @@ struct TABLE_LIST;
 typedef ulonglong nested_join_map;
 typedef struct st_position POSITION;
 
+/**
+  The join order chosen for a query block during an execution of a prepared
+  statement or stored program. It is kept in the memory of the statement,
+  so that later executions may use it rather than search for a join order
+  again, see Optimize_table_order::reuse_join_order().
+*/
+struct Saved_join_order
+{
+  /// The tables which were constant
+  table_map const_tables;
+  /// Number of the other tables
+  uint table_count;
+  /// Numbers of the other tables, in join order
+  uint *tablenos;
+  /// Number of rows in each of the other tables, in join order
+  ha_rows *table_rows;
+  /// Value of optimizer_switch
+  ulonglong optimizer_switch;
+  /// Value of optimizer_search_depth
+  ulong optimizer_search_depth;
+  /// Value of optimizer_prune_level
+  ulong optimizer_prune_level;
+  /// The cost constants used, cf. Cost_model_server::get_cost_constants()
+  const Cost_model_constants *cost_constants;
+  /// Value of the statistics version, cf. invalidate_saved_join_orders()
+  ulonglong version;
+};
+
+/**
+  Makes the join orders saved so far invalid, so that every query block
+  searches for a join order again when it is next optimized. Called when
+  the statistics of a table or the cost constants change.
+*/
+void invalidate_saved_join_orders();
+
 /**
   This class determines the optimal join order for tables within
   a basic query block, ie a query specification clause, possibly extended
@@ -49,7 +86,8 @@ typedef struct st_position POSITION;
   optimal plan based on the inputs and the environment, such as prune level
   and greedy optimizer search depth. For more information, see the
   function headers for the private functions greedy_search(),
-  best_extension_by_limited_search() and eq_ref_extension_by_limited_search().
+  best_extension_by_limited_search(), eq_ref_extension_by_limited_search()
+  and dp_search().
 */
 
 class Optimize_table_order
@@ -108,6 +146,12 @@ private:
   /// True if we found a complete plan using only allowed semijoin strategies.
   bool found_plan_with_allowed_sj;
 
+  /**
+    Value of THD::histogram_param_selectivities before the search, cf.
+    save_join_order().
+  */
+  const ulonglong histogram_param_selectivities;
+
   inline Key_use* find_best_ref(const JOIN_TAB  *tab,
                                 const table_map remaining_tables,
                                 const uint idx,
@@ -139,7 +183,11 @@ private:
   void backout_nj_state(const table_map remaining_tables,
                         const JOIN_TAB *tab);
   void optimize_straight_join(table_map join_tables);
+  bool reuse_join_order();
+  void save_join_order();
   bool greedy_search(table_map remaining_tables);
+  bool use_dp_search(table_map join_tables) const;
+  bool dp_search(table_map join_tables);
   bool best_extension_by_limited_search(table_map remaining_tables,
                                         uint idx,
                                         uint current_search_depth);
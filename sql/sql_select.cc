@@ -61,6 +61,7 @@
 #include "sql/query_options.h"
 #include "sql/query_result.h"
 #include "sql/records.h"         // init_read_record, end_read_record
+#include "sql/result_cache.h"    // Result_cache_query
 #include "sql/sql_base.h"
 #include "sql/sql_do.h"
 #include "sql/sql_executor.h"
@@ -685,6 +686,30 @@ err:
 }
 
 
+/**
+  Execute a SELECT statement, sending the result from the result cache
+  if it is there, and storing it in the result cache otherwise.
+*/
+
+bool Sql_cmd_select::execute_inner(THD *thd)
+{
+  Result_cache_query cache_query(thd);
+  if (!cache_query.prepare(lex, result))
+    return Sql_cmd_dml::execute_inner(thd);
+
+  if (cache_query.send_cached_result(lex, result))
+    return thd->is_error();
+
+  Query_result_send *const send_result= down_cast<Query_result_send*>(result);
+  send_result->set_cache_query(&cache_query);
+  const bool error= Sql_cmd_dml::execute_inner(thd);
+  send_result->set_cache_query(NULL);
+  if (!error)
+    cache_query.store();
+  return error;
+}
+
+
 /**
   Execute a DML statement.
   This is the default implementation for a DML statement and uses a
@@ -1450,6 +1475,8 @@ void JOIN::reset()
         continue;
       tmp_table->file->extra(HA_EXTRA_RESET_STATE);
       tmp_table->file->ha_delete_all_rows();
+      if (qep_tab[tmp].group_cache != NULL)
+        qep_tab[tmp].group_cache->reset();
       free_io_cache(tmp_table);
       filesort_free_buffers(tmp_table,0);
     }
@@ -3016,6 +3043,8 @@ void QEP_TAB::cleanup()
   // Delete parts specific of QEP_TAB:
   delete filesort;
   filesort= NULL;
+  delete sort_limit_filter;
+  sort_limit_filter= NULL;
   end_read_record(&read_record);
   if (quick_optim() != quick())
     delete quick_optim();
@@ -78,6 +78,8 @@ protected:
   virtual bool precheck(THD *thd);
 
   virtual bool prepare_inner(THD *thd);
+
+  virtual bool execute_inner(THD *thd);
 };
 
 /**
@@ -2680,6 +2680,93 @@ void free_tmp_table(THD *thd, TABLE *entry)
 }
 
 
+/**
+  Copies all rows of an in-memory tmp table to the on-disk table which
+  replaces it.
+
+  If the on-disk table is an InnoDB table clustered on a key, the rows are
+  copied in runs sorted on that key: each run is read into a buffer of
+  @@sort_buffer_size bytes, sorted, then written. The in-memory table
+  returns rows in hash order; inserting them in key order instead makes
+  InnoDB append to the same few leaf pages rather than split pages all
+  over the index. As InnoDB returns rows in key order anyway, the order in
+  which rows are inserted is not visible.
+
+  @param thd          Thread handler
+  @param from         In-memory table, with an initialized table scan
+  @param to           On-disk table
+  @param may_reorder  False if rows must be inserted in the order of the
+                      scan, e.g. because other TABLE clones are positioned
+                      on them
+
+  @returns 0 if success, error of handler::ha_write_row() otherwise
+*/
+
+static int copy_rows_to_ondisk(THD *thd, TABLE *from, TABLE *to,
+                               bool may_reorder)
+{
+  int write_err= 0;
+  const size_t reclength= to->s->reclength;
+  size_t run_capacity= 0;
+  uchar *run= nullptr;
+
+  if (may_reorder && to->s->db_type() == innodb_hton &&
+      to->s->primary_key != MAX_KEY)
+  {
+    run_capacity= std::max<size_t>(thd->variables.sortbuff_size /
+                                   (reclength + sizeof(uchar *)), 2);
+    // If memory is short, rows are copied one by one as below.
+    run= static_cast<uchar *>(my_malloc(key_memory_create_ondisk_from_heap,
+                                        run_capacity *
+                                        (reclength + sizeof(uchar *)),
+                                        MYF(0)));
+  }
+
+  if (run == nullptr)
+  {
+    while (!from->file->ha_rnd_next(to->record[1]))
+    {
+      write_err= to->file->ha_write_row(to->record[1]);
+      DBUG_EXECUTE_IF("raise_error", write_err= HA_ERR_FOUND_DUPP_KEY ;);
+      if (write_err)
+        return write_err;
+    }
+    return 0;
+  }
+
+  uchar **const rows= reinterpret_cast<uchar **>(run);
+  uchar *const records= run + run_capacity * sizeof(uchar *);
+  KEY *keys[]= { to->key_info + to->s->primary_key, nullptr };
+  bool eof= false;
+
+  while (!eof && !write_err)
+  {
+    size_t n= 0;
+    for (; n < run_capacity; n++)
+    {
+      rows[n]= records + n * reclength;
+      if (from->file->ha_rnd_next(rows[n]))
+      {
+        eof= true;
+        break;
+      }
+    }
+
+    std::sort(rows, rows + n, [&keys](uchar *a, uchar *b)
+              { return key_rec_cmp(keys, a, b) < 0; });
+
+    for (size_t i= 0; i < n && !write_err; i++)
+    {
+      write_err= to->file->ha_write_row(rows[i]);
+      DBUG_EXECUTE_IF("raise_error", write_err= HA_ERR_FOUND_DUPP_KEY ;);
+    }
+  }
+
+  my_free(run);
+  return write_err;
+}
+
+
 /**
   If a MEMORY table gets full, create a disk-based table and copy all rows
   to this.
@@ -2918,15 +3005,14 @@ bool create_ondisk_from_heap(THD *thd, TABLE *wtable,
           This is the only code that uses record[1] to read/write but this
           is safe as this is a temporary on-disk table without timestamp/
           autoincrement or partitioning.
+          Clones of a CTE may have to re-position their cursors on the
+          on-disk table by counting rows, so its rows must keep their order.
         */
-        while (!table->file->ha_rnd_next(new_table.record[1]))
-        {
-          write_err= new_table.file->ha_write_row(new_table.record[1]);
-          DBUG_EXECUTE_IF("raise_error", write_err= HA_ERR_FOUND_DUPP_KEY ;);
-          if (write_err)
-            goto err_after_open;
-          
-        }
+        if ((write_err= copy_rows_to_ondisk(thd, table, &new_table,
+                                            wtable_list == nullptr ||
+                                            wtable_list->
+                                            common_table_expr() == nullptr)))
+          goto err_after_open;
         /* copy row that filled HEAP table */
         if ((write_err=new_table.file->ha_write_row(table->record[0])))
         {
@@ -1588,13 +1588,20 @@ static void destroy_materialized(THD *thd, TABLE_LIST *list)
       // Find a materialized view inside another view.
       destroy_materialized(thd, tl->merge_underlying_list);
     }
+    Common_table_expr *const cte= tl->common_table_expr();
+    /*
+      References to a same view share their tmp table only for one execution,
+      @see share_view_tmp_table().
+    */
+    if (tl->is_view() && cte != nullptr)
+      tl->set_common_table_expr(nullptr);
     if (!tl->table)
       continue;                                 // Not materialized
     if (tl->is_view_or_derived())
     {
       tl->reset_name_temporary();
-      if (tl->common_table_expr())
-        tl->common_table_expr()->tmp_tables.clear();
+      if (cte)
+        cte->tmp_tables.clear();
     }
     else if (!tl->is_recursive_reference() && !tl->schema_table)
       continue;
@@ -89,6 +89,8 @@
 #include "sql/derror.h"                  // read_texts
 #include "sql/discrete_interval.h"
 #include "sql/events.h"                  // Events
+#include "sql/filesort_utils.h"          // sort_worker_threads
+#include "sql/histograms/auto_update.h"  // histogram_auto_update_threshold
 #include "sql/hostname.h"                // host_cache_resize
 #include "sql/item_timefunc.h"           // ISO_FORMAT
 #include "sql/log.h"
@@ -100,6 +102,7 @@
 #include "sql/protocol_classic.h"
 #include "sql/psi_memory_key.h"
 #include "sql/query_options.h"
+#include "sql/result_cache.h"            // result_cache_size
 #include "sql/rpl_group_replication.h"   // is_group_replication_running
 #include "sql/rpl_info_factory.h"        // Rpl_info_factory
 #include "sql/rpl_info_handler.h"        // INFO_REPOSITORY_TABLE
@@ -2966,9 +2969,11 @@ static Sys_var_ulong Sys_optimizer_prune_level(
        "Controls the heuristic(s) applied during query optimization to prune "
        "less-promising partial plans from the optimizer search space. "
        "Meaning: 0 - do not apply any heuristic, thus perform exhaustive "
-       "search; 1 - prune plans based on number of retrieved rows",
+       "search; 1 - prune plans based on number of retrieved rows; 2 - "
+       "also search the join orders of joins with many tables by dynamic "
+       "programming over the sets of tables joined to each other",
        HINT_UPDATEABLE SESSION_VAR(optimizer_prune_level), CMD_LINE(REQUIRED_ARG),
-       VALID_RANGE(0, 1), DEFAULT(1), BLOCK_SIZE(1));
+       VALID_RANGE(0, 2), DEFAULT(1), BLOCK_SIZE(1));
 
 static Sys_var_ulong Sys_optimizer_search_depth(
        "optimizer_search_depth",
@@ -3016,6 +3021,22 @@ static bool limit_parser_max_mem_size(sys_var*, THD *thd, set_var *var)
 
 constexpr size_t max_mem_sz= std::numeric_limits<size_t>::max();
 
+static Sys_var_ulong Sys_histogram_auto_update_threshold(
+      "histogram_auto_update_threshold",
+      "Percentage of the rows of a table that must have been inserted, "
+      "updated or deleted after its histograms were last updated before "
+      "the histograms are updated in the background. 0 disables the "
+      "automatic updates",
+      GLOBAL_VAR(histogram_auto_update_threshold),
+      CMD_LINE(REQUIRED_ARG),
+      VALID_RANGE(0, 100),
+      DEFAULT(0),
+      BLOCK_SIZE(1),
+      NO_MUTEX_GUARD, NOT_IN_BINLOG,
+      ON_CHECK(0),
+      ON_UPDATE(NULL));
+
+
 static Sys_var_ulonglong Sys_histogram_generation_max_mem_size(
       "histogram_generation_max_mem_size",
       "Maximum amount of memory available for generating histograms",
@@ -4306,6 +4327,21 @@ static Sys_var_ulong Sys_sort_buffer(
        VALID_RANGE(MIN_SORT_MEMORY, ULONG_MAX), DEFAULT(DEFAULT_SORT_MEMORY),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_sort_threads(
+       "sort_threads",
+       "Maximum number of threads that sort a buffer of rows in filesort. "
+       "Each thread sorts at least 16384 rows",
+       HINT_UPDATEABLE SESSION_VAR(sort_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_sort_worker_threads(
+       "sort_worker_threads",
+       "Maximum number of threads in the server that help sessions sort "
+       "filesort buffers, see sort_threads. The threads are started when "
+       "first needed. 0 means that every session sorts its buffers alone",
+       READ_ONLY GLOBAL_VAR(sort_worker_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024), DEFAULT(16), BLOCK_SIZE(1));
+
 /**
   Check sql modes strict_mode, 'NO_ZERO_DATE', 'NO_ZERO_IN_DATE' and
   'ERROR_FOR_DIVISION_BY_ZERO' are used together. If only subset of it
@@ -5502,6 +5538,27 @@ static Sys_var_have Sys_have_query_cache(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(nullptr),
        DEPRECATED(""));
 
+static bool fix_result_cache_size(sys_var *, THD *, enum_var_type)
+{
+  result_cache_resize();
+  return false;
+}
+
+static Sys_var_ulonglong Sys_result_cache_size(
+       "result_cache_size",
+       "The memory allocated to cache the result sets of SELECT statements "
+       "executed with result_cache enabled. 0 disables the result cache",
+       GLOBAL_VAR(result_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, ULLONG_MAX), DEFAULT(0), BLOCK_SIZE(1024),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_result_cache_size));
+
+static Sys_var_bool Sys_result_cache(
+       "result_cache",
+       "Use the result cache for SELECT statements",
+       HINT_UPDATEABLE SESSION_VAR(result_cache), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 static Sys_var_have Sys_have_rtree_keys(
        "have_rtree_keys", "have_rtree_keys",
        READ_ONLY NON_PERSIST GLOBAL_VAR(have_rtree_keys), NO_CMD_LINE);
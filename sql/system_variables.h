@@ -163,6 +163,7 @@ struct System_variables
   ulonglong long_query_time;
   bool end_markers_in_json;
   bool windowing_use_high_precision;
+  bool result_cache;
   /* A bitmap for switching optimizations on/off */
   ulonglong optimizer_switch;
   ulonglong optimizer_trace; ///< bitmap to tune optimizer tracing
@@ -204,6 +205,7 @@ struct System_variables
   ulong read_rnd_buff_size;
   ulong div_precincrement;
   ulong sortbuff_size;
+  ulong sort_threads;
   ulong max_sp_recursion_depth;
   ulong default_week_format;
   ulong max_seeks_for_key;
@@ -359,6 +361,7 @@ struct System_status_var
   ulonglong select_range_count;
   ulonglong select_range_check_count;
   ulonglong select_scan_count;
+  ulonglong select_plan_reuse_count;
   ulonglong long_query_count;
   ulonglong filesort_merge_passes;
   ulonglong filesort_range_count;
@@ -380,6 +383,9 @@ struct System_status_var
   ulonglong max_execution_time_set;
   ulonglong max_execution_time_set_failed;
 
+  ulonglong result_cache_hits;
+  ulonglong result_cache_inserts;
+
   /* Number of statements sent from the client. */
   ulonglong questions;
 
@@ -1261,6 +1261,14 @@ private:
 
 public:
 
+  /**
+    Index of the Table_cache instance holding this TABLE, set when the
+    TABLE is added to the cache. The TABLE must be returned to the same
+    instance, which is not necessarily the one the connection would pick
+    when it is released.
+  */
+  uint cache_instance;
+
   THD	*in_use;                        /* Which thread uses this */
   Field **field;			/* Pointer to fields */
   /// Count of hidden fields, if internal temporary table; 0 otherwise.
@@ -3875,9 +3883,10 @@ public:
   bool recursive;
   /**
     List of all TABLE_LISTSs reading/writing to the tmp table created to
-    materialize this CTE. Due to shared materialization, only the first one
-    has a TABLE generated by create_tmp_table(); other ones have a TABLE
-    generated by open_table_from_share().
+    materialize this CTE, or a view referenced more than once. Due to shared
+    materialization, only the first one has a TABLE generated by
+    create_tmp_table(); other ones have a TABLE generated by
+    open_table_from_share().
   */
   Mem_root_array<TABLE_LIST *> tmp_tables;
 };
@@ -3888,9 +3897,9 @@ public:
    materialized. If a recursive CTE, this includes recursive references.
    Upon construction it is passed a non-recursive materialized reference
    to the derived table (TABLE_LIST*).
-   For a CTE it may return more than one reference; for a derived table or a
-   view, there is only one (as references to a same view are treated as
-   independent objects).
+   For a CTE it may return more than one reference; for a derived table,
+   there is only one. For a view, there is more than one if references to it
+   share their tmp table (@see share_view_tmp_table()).
    References are returned as TABLE*.
 */
 class Derived_refs_iterator
@@ -16,18 +16,24 @@
 #ifndef TABLE_CACHE_INCLUDED
 #define TABLE_CACHE_INCLUDED
 
+#include "my_config.h"
+
 #include <stddef.h>
+#include <string.h>
 #include <sys/types.h>
 #include <map>
 #include <memory>
-#include <string>
 #include <unordered_map>
 #include <utility>
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
 
 #include "lex_string.h"
 #include "my_base.h"
 #include "my_dbug.h"
 #include "my_inttypes.h"
+#include "my_murmur3.h"
 #include "my_psi_config.h"
 #include "mysql/components/services/mysql_mutex_bits.h"
 #include "mysql/components/services/psi_mutex_bits.h"
@@ -53,7 +59,8 @@ extern ulong table_cache_size_per_instance, table_cache_instances;
   go to a central table definition cache to get a TABLE object and
   therefore don't need to lock LOCK_open mutex.
   Instead they only need to go to one Table_cache instance (the
-  specific instance is determined by thread id) and only lock the
+  specific instance is determined by the CPU the thread runs on, or
+  by thread id where that is unknown) and only lock the
   mutex protecting this cache.
   DDL statements that need to remove all TABLE objects from all caches
   need to lock mutexes for all Table_cache instances, but they are rare.
@@ -95,8 +102,26 @@ private:
     which the list of free TABLE objects in this table cache AND the list
     of used TABLE objects in this table cache is stored.
     We use Table_cache_element::share::table_cache_key as key for this hash.
+    The key points to the memory of the share, which outlives the element,
+    so lookups don't need to copy the key while the lock is held.
   */
-  std::unordered_map<std::string, std::unique_ptr<Table_cache_element>> m_cache;
+  struct Key_hash
+  {
+    size_t operator()(const LEX_CSTRING &key) const
+    {
+      return murmur3_32(reinterpret_cast<const uchar*>(key.str), key.length,
+                        0);
+    }
+  };
+  struct Key_equal
+  {
+    bool operator()(const LEX_CSTRING &a, const LEX_CSTRING &b) const
+    {
+      return a.length == b.length && memcmp(a.str, b.str, a.length) == 0;
+    }
+  };
+  std::unordered_map<LEX_CSTRING, std::unique_ptr<Table_cache_element>,
+                     Key_hash, Key_equal> m_cache;
 
   /**
     List that contains all TABLE instances for tables in this particular
@@ -181,12 +206,32 @@ public:
   bool init();
   void destroy();
 
-  /** Get instance of table cache to be used by particular connection. */
+  /**
+    Get instance of table cache to be used by particular connection.
+
+    Where the CPU the connection runs on is known, the instance is picked
+    by CPU rather than by connection, so connections running at the same
+    time on different CPUs use different instances however many of them
+    there are. TABLE objects taken from the cache must be given back to
+    the instance they belong to, see get_cache(const TABLE*).
+  */
   Table_cache* get_cache(THD *thd)
   {
+#ifdef HAVE_SCHED_GETCPU
+    const int cpu= sched_getcpu();
+    if (cpu >= 0)
+      return &m_table_cache[static_cast<uint>(cpu) % table_cache_instances];
+#endif
     return &m_table_cache[thd->thread_id() % table_cache_instances];
   }
 
+  /** Get instance of table cache which holds the TABLE object. */
+  Table_cache* get_cache(const TABLE *table)
+  {
+    DBUG_ASSERT(table->cache_instance < table_cache_instances);
+    return &m_table_cache[table->cache_instance];
+  }
+
   /** Get index for the table cache in container. */
   uint cache_index(Table_cache *cache) const
   {
@@ -396,8 +441,8 @@ bool Table_cache::add_used_table(THD *thd, TABLE *table)
       Allocate new Table_cache_element object and add it to the cache
       and array in TABLE_SHARE.
     */
-    std::string key(
-      table->s->table_cache_key.str, table->s->table_cache_key.length);
+    const LEX_CSTRING key= { table->s->table_cache_key.str,
+                             table->s->table_cache_key.length };
     DBUG_ASSERT(m_cache.count(key) == 0);
 
     el= new Table_cache_element(table->s);
@@ -407,6 +452,7 @@ bool Table_cache::add_used_table(THD *thd, TABLE *table)
 
   /* Add table to the used tables list */
   el->used_tables.push_front(table);
+  table->cache_instance= table_cache_manager.cache_index(this);
 
   m_table_count++;
 
@@ -448,8 +494,8 @@ void Table_cache::remove_table(TABLE *table)
 
   if (el->used_tables.is_empty() && el->free_tables.is_empty())
   {
-    std::string key(
-      table->s->table_cache_key.str, table->s->table_cache_key.length);
+    const LEX_CSTRING key= { table->s->table_cache_key.str,
+                             table->s->table_cache_key.length };
     m_cache.erase(key);
     /*
       Remove reference to deleted cache element from array
@@ -491,8 +537,7 @@ TABLE* Table_cache::get_table(THD *thd,
 
   *share= NULL;
 
-  std::string key_str(key, key_length);
-  const auto el_it= m_cache.find(key_str);
+  const auto el_it= m_cache.find(LEX_CSTRING{ key, key_length });
   if (el_it == m_cache.end())
     return NULL;
   Table_cache_element *el= el_it->second.get();
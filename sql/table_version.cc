@@ -0,0 +1,115 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "sql/table_version.h"
+
+#include <atomic>
+
+#include "my_murmur3.h"
+#include "prealloced_array.h"
+#include "sql/sql_class.h"
+#include "sql/table.h"
+#include "template_utils.h"
+
+namespace {
+
+/// Number of table version counters
+const uint TABLE_VERSION_SLOTS= 16384;
+
+std::atomic<ulonglong> table_versions[TABLE_VERSION_SLOTS];
+
+/**
+  Incremented when tables may have been written by a transaction whose
+  written tables are not known.
+*/
+std::atomic<ulonglong> table_version_epoch(0);
+
+
+void bump_version(uint slot)
+{
+  table_versions[slot].fetch_add(1, std::memory_order_acq_rel);
+}
+
+} // namespace
+
+
+bool table_version_is_tracked(const TABLE_SHARE *share)
+{
+  return share->tmp_table == NO_TMP_TABLE && share->foreign_keys == 0;
+}
+
+
+uint table_version_slot(const char *key, size_t key_length)
+{
+  return murmur3_32(pointer_cast<const uchar*>(key), key_length, 0) %
+         TABLE_VERSION_SLOTS;
+}
+
+
+ulonglong table_version_of_slot(uint slot)
+{
+  return table_versions[slot].load(std::memory_order_acquire);
+}
+
+
+ulonglong table_versions_epoch()
+{
+  return table_version_epoch.load(std::memory_order_acquire);
+}
+
+
+ulonglong table_version(const TABLE_SHARE *share)
+{
+  /* Both only increase, so that their sum changes when either does. */
+  return table_versions_epoch() +
+         table_version_of_slot(table_version_slot(
+           share->table_cache_key.str, share->table_cache_key.length));
+}
+
+
+void table_version_note_write(THD *thd, const TABLE_SHARE *share)
+{
+  if (share->tmp_table != NO_TMP_TABLE)
+    return;
+  const uint slot= table_version_slot(share->table_cache_key.str,
+                                      share->table_cache_key.length);
+  bump_version(slot);
+  for (uint written : thd->written_table_versions)
+  {
+    if (written == slot)
+      return;
+  }
+  thd->written_table_versions.push_back(slot);
+}
+
+
+void table_version_end_transaction(THD *thd)
+{
+  for (uint slot : thd->written_table_versions)
+    bump_version(slot);
+  thd->written_table_versions.clear();
+}
+
+
+void table_version_bump(const char *key, size_t key_length)
+{
+  bump_version(table_version_slot(key, key_length));
+}
+
+
+void table_version_bump_all()
+{
+  table_version_epoch.fetch_add(1, std::memory_order_acq_rel);
+}
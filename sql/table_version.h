@@ -0,0 +1,96 @@
+#ifndef TABLE_VERSION_INCLUDED
+#define TABLE_VERSION_INCLUDED
+
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file sql/table_version.h
+  Versions of the base tables, for caches of data derived from their
+  contents such as the result cache and the cache of range estimates.
+
+  The version of a table is incremented when it is locked for writing and
+  unlocked, when a transaction that wrote it ends, and when the table is
+  removed from the table definition cache by DDL. Versions are kept in a
+  fixed array of atomic counters indexed by a hash of the table name, so
+  two tables may share a counter; this causes spurious invalidations but
+  never stale data.
+
+  An epoch is incremented when tables may have been written by a
+  transaction whose written tables are not known, such as an XA
+  transaction committed by another session than the one that prepared it.
+
+  Temporary tables are not tracked. Neither are tables with foreign keys,
+  as cascading actions change them without the SQL layer locking them for
+  writing, so that their versions would not change.
+*/
+
+#include <stddef.h>
+
+#include "my_inttypes.h"
+
+class THD;
+struct TABLE_SHARE;
+
+/**
+  @returns whether the version of a table changes whenever it is written
+*/
+bool table_version_is_tracked(const TABLE_SHARE *share);
+
+/**
+  @param key         "db\0table_name\0", as for the table definition cache
+  @param key_length  length of the key
+
+  @returns the version counter of the table with the given key
+*/
+uint table_version_slot(const char *key, size_t key_length);
+
+/// @returns the value of a version counter
+ulonglong table_version_of_slot(uint slot);
+
+/// @returns the epoch, which changes when any table may have been written
+ulonglong table_versions_epoch();
+
+/**
+  Returns the version of a table, which includes the epoch. It changes
+  whenever the table may have been written, if the table is tracked.
+*/
+ulonglong table_version(const TABLE_SHARE *share);
+
+/**
+  Notes that a table has been locked for writing. The version of the table
+  is incremented, and incremented again when the current transaction of
+  thd ends.
+*/
+void table_version_note_write(THD *thd, const TABLE_SHARE *share);
+
+/// Increments the versions of the tables written by the ending transaction
+void table_version_end_transaction(THD *thd);
+
+/**
+  Increments the version of a table.
+
+  @param key         "db\0table_name\0", as for the table definition cache
+  @param key_length  length of the key
+*/
+void table_version_bump(const char *key, size_t key_length);
+
+/**
+  Increments the epoch, for transactions whose written tables are not
+  known.
+*/
+void table_version_bump_all();
+
+#endif /* TABLE_VERSION_INCLUDED */
@@ -56,6 +56,7 @@
 #include "sql/sql_list.h"
 #include "sql/sql_plugin.h"     // plugin_foreach
 #include "sql/system_variables.h"
+#include "sql/table_version.h"  // table_version_end_transaction
 #include "sql/tc_log.h"         // tc_log
 #include "sql/transaction.h"    // trans_begin, trans_rollback
 #include "sql/transaction_info.h"
@@ -420,6 +421,12 @@ bool Sql_cmd_xa_commit::trans_xa_commit(THD *thd)
     // todo xa framework: return an error
     ha_commit_or_rollback_by_xid(thd, m_xid, !res);
     xid_state->unset_binlogged();
+    /*
+      The tables written by the transaction were recorded by the session
+      that prepared it, which is gone.
+    */
+    if (!res)
+      table_version_bump_all();
 
     transaction_cache_delete(transaction);
     gtid_state_commit_or_rollback(thd, need_clear_owned_gtid, !gtid_error);
@@ -520,6 +527,8 @@ bool Sql_cmd_xa_commit::trans_xa_commit(THD *thd)
     DBUG_RETURN(true);
   }
   gtid_state_commit_or_rollback(thd, need_clear_owned_gtid, !gtid_error);
+  /* A prepared transaction is committed without ha_commit_trans(). */
+  table_version_end_transaction(thd);
   cleanup_trans_state(thd);
 
   xid_state->set_state(XID_STATE::XA_NOTR);
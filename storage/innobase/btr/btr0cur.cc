@@ -45,6 +45,8 @@ Created 10/16/1994 Heikki Tuuri
 #include "btr0cur.h"
 
 #include <assert.h>
+#include <memory>
+#include <new>
 
 #include "my_dbug.h"
 #include "my_inttypes.h"
@@ -68,6 +70,7 @@ Created 10/16/1994 Heikki Tuuri
 #include "row0purge.h"
 #include "row0row.h"
 #include "row0upd.h"
+#include "srv0mon.h"
 #include "srv0srv.h"
 #include "srv0start.h"
 #include "trx0rec.h"
@@ -115,6 +118,10 @@ srv_refresh_innodb_monitor_stats().  Referenced by
 srv_printf_innodb_monitor(). */
 ulint	btr_cur_n_sea_old	= 0;
 
+/** Whether btr_cur_search_to_nth_level() may descend the non-leaf levels
+of the tree without latching them (innodb_btree_optimistic_descent). */
+bool	btr_cur_optimistic_descent = false;
+
 #ifdef UNIV_DEBUG
 /* Flag to limit optimistic insert records */
 uint	btr_cur_limit_optimistic_insert_debug = 0;
@@ -638,6 +645,342 @@ btr_cur_need_opposite_intention(
 	return(false);
 }
 
+/** Searches a private copy of a non-leaf page for the node pointer to
+follow, like page_cur_search_with_match() does on a buffer block.
+@param[in]	page	page-aligned copy of a non-leaf index page
+@param[in]	index	index tree
+@param[in]	tuple	data tuple
+@param[in]	mode	PAGE_CUR_L or PAGE_CUR_LE
+@param[in,out]	heap	memory heap for rec_get_offsets()
+@return the last record that is less than (PAGE_CUR_L) or less than or
+equal to (PAGE_CUR_LE) tuple, possibly the infimum */
+static
+const rec_t*
+btr_cur_search_node_ptr_in_copy(
+	const page_t*		page,
+	const dict_index_t*	index,
+	const dtuple_t*		tuple,
+	page_cur_mode_t		mode,
+	mem_heap_t**		heap)
+{
+	ulint		low = 0;
+	ulint		up = page_dir_get_n_slots(page) - 1;
+	ulint		low_matched_fields = 0;
+	ulint		up_matched_fields = 0;
+	const rec_t*	low_rec;
+	const rec_t*	up_rec;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets = offsets_;
+	rec_offs_init(offsets_);
+
+	ut_ad(mode == PAGE_CUR_L || mode == PAGE_CUR_LE);
+	ut_ad(!page_is_leaf(page));
+
+	/* Binary search through the page directory, then linear search
+	in the records owned by the upper directory slot. */
+	while (up - low > 1) {
+		const ulint	mid = (low + up) / 2;
+		const rec_t*	mid_rec = page_dir_slot_get_rec(
+			page_dir_get_nth_slot(page, mid));
+		ulint		cur_matched_fields = std::min(
+			low_matched_fields, up_matched_fields);
+
+		offsets = rec_get_offsets(
+			mid_rec, index, offsets,
+			dtuple_get_n_fields_cmp(tuple), heap);
+
+		const int	cmp = cmp_dtuple_rec_with_match(
+			tuple, mid_rec, index, offsets, &cur_matched_fields);
+
+		if (cmp > 0 || (cmp == 0 && mode == PAGE_CUR_LE)) {
+			low = mid;
+			low_matched_fields = cur_matched_fields;
+		} else {
+			up = mid;
+			up_matched_fields = cur_matched_fields;
+		}
+	}
+
+	low_rec = page_dir_slot_get_rec(page_dir_get_nth_slot(page, low));
+	up_rec = page_dir_slot_get_rec(page_dir_get_nth_slot(page, up));
+
+	while (page_rec_get_next_const(low_rec) != up_rec) {
+		const rec_t*	mid_rec = page_rec_get_next_const(low_rec);
+		ulint		cur_matched_fields = std::min(
+			low_matched_fields, up_matched_fields);
+
+		offsets = rec_get_offsets(
+			mid_rec, index, offsets,
+			dtuple_get_n_fields_cmp(tuple), heap);
+
+		const int	cmp = cmp_dtuple_rec_with_match(
+			tuple, mid_rec, index, offsets, &cur_matched_fields);
+
+		if (cmp > 0 || (cmp == 0 && mode == PAGE_CUR_LE)) {
+			low_rec = mid_rec;
+			low_matched_fields = cur_matched_fields;
+		} else {
+			up_rec = mid_rec;
+			up_matched_fields = cur_matched_fields;
+		}
+	}
+
+	return(low_rec);
+}
+
+/** A page-aligned buffer of the calling thread, for the page copies of
+btr_cur_optimistic_search_leaf(). It is allocated on first use and kept
+until the thread exits, so that a search does not allocate memory. */
+class Btr_cur_page_copy {
+public:
+	/** @return the buffer of UNIV_PAGE_SIZE bytes, or nullptr if it
+	could not be allocated */
+	page_t* get()
+	{
+		if (m_page == nullptr) {
+			m_mem.reset(new (std::nothrow) byte[
+				2 * UNIV_PAGE_SIZE]);
+
+			if (m_mem != nullptr) {
+				m_page = static_cast<page_t*>(ut_align(
+					m_mem.get(), UNIV_PAGE_SIZE));
+			}
+		}
+
+		return(m_page);
+	}
+
+private:
+	/** The memory, twice the page size so that it can be aligned */
+	std::unique_ptr<byte[]>	m_mem;
+
+	/** The page-aligned buffer in m_mem */
+	page_t*			m_page = nullptr;
+};
+
+/** The buffer of the page copies of this thread */
+static thread_local Btr_cur_page_copy	btr_cur_page_copy;
+
+/** Optimistically positions a tree cursor on the leaf level for a
+BTR_SEARCH_LEAF search. The root and the other non-leaf pages are only
+buffer-fixed, not latched, and neither is the index->lock. Each page is
+copied unlatched to a private buffer and the copy is validated against
+the latch version of its block (see buf_block_optimistic_read_begin())
+before anything in it is parsed, so that a torn read of a page that is
+being modified is never searched. The child page number found in the
+copy is validated against the parent again after the child has been
+fixed, so that a concurrent split, merge or page free of the child is
+detected. The leaf page itself is s-latched normally.
+@param[in]	index	index tree, not spatial and not the change buffer
+@param[in]	tuple	data tuple
+@param[in]	mode	PAGE_CUR_L, ...
+@param[in,out]	cursor	tree cursor
+@param[in]	file	file name
+@param[in]	line	line where called
+@param[in,out]	mtr	mini-transaction
+@return true if the cursor was positioned and the leaf page s-latched;
+false if a concurrent modification was detected, in which case nothing
+is left fixed or latched in mtr and the caller must search the tree
+the pessimistic way */
+static
+bool
+btr_cur_optimistic_search_leaf(
+	dict_index_t*	index,
+	const dtuple_t*	tuple,
+	page_cur_mode_t	mode,
+	btr_cur_t*	cursor,
+	const char*	file,
+	ulint		line,
+	mtr_t*		mtr)
+{
+	buf_block_t*	tree_blocks[BTR_MAX_LEVELS];
+	ulint		tree_savepoints[BTR_MAX_LEVELS];
+	ulint		n_blocks = 0;
+	ulint		version = 0;
+	ulint		up_match = 0;
+	ulint		up_bytes = 0;
+	ulint		low_match = 0;
+	ulint		low_bytes = 0;
+	ulint		height = ULINT_UNDEFINED;
+	page_cur_mode_t	page_mode;
+	bool		success = false;
+	mem_heap_t*	heap = nullptr;
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets = offsets_;
+	rec_offs_init(offsets_);
+
+	ut_ad(!dict_index_is_spatial(index));
+	ut_ad(!dict_index_is_ibuf(index));
+
+	/* The pages are copied to a page-aligned buffer, since the record
+	and directory accessors find the page of a record by alignment. */
+	page_t*		copy = btr_cur_page_copy.get();
+
+	if (copy == nullptr) {
+		return(false);
+	}
+
+	switch (mode) {
+	case PAGE_CUR_GE:
+		page_mode = PAGE_CUR_L;
+		break;
+	case PAGE_CUR_G:
+		page_mode = PAGE_CUR_LE;
+		break;
+	default:
+		page_mode = mode;
+		break;
+	}
+
+	page_cur_t*		page_cursor = btr_cur_get_page_cur(cursor);
+	const space_id_t	space = dict_index_get_space(index);
+	const page_size_t	page_size(dict_table_page_size(index->table));
+	page_id_t		page_id(space, dict_index_get_page(index));
+	buf_block_t*		block;
+
+	tree_savepoints[n_blocks] = mtr_set_savepoint(mtr);
+	block = buf_page_get_gen(page_id, page_size, RW_NO_LATCH, NULL,
+				 BUF_GET, file, line, mtr);
+	tree_blocks[n_blocks++] = block;
+
+	for (;;) {
+		if (!buf_block_optimistic_read_begin(block, &version)) {
+			goto func_exit;
+		}
+
+		memcpy(copy, buf_block_get_frame(block), UNIV_PAGE_SIZE);
+
+		/* Nothing in the copy may be looked at before it has been
+		validated: a torn copy could contain offsets and record
+		counts that the page accessors would assert on or follow
+		outside the page. A validated copy is a consistent page. */
+		if (!buf_block_optimistic_read_validate(block, version)) {
+			goto func_exit;
+		}
+
+		/* The block may have been freed and reused since its page
+		number was read from the parent, or the root may be a leaf,
+		which the pessimistic search handles just as fast. */
+		if (!fil_page_index_page_check(copy)
+		    || btr_page_get_index_id(copy) != index->id
+		    || page_is_leaf(copy)
+		    || (height != ULINT_UNDEFINED
+			&& btr_page_get_level_low(copy) != height)) {
+			goto func_exit;
+		}
+
+		if (height == ULINT_UNDEFINED) {
+			height = btr_page_get_level_low(copy);
+
+			if (height >= BTR_MAX_LEVELS) {
+				goto func_exit;
+			}
+
+			cursor->tree_height = height + 1;
+		}
+
+		const rec_t*	node_ptr = btr_cur_search_node_ptr_in_copy(
+			copy, index, tuple, page_mode, &heap);
+
+		if (page_rec_is_infimum(node_ptr)) {
+			goto func_exit;
+		}
+
+		offsets = rec_get_offsets(
+			node_ptr, index, offsets, ULINT_UNDEFINED, &heap);
+
+		const page_no_t	child_page_no
+			= btr_node_ptr_get_child_page_no(node_ptr, offsets);
+
+		height--;
+		page_id.reset(space, child_page_no);
+
+		/* A page that changes while the child is fixed fails the
+		validation below. */
+		DEBUG_SYNC_C("btr_cur_optimistic_descent_before_child");
+
+		tree_savepoints[n_blocks] = mtr_set_savepoint(mtr);
+
+		if (height == 0) {
+			block = buf_page_get_gen(
+				page_id, page_size, RW_S_LATCH, NULL,
+				BUF_GET, file, line, mtr);
+		} else {
+			block = buf_page_get_gen(
+				page_id, page_size, RW_NO_LATCH, NULL,
+				BUF_GET, file, line, mtr);
+		}
+
+		tree_blocks[n_blocks++] = block;
+
+		/* If the parent page has not changed, its node pointer
+		still refers to the child, so the child cannot have been
+		split, merged or freed before we fixed it. */
+		if (!buf_block_optimistic_read_validate(
+			    tree_blocks[n_blocks - 2], version)) {
+			goto func_exit;
+		}
+
+		if (height == 0) {
+			break;
+		}
+	}
+
+	buf_block_dbg_add_level(block, SYNC_TREE_NODE);
+
+	ut_ad(fil_page_index_page_check(buf_block_get_frame(block)));
+	ut_ad(index->id == btr_page_get_index_id(buf_block_get_frame(block)));
+	ut_ad(page_is_leaf(buf_block_get_frame(block)));
+
+	/* Unfix the non-leaf pages, keep the s-latch on the leaf. */
+	for (ulint i = 0; i + 1 < n_blocks; i++) {
+		mtr_release_block_at_savepoint(
+			mtr, tree_savepoints[i], tree_blocks[i]);
+	}
+	n_blocks = 0;
+
+	if (btr_search_enabled) {
+		page_cur_search_with_match_bytes(
+			block, index, tuple, mode, &up_match, &up_bytes,
+			&low_match, &low_bytes, page_cursor);
+	} else {
+		up_bytes = low_bytes = 0;
+		page_cur_search_with_match(
+			block, index, tuple, mode, &up_match,
+			&low_match, page_cursor, NULL);
+	}
+
+	cursor->low_match = low_match;
+	cursor->low_bytes = low_bytes;
+	cursor->up_match = up_match;
+	cursor->up_bytes = up_bytes;
+
+#ifdef BTR_CUR_ADAPT
+	if (btr_search_enabled && !index->disable_ahi) {
+		btr_search_info_update(index, cursor);
+	}
+#endif /* BTR_CUR_ADAPT */
+
+	success = true;
+
+func_exit:
+	if (!success) {
+		/* Release in reverse order, the leaf s-latch first. */
+		while (n_blocks > 0) {
+			n_blocks--;
+			mtr_release_block_at_savepoint(
+				mtr, tree_savepoints[n_blocks],
+				tree_blocks[n_blocks]);
+		}
+	}
+
+	if (heap != nullptr) {
+		mem_heap_free(heap);
+	}
+
+	return(success);
+}
+
 /********************************************************************//**
 Searches an index tree and positions a tree cursor on a given level.
 NOTE: n_fields_cmp in tuple must be set so that it cannot be compared
@@ -881,6 +1224,38 @@ btr_cur_search_to_nth_level(
 		rw_lock_s_unlock(btr_get_search_latch(index));
 	}
 
+	/* Try to reach the leaf without latching the index or the
+	non-leaf pages. Temporary tables are private to one thread and
+	gain nothing from this. In read-only mode the search below takes
+	neither the index->lock nor latches on the non-leaf pages either,
+	since nothing can modify the tree, so it is already latch-free
+	and the copying would only add work. */
+	if (btr_cur_optimistic_descent
+	    && latch_mode == BTR_SEARCH_LEAF
+	    && level == 0
+	    && btr_op == BTR_NO_OP
+	    && !estimate
+	    && !s_latch_by_caller
+	    && !srv_read_only_mode
+	    && !dict_index_is_spatial(index)
+	    && !dict_index_is_ibuf(index)
+	    && !index->table->is_temporary()) {
+
+		if (btr_cur_optimistic_search_leaf(
+			    index, tuple, mode, cursor, file, line, mtr)) {
+
+			MONITOR_INC(MONITOR_INDEX_OPTIMISTIC_DESCENT);
+
+			if (has_search_latch) {
+				rw_lock_s_lock(btr_get_search_latch(index));
+			}
+
+			DBUG_VOID_RETURN;
+		}
+
+		MONITOR_INC(MONITOR_INDEX_OPTIMISTIC_DESCENT_FAILED);
+	}
+
 	/* Store the position of the tree latch we push to mtr so that we
 	know how to release it when we have latched leaf node(s) */
 
@@ -5572,6 +5947,8 @@ static const int64_t	rows_in_range_arbitrary_ret_val = 10;
 @param[in]	nth_attempt	if the tree gets modified too much while
 we are trying to analyze it, then we will retry (this function will call
 itself, incrementing this parameter)
+@param[out]	leaf_page_no	the leaf page the dive for the range end
+reached, or FIL_NULL if the range has no end
 @return estimated number of rows; if after rows_in_range_max_retries
 retries the tree keeps changing, then we will just return
 rows_in_range_arbitrary_ret_val as a result (if
@@ -5585,7 +5962,8 @@ btr_estimate_n_rows_in_range_low(
 	page_cur_mode_t	mode1,
 	const dtuple_t*	tuple2,
 	page_cur_mode_t	mode2,
-	unsigned	nth_attempt)
+	unsigned	nth_attempt,
+	page_no_t*	leaf_page_no)
 {
 	btr_path_t	path1[BTR_PATH_ARRAY_N_SLOTS];
 	btr_path_t	path2[BTR_PATH_ARRAY_N_SLOTS];
@@ -5668,6 +6046,8 @@ btr_estimate_n_rows_in_range_low(
 
 		ut_ad(!(mode2 == PAGE_CUR_L && page_rec_is_supremum(rec)));
 
+		*leaf_page_no = btr_cur_get_block(&cursor)->page.id.page_no();
+
 		should_count_the_right_border
 			= (mode2 == PAGE_CUR_LE /* if the range is '<=' */
 			   /* and the record was found */
@@ -5702,6 +6082,7 @@ btr_estimate_n_rows_in_range_low(
 		positioned the cursor on the supremum record on the rightmost
 		page, which must not be counted. */
 		should_count_the_right_border = false;
+		*leaf_page_no = FIL_NULL;
 	}
 
 	mtr_commit(&mtr);
@@ -5844,7 +6225,8 @@ btr_estimate_n_rows_in_range_low(
 				const int64_t	ret =
 					btr_estimate_n_rows_in_range_low(
 						index, tuple1, mode1,
-						tuple2, mode2, nth_attempt + 1);
+						tuple2, mode2, nth_attempt + 1,
+						leaf_page_no);
 
 				return(ret);
 			}
@@ -5922,12 +6304,167 @@ btr_estimate_n_rows_in_range(
 	const dtuple_t*	tuple2,
 	page_cur_mode_t	mode2)
 {
+	page_no_t	leaf_page_no;
+
 	const int64_t	ret = btr_estimate_n_rows_in_range_low(
-		index, tuple1, mode1, tuple2, mode2, 1 /* first attempt */);
+		index, tuple1, mode1, tuple2, mode2, 1 /* first attempt */,
+		&leaf_page_no);
 
 	return(ret);
 }
 
+/** Positions a range border on a leaf page for
+btr_estimate_n_rows_in_ranges().
+@param[in]	block		leaf page, latched by the caller
+@param[in]	index		index
+@param[in]	tuple		range border
+@param[in]	mode		search mode for the border
+@param[out]	nth_rec		index of the record the border is on, as in
+btr_path_t::nth_rec
+@param[out]	low_match	number of fields of tuple matched by the
+record the border is on or the record before it
+@return true if the border is between two user records of the page. Then
+a dive from the root for the border would end on the same record, because
+no other page of the index can hold keys between these records. */
+static
+bool
+btr_estimate_locate_on_leaf(
+	const buf_block_t*	block,
+	const dict_index_t*	index,
+	const dtuple_t*		tuple,
+	page_cur_mode_t		mode,
+	ulint*			nth_rec,
+	ulint*			low_match)
+{
+	if (mode != PAGE_CUR_G && mode != PAGE_CUR_GE
+	    && mode != PAGE_CUR_L && mode != PAGE_CUR_LE) {
+		return(false);
+	}
+
+	page_cur_t	page_cursor;
+	ulint		up_match = 0;
+
+	*low_match = 0;
+
+	page_cur_search_with_match(block, index, tuple, mode, &up_match,
+				   low_match, &page_cursor, NULL);
+
+	const rec_t*	rec = page_cur_get_rec(&page_cursor);
+
+	if (page_rec_is_infimum(rec) || page_rec_is_supremum(rec)) {
+		return(false);
+	}
+
+	/* For G and GE the cursor is on the first record after the border,
+	for L and LE on the last record before it. The border is inside the
+	page if the record on its other side is on the page too. */
+	const rec_t*	other = (mode == PAGE_CUR_G || mode == PAGE_CUR_GE)
+		? page_rec_get_prev_const(rec)
+		: page_rec_get_next_const(rec);
+
+	if (page_rec_is_infimum(other) || page_rec_is_supremum(other)) {
+		return(false);
+	}
+
+	*nth_rec = page_rec_get_n_recs_before(rec);
+
+	return(true);
+}
+
+/** Estimates the number of rows in each of a sequence of index ranges.
+The ranges are expected to be sorted on their start, as the range optimizer
+produces them. The leaf page reached by the last dive from the root is
+remembered, and a range whose both borders are between the records of that
+page is counted on the page alone, without diving from the root again. For
+long lists of narrow ranges, such as those of a large IN list, most ranges
+then cost one page access instead of two dives.
+@param[in]	index		index
+@param[in]	n_ranges	number of ranges
+@param[in]	tuples1		range starts, may also be empty tuples
+@param[in]	modes1		search modes for the range starts
+@param[in]	tuples2		range ends, may also be empty tuples
+@param[in]	modes2		search modes for the range ends
+@param[out]	n_rows		estimated number of rows in each range */
+void
+btr_estimate_n_rows_in_ranges(
+	dict_index_t*		index,
+	ulint			n_ranges,
+	const dtuple_t* const*	tuples1,
+	const page_cur_mode_t*	modes1,
+	const dtuple_t* const*	tuples2,
+	const page_cur_mode_t*	modes2,
+	int64_t*		n_rows)
+{
+	page_no_t		leaf_page_no = FIL_NULL;
+	const page_size_t	page_size(dict_table_page_size(index->table));
+
+	for (ulint i = 0; i < n_ranges; i++) {
+
+		if (leaf_page_no != FIL_NULL
+		    && dtuple_get_n_fields(tuples1[i]) > 0
+		    && dtuple_get_n_fields(tuples2[i]) > 0) {
+
+			mtr_t	mtr;
+
+			mtr_start(&mtr);
+
+			/* We do not hold the index->lock and the page may
+			have been freed or reused since the last dive, see
+			btr_estimate_n_rows_in_range_on_level(). */
+			buf_block_t*	block = buf_page_get_gen(
+				page_id_t(dict_index_get_space(index),
+					  leaf_page_no),
+				page_size, RW_S_LATCH, NULL,
+				BUF_GET_POSSIBLY_FREED,
+				__FILE__, __LINE__, &mtr);
+
+			const page_t*	page = buf_block_get_frame(block);
+			ulint		nth_rec1;
+			ulint		nth_rec2;
+			ulint		low_match;
+			ulint		unused;
+
+			if (fil_page_index_page_check(page)
+			    && btr_page_get_index_id(page) == index->id
+			    && page_is_leaf(page)
+			    && btr_estimate_locate_on_leaf(
+				    block, index, tuples1[i], modes1[i],
+				    &nth_rec1, &unused)
+			    && btr_estimate_locate_on_leaf(
+				    block, index, tuples2[i], modes2[i],
+				    &nth_rec2, &low_match)) {
+
+				/* Count as btr_estimate_n_rows_in_range_low()
+				does when both dives end on the same page;
+				the left border is never on the supremum. */
+				const bool	count_right_border
+					= (modes2[i] == PAGE_CUR_LE
+					   && low_match >= dtuple_get_n_fields(
+						   tuples2[i]))
+					|| modes2[i] == PAGE_CUR_L;
+
+				if (nth_rec1 == nth_rec2) {
+					n_rows[i] = count_right_border ? 1 : 0;
+				} else if (nth_rec1 < nth_rec2) {
+					n_rows[i] = nth_rec2 - nth_rec1
+						+ (count_right_border ? 1 : 0);
+				} else {
+					n_rows[i] = 0;
+				}
+
+				mtr_commit(&mtr);
+				continue;
+			}
+
+			mtr_commit(&mtr);
+		}
+
+		n_rows[i] = btr_estimate_n_rows_in_range_low(
+			index, tuples1[i], modes1[i], tuples2[i], modes2[i],
+			1 /* first attempt */, &leaf_page_no);
+	}
+}
+
 /*******************************************************************//**
 Record the number of non_null key values in a given index for
 each n-column prefix of the index where 1 <= n <= dict_index_get_n_unique(index).
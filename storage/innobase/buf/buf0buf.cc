@@ -314,6 +314,31 @@ static buf_pool_chunk_map_t*			buf_chunk_map_reg;
 pool(s). */
 buf_stat_per_index_t*	buf_stat_per_index;
 
+/** Get the index of a buffer pool page, if it is an index leaf page.
+@param[in]	bpage	page whose frame (or compressed frame) to inspect
+@param[out]	id	index of the page
+@return true if the page is an index leaf page */
+bool
+buf_stat_per_index_leaf(
+	const buf_page_t*	bpage,
+	index_id_t*		id)
+{
+	const byte*	frame = bpage->zip.data != NULL
+		? bpage->zip.data
+		: reinterpret_cast<const buf_block_t*>(bpage)->frame;
+
+	const ulint	page_type = fil_page_get_type(frame);
+
+	if ((page_type != FIL_PAGE_INDEX && page_type != FIL_PAGE_RTREE)
+	    || !page_is_leaf(frame)) {
+		return(false);
+	}
+
+	*id = index_id_t(bpage->id.space(), btr_page_get_index_id(frame));
+
+	return(true);
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /** This is used to insert validation operations in execution
 in the debug version */
@@ -816,6 +841,7 @@ buf_block_init(
 	block->page.flush_observer = NULL;
 
 	block->modify_clock = 0;
+	block->latch_version = 0;
 
 	ut_d(block->page.file_page_was_freed = FALSE);
 
@@ -3456,6 +3482,7 @@ buf_page_get_gen(
 	rw_lock_t*	hash_lock;
 	buf_block_t*	fix_block;
 	ulint		retries = 0;
+	bool		read_from_file = false;
 	buf_pool_t*	buf_pool = buf_pool_get(page_id);
 
 	ut_ad(mtr->is_active());
@@ -3585,6 +3612,8 @@ loop:
 			return(NULL);
 		}
 
+		read_from_file = true;
+
 		if (buf_read_page(page_id, page_size)) {
 			buf_read_ahead_random(page_id, page_size,
 					      ibuf_inside(mtr));
@@ -3840,6 +3869,7 @@ got_block:
 
 		os_atomic_decrement_ulint(&buf_pool->n_pend_unzip, 1);
 
+		block->latch_version++;
 		rw_lock_x_unlock(&block->lock);
 
 		break;
@@ -3989,6 +4019,17 @@ got_block:
 	and block->lock. */
 	buf_wait_for_read(fix_block);
 
+	if (srv_cached_indexes_access_stats && mode != BUF_PEEK_IF_IN_POOL) {
+		index_id_t	id(0, 0);
+
+		if (buf_stat_per_index_leaf(&fix_block->page, &id)) {
+			buf_stat_per_index->inc(
+				id, read_from_file
+				? buf_stat_per_index_t::MISSES
+				: buf_stat_per_index_t::HITS);
+		}
+	}
+
 	/* Mark block as dirty if requested by caller. If not requested (false)
 	then we avoid updating the dirty state of the block and retain the
 	original one. This is reason why ?
@@ -4380,6 +4421,8 @@ buf_page_init_low(
 	bpage->access_time = 0;
 	bpage->newest_modification = 0;
 	bpage->oldest_modification = 0;
+	bpage->dirty_index_id = 0;
+	bpage->dirty_leaf = false;
 	HASH_INVALIDATE(bpage, hash);
 
 	ut_d(bpage->file_page_was_freed = FALSE);
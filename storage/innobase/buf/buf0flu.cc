@@ -40,6 +40,7 @@ Created 11/11/1995 Heikki Tuuri
 #ifndef UNIV_HOTBACKUP
 #include "buf0lru.h"
 #include "buf0rea.h"
+#include "buf0stats.h"
 #include "fil0fil.h"
 #include "fsp0sysspace.h"
 #include "ibuf0ibuf.h"
@@ -217,7 +218,8 @@ void
 buf_flush_page_cleaner_thread();
 
 /******************************************************************//**
-Increases flush_list size in bytes with the page size in inline function */
+Increases flush_list size in bytes with the page size in inline function
+and accounts index leaf pages as dirty in the per index statistics. */
 static inline
 void
 incr_flush_list_size_in_bytes(
@@ -230,6 +232,18 @@ incr_flush_list_size_in_bytes(
 	buf_pool->stat.flush_list_bytes += block->page.size.physical();
 
 	ut_ad(buf_pool->stat.flush_list_bytes <= buf_pool->curr_pool_size);
+
+	/* Remember the index that the page is accounted to: the index id
+	and the level in the frame may change while the page is dirty, for
+	example when the root is raised or the page is freed and reused. */
+	index_id_t	id(0, 0);
+
+	block->page.dirty_leaf = buf_stat_per_index_leaf(&block->page, &id);
+
+	if (block->page.dirty_leaf) {
+		block->page.dirty_index_id = id.m_index_id;
+		buf_stat_per_index->inc(id, buf_stat_per_index_t::DIRTY);
+	}
 }
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
@@ -705,6 +719,13 @@ buf_flush_remove(
 
 	buf_pool->stat.flush_list_bytes -= bpage->size.physical();
 
+	if (bpage->dirty_leaf) {
+		buf_stat_per_index->dec(
+			index_id_t(bpage->id.space(), bpage->dirty_index_id),
+			buf_stat_per_index_t::DIRTY);
+		bpage->dirty_leaf = false;
+	}
+
 	bpage->oldest_modification = 0;
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
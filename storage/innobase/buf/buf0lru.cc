@@ -2299,23 +2299,14 @@ buf_LRU_block_remove_hashed(
 			/* Account the eviction of index leaf pages from
 			the buffer pool(s). */
 
-			const byte*	frame
-				= bpage->zip.data != NULL
-				? bpage->zip.data
-				: reinterpret_cast<buf_block_t*>(bpage)->frame;
+			index_id_t	id(0, 0);
 
-			const ulint	type = fil_page_get_type(frame);
+			if (buf_stat_per_index_leaf(bpage, &id)) {
 
-			if ((type == FIL_PAGE_INDEX || type == FIL_PAGE_RTREE)
-			    && page_is_leaf(frame)) {
+				buf_stat_per_index->dec(id);
 
-				uint32_t	space_id = bpage->id.space();
-
-				space_index_t	idx_id =
-					btr_page_get_index_id(frame);
-
-				buf_stat_per_index->dec(
-					index_id_t(space_id, idx_id));
+				buf_stat_per_index->inc(
+					id, buf_stat_per_index_t::EVICTED);
 			}
 		}
 
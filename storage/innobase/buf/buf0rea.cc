@@ -705,6 +705,102 @@ buf_read_ahead_linear(
 	return(count);
 }
 
+/** Issues asynchronous read requests for the pages that directly follow
+a page in the tablespace. This is meant for page chains that are usually
+allocated in ascending page number order, such as the pages of an
+externally stored column, when the caller knows how many more pages of
+the chain it is going to read. A wrong guess only costs a useless read.
+Does nothing if read-ahead is disabled or too many reads are pending.
+@param[in]	page_id		page id of the page being read
+@param[in]	page_size	page size
+@param[in]	n_pages		number of following pages to read; limited
+to the read-ahead area size and to the size of the tablespace
+@return number of page read requests issued */
+ulint
+buf_read_ahead_successors(
+	const page_id_t&	page_id,
+	const page_size_t&	page_size,
+	page_no_t		n_pages)
+{
+	buf_pool_t*	buf_pool = buf_pool_get(page_id);
+	ulint		count = 0;
+	page_no_t	low;
+	page_no_t	high;
+	dberr_t		err;
+
+	/* Follow the switch of linear read-ahead */
+	if (!srv_read_ahead_threshold || n_pages == 0) {
+		return(0);
+	}
+
+	if (srv_startup_is_before_trx_rollback_phase) {
+		/* No read-ahead to avoid thread deadlocks */
+		return(0);
+	}
+
+	low = page_id.page_no() + 1;
+	high = low + std::min(n_pages, static_cast<page_no_t>(
+		BUF_READ_AHEAD_AREA(buf_pool)));
+
+	if (fil_space_t* space = fil_space_acquire(page_id.space())) {
+		if (high > space->size) {
+			high = space->size;
+		}
+		fil_space_release(space);
+	} else {
+		return(0);
+	}
+
+	os_rmb;
+	if (buf_pool->n_pend_reads
+	    > buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+
+		return(0);
+	}
+
+	for (page_no_t i = low; i < high; i++) {
+		const page_id_t	cur_page_id(page_id.space(), i);
+
+		if (ibuf_bitmap_page(cur_page_id, page_size)) {
+			continue;
+		}
+
+		count += buf_read_page_low(
+			&err, false,
+			IORequest::DO_NOT_WAKE | IORequest::IGNORE_MISSING,
+			BUF_READ_ANY_PAGE, cur_page_id, page_size, false);
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+	}
+
+	/* In simulated aio we wake the aio handler threads only after
+	queuing all aio requests, in native aio the following call does
+	nothing: */
+
+	os_aio_simulated_wake_handler_threads();
+
+	if (count == 0) {
+		return(0);
+	}
+
+	DBUG_PRINT("ib_buf", ("successor read-ahead %u pages, %u:%u",
+			      (unsigned) count,
+			      (unsigned) page_id.space(),
+			      (unsigned) page_id.page_no()));
+
+	/* Read ahead is considered one I/O operation for the purpose of
+	LRU policy decision. */
+	buf_LRU_stat_inc_io();
+
+	/* The pages are counted as read ahead only: buf_pool_reads counts
+	the reads that a thread had to wait for. */
+	buf_pool->stat.n_ra_pages_read += count;
+
+	return(count);
+}
+
 /********************************************************************//**
 Issues read requests for pages which the ibuf module wants to read in, in
 order to contract the insert buffer tree. Technically, this function is like
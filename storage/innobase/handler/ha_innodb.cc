@@ -126,6 +126,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include "row0ins.h"
 #include "row0merge.h"
 #include "row0mysql.h"
+#include "row0pread.h"
 #include "row0quiesce.h"
 #include "row0sel.h"
 #include "row0upd.h"
@@ -627,6 +628,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	PSI_MUTEX_KEY(page_sys_arch_oper_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(page_zip_stat_per_index_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(page_cleaner_mutex, 0, 0, PSI_DOCUMENT_ME),
+	PSI_MUTEX_KEY(parallel_read_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(purge_sys_pq_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(recv_sys_mutex, 0, 0, PSI_DOCUMENT_ME),
 	PSI_MUTEX_KEY(recv_writer_mutex, 0, 0, PSI_DOCUMENT_ME),
@@ -722,11 +724,13 @@ static PSI_thread_info	all_innodb_threads[] = {
 	PSI_KEY(srv_purge_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(srv_worker_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(trx_recovery_rollback_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(undo_truncate_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(page_flush_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(page_flush_coordinator_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(fts_optimize_thread, 0, 0, PSI_DOCUMENT_ME),
 	PSI_KEY(fts_parallel_merge_thread, 0, 0, PSI_DOCUMENT_ME),
-	PSI_KEY(fts_parallel_tokenization_thread, 0, 0, PSI_DOCUMENT_ME)
+	PSI_KEY(fts_parallel_tokenization_thread, 0, 0, PSI_DOCUMENT_ME),
+	PSI_KEY(parallel_read_thread, 0, 0, PSI_DOCUMENT_ME)
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -959,6 +963,11 @@ static MYSQL_THDVAR_ULONG(lock_wait_timeout, PLUGIN_VAR_RQCMDARG,
   "Timeout in seconds an InnoDB transaction may wait for a lock before being rolled back. Values above 100000000 disable the timeout.",
   NULL, NULL, 50, 1, 1024 * 1024 * 1024, 0);
 
+static MYSQL_THDVAR_ULONG(parallel_read_threads, PLUGIN_VAR_RQCMDARG,
+  "Number of threads that count the rows of a table for SELECT COUNT(*)"
+  " without a WHERE clause. 1 counts them on the thread of the query.",
+  NULL, NULL, 1, 1, PARALLEL_READ_MAX_THREADS, 0);
+
 static MYSQL_THDVAR_STR(ft_user_stopword_table,
   PLUGIN_VAR_OPCMDARG|PLUGIN_VAR_MEMALLOC,
   "User supplied stopword table name, effective in the session level.",
@@ -14939,8 +14948,18 @@ ha_innobase::records(
 	m_prebuilt->read_just_key = 1;
 	build_template(false);
 
-	/* Count the records in the clustered index */
-	ret = row_scan_index_for_mysql(m_prebuilt, index, false, &n_rows);
+	/* Count the records in the clustered index. A consistent read of
+	a persistent table can be split between several threads. */
+	const ulint	n_threads = THDVAR(m_user_thd, parallel_read_threads);
+
+	if (n_threads > 1
+	    && m_prebuilt->select_lock_type == LOCK_NONE
+	    && !m_prebuilt->table->is_temporary()) {
+		ret = row_count_parallel(m_prebuilt, index, n_threads, &n_rows);
+	} else {
+		ret = row_scan_index_for_mysql(
+			m_prebuilt, index, false, &n_rows);
+	}
 	reset_template();
 	switch (ret) {
 	case DB_SUCCESS:
@@ -15111,6 +15130,146 @@ func_exit:
 	DBUG_RETURN((ha_rows) n_rows);
 }
 
+/*********************************************************************//**
+Estimates the number of index records in each of a sequence of ranges.
+The ranges are estimated with one call to btr_estimate_n_rows_in_ranges(),
+which counts ranges that fall on the leaf page reached by the previous dive
+without diving from the root again. */
+
+void
+ha_innobase::records_in_ranges(
+/*===========================*/
+	uint		keynr,		/*!< in: index number */
+	Range_estimate*	ranges,		/*!< in/out: the ranges, sorted */
+	uint		n_ranges)	/*!< in: number of ranges */
+{
+	DBUG_ENTER("ha_innobase::records_in_ranges");
+
+	ut_a(m_prebuilt->trx == thd_to_trx(ha_thd()));
+
+	dict_index_t*	index = innobase_get_index(keynr);
+
+	/* Let records_in_range() report unusable indexes, and handle
+	spatial indexes, for which only the start of a range is used. */
+	if (n_ranges < 2
+	    || dict_table_is_discarded(m_prebuilt->table)
+	    || index == NULL
+	    || index->is_corrupted()
+	    || !index->is_usable(m_prebuilt->trx)
+	    || dict_index_is_spatial(index)) {
+
+		handler::records_in_ranges(keynr, ranges, n_ranges);
+		DBUG_VOID_RETURN;
+	}
+
+	m_prebuilt->trx->op_info = "estimating records in index ranges";
+
+	TrxInInnoDB	trx_in_innodb(m_prebuilt->trx);
+
+	active_index = keynr;
+
+	const KEY*	key = table->key_info + active_index;
+	const ulint	n_fields = key->actual_key_parts;
+	const ulint	key_val_len = m_prebuilt->srch_key_val_len;
+
+	mem_heap_t*	heap = mem_heap_create(
+		n_ranges * (2 * (n_fields * sizeof(dfield_t) + sizeof(dtuple_t)
+				 + key_val_len)
+			    + 2 * sizeof(dtuple_t*)
+			    + 2 * sizeof(page_cur_mode_t) + sizeof(int64_t)));
+
+	const dtuple_t** tuples1 = static_cast<const dtuple_t**>(
+		mem_heap_alloc(heap, n_ranges * sizeof(dtuple_t*)));
+	const dtuple_t** tuples2 = static_cast<const dtuple_t**>(
+		mem_heap_alloc(heap, n_ranges * sizeof(dtuple_t*)));
+	page_cur_mode_t* modes1 = static_cast<page_cur_mode_t*>(
+		mem_heap_alloc(heap, n_ranges * sizeof(page_cur_mode_t)));
+	page_cur_mode_t* modes2 = static_cast<page_cur_mode_t*>(
+		mem_heap_alloc(heap, n_ranges * sizeof(page_cur_mode_t)));
+	int64_t*	n_rows = static_cast<int64_t*>(
+		mem_heap_alloc(heap, n_ranges * sizeof(int64_t)));
+
+	bool		supported = true;
+
+	for (uint i = 0; i < n_ranges && supported; i++) {
+		const key_range*	min_key = ranges[i].min_key;
+		const key_range*	max_key = ranges[i].max_key;
+
+		/* Each range needs its own buffers for the INT key parts,
+		which the tuples point to, unlike records_in_range() which
+		can use the two buffers of m_prebuilt. */
+		byte*		key_val1 = NULL;
+		byte*		key_val2 = NULL;
+
+		if (key_val_len > 0) {
+			key_val1 = static_cast<byte*>(
+				mem_heap_alloc(heap, 2 * key_val_len));
+			key_val2 = key_val1 + key_val_len;
+		}
+
+		dtuple_t*	range_start = dtuple_create(heap, n_fields);
+		dict_index_copy_types(range_start, index, n_fields);
+
+		dtuple_t*	range_end = dtuple_create(heap, n_fields);
+		dict_index_copy_types(range_end, index, n_fields);
+
+		row_sel_convert_mysql_key_to_innobase(
+			range_start, key_val1, key_val_len, index,
+			(byte*) (min_key ? min_key->key : (const uchar*) 0),
+			(ulint) (min_key ? min_key->length : 0),
+			m_prebuilt->trx);
+
+		row_sel_convert_mysql_key_to_innobase(
+			range_end, key_val2, key_val_len, index,
+			(byte*) (max_key ? max_key->key : (const uchar*) 0),
+			(ulint) (max_key ? max_key->length : 0),
+			m_prebuilt->trx);
+
+		tuples1[i] = range_start;
+		tuples2[i] = range_end;
+
+		modes1[i] = convert_search_mode_to_innobase(
+			min_key ? min_key->flag : HA_READ_KEY_EXACT);
+
+		modes2[i] = convert_search_mode_to_innobase(
+			max_key ? max_key->flag : HA_READ_KEY_EXACT);
+
+		supported = modes1[i] != PAGE_CUR_UNSUPP
+			&& modes2[i] != PAGE_CUR_UNSUPP;
+	}
+
+	if (supported) {
+		btr_estimate_n_rows_in_ranges(
+			index, n_ranges, tuples1, modes1, tuples2, modes2,
+			n_rows);
+
+		DBUG_EXECUTE_IF(
+			"print_btr_estimate_n_rows_in_range_return_value",
+			for (uint i = 0; i < n_ranges; i++) {
+				push_warning_printf(
+					ha_thd(), Sql_condition::SL_WARNING,
+					ER_NO_DEFAULT,
+					"btr_estimate_n_rows_in_range(): %"
+					PRId64, n_rows[i]);
+			}
+		);
+	}
+
+	for (uint i = 0; i < n_ranges; i++) {
+		/* An estimate of 0 rows is never returned, as in
+		records_in_range(). */
+		ranges[i].rows = !supported
+			? HA_POS_ERROR
+			: n_rows[i] == 0 ? 1 : static_cast<ha_rows>(n_rows[i]);
+	}
+
+	mem_heap_free(heap);
+
+	m_prebuilt->trx->op_info = (char*)"";
+
+	DBUG_VOID_RETURN;
+}
+
 /*********************************************************************//**
 Gives an UPPER BOUND to the number of rows in a table. This is used in
 filesort.cc.
@@ -21074,6 +21233,14 @@ static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   1,			/* Minimum value */
   MAX_PURGE_THREADS, 0);/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(parallel_read_worker_threads,
+  srv_parallel_read_worker_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Maximum number of threads in the server that help sessions count rows"
+  " with innodb_parallel_read_threads. The threads are started when first"
+  " needed. 0 means that every session counts the rows alone.",
+  NULL, NULL, 16, 0, PARALLEL_READ_MAX_THREADS, 0);
+
 static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Size of the mutex/lock wait array.",
@@ -21228,6 +21395,14 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   " Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, true);
 
+static MYSQL_SYSVAR_BOOL(btree_optimistic_descent, btr_cur_optimistic_descent,
+  PLUGIN_VAR_OPCMDARG,
+  "Let read-only B-tree searches descend the non-leaf levels of an index"
+  " without latching the index tree or the non-leaf pages, validating the"
+  " pages read against concurrent modifications instead"
+  " (disabled by default).",
+  NULL, NULL, false);
+
 /** Number of distinct partitions of AHI.
 Each partition is protected by its own latch and so we have parts number
 of latches protecting complete search system. */
@@ -21345,6 +21520,13 @@ static MYSQL_SYSVAR_ULONG(buffer_pool_dump_pct, srv_buf_pool_dump_pct,
   "Dump only the hottest N% of each buffer pool, defaults to 25",
   NULL, NULL, 25, 1, 100, 0);
 
+static MYSQL_SYSVAR_BOOL(cached_indexes_access_stats,
+  srv_cached_indexes_access_stats,
+  PLUGIN_VAR_OPCMDARG,
+  "Count buffer pool hits and misses of index leaf pages per index, see"
+  " INFORMATION_SCHEMA.INNODB_CACHED_INDEXES (disabled by default).",
+  NULL, NULL, false);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -21898,6 +22080,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(buffer_pool_dump_now),
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
   MYSQL_SYSVAR(buffer_pool_dump_pct),
+  MYSQL_SYSVAR(cached_indexes_access_stats),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* UNIV_DEBUG */
@@ -21941,6 +22124,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(ft_sort_pll_degree),
   MYSQL_SYSVAR(force_load_corrupted),
   MYSQL_SYSVAR(lock_wait_timeout),
+  MYSQL_SYSVAR(parallel_read_threads),
+  MYSQL_SYSVAR(parallel_read_worker_threads),
   MYSQL_SYSVAR(deadlock_detect),
   MYSQL_SYSVAR(page_size),
   MYSQL_SYSVAR(log_buffer_size),
@@ -21973,6 +22158,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_persistent_sample_pages),
   MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(btree_optimistic_descent),
   MYSQL_SYSVAR(adaptive_hash_index_parts),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
@@ -22604,11 +22790,15 @@ bool ha_innobase::is_record_buffer_wanted(ha_rows* const max_rows) const
 		return false;
 	}
 
-	/* Limit the number of rows in the buffer to 100 for now. We may want
-	to fine-tune this later, possibly taking record size and page size into
-	account. The optimizer might allocate an even smaller buffer if it
+	/* Ask for at least 100 rows, and for short rows enough of them to
+	hold a full page worth of records, so that a range scan converts
+	the rows of a leaf page in one row_search_mvcc() call instead of
+	repositioning the cursor every 100 rows. The optimizer caps the
+	total buffer size, and might allocate an even smaller buffer if it
 	thinks a smaller number of rows will be fetched. */
-	*max_rows = 100;
+	const ulint	row_len = std::max<ulint>(m_prebuilt->mysql_row_len, 1);
+
+	*max_rows = std::max<ha_rows>(100, UNIV_PAGE_SIZE / row_len);
 	return true;
 }
 
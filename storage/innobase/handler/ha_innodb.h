@@ -237,6 +237,11 @@ public:
 		key_range*		min_key,
 		key_range*		max_key);
 
+	void records_in_ranges(
+		uint			inx,
+		Range_estimate*		ranges,
+		uint			n_ranges);
+
 	ha_rows estimate_rows_upper_bound();
 
 	void update_create_info(HA_CREATE_INFO* create_info);
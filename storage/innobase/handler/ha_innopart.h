@@ -545,6 +545,21 @@ public:
 		key_range*	min_key,
 		key_range*	max_key);
 
+	/** Estimates the number of index records in each of a sequence of
+	ranges, calling records_in_range() for every range, since the ranges
+	span the partitions.
+	@param[in]	inx		Index number.
+	@param[in,out]	ranges		The ranges.
+	@param[in]	n_ranges	Number of ranges. */
+	void
+	records_in_ranges(
+		uint		inx,
+		Range_estimate*	ranges,
+		uint		n_ranges)
+	{
+		handler::records_in_ranges(inx, ranges, n_ranges);
+	}
+
 	ha_rows
 	estimate_rows_upper_bound();
 
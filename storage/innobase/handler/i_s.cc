@@ -7693,6 +7693,42 @@ static ST_FIELD_INFO	innodb_cached_indexes_fields_info[] =
 	 STRUCT_FLD(old_name,		""),
 	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
 
+#define CACHED_INDEXES_N_DIRTY_PAGES	3
+	{STRUCT_FLD(field_name,		"N_DIRTY_PAGES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define CACHED_INDEXES_N_PAGE_HITS	4
+	{STRUCT_FLD(field_name,		"N_PAGE_HITS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define CACHED_INDEXES_N_PAGE_MISSES	5
+	{STRUCT_FLD(field_name,		"N_PAGE_MISSES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define CACHED_INDEXES_N_EVICTED_PAGES	6
+	{STRUCT_FLD(field_name,		"N_EVICTED_PAGES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
 	END_OF_ST_FIELD_INFO
 };
 
@@ -7714,8 +7750,12 @@ i_s_fill_innodb_cached_indexes_row(
 
 	const index_id_t	idx_id(space_id, index_id);
 	const uint64_t		n = buf_stat_per_index->get(idx_id);
+	const uint64_t		n_evicted = buf_stat_per_index->get(
+		idx_id, buf_stat_per_index_t::EVICTED);
 
-	if (n == 0) {
+	/* Also show indexes whose pages were all evicted, so that their
+	eviction rate can be followed. */
+	if (n == 0 && n_evicted == 0) {
 		DBUG_RETURN(0);
 	}
 
@@ -7727,6 +7767,20 @@ i_s_fill_innodb_cached_indexes_row(
 
 	OK(fields[CACHED_INDEXES_N_CACHED_PAGES]->store(n, true));
 
+	OK(fields[CACHED_INDEXES_N_DIRTY_PAGES]->store(
+		   buf_stat_per_index->get(
+			   idx_id, buf_stat_per_index_t::DIRTY), true));
+
+	OK(fields[CACHED_INDEXES_N_PAGE_HITS]->store(
+		   buf_stat_per_index->get(
+			   idx_id, buf_stat_per_index_t::HITS), true));
+
+	OK(fields[CACHED_INDEXES_N_PAGE_MISSES]->store(
+		   buf_stat_per_index->get(
+			   idx_id, buf_stat_per_index_t::MISSES), true));
+
+	OK(fields[CACHED_INDEXES_N_EVICTED_PAGES]->store(n_evicted, true));
+
 	OK(schema_table_store_record(thd, table_to_fill));
 
 	DBUG_RETURN(0);
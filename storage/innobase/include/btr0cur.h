@@ -647,6 +647,27 @@ btr_estimate_n_rows_in_range(
 	const dtuple_t*	tuple2,
 	page_cur_mode_t	mode2);
 
+/** Estimates the number of rows in each of a sequence of index ranges,
+sorted on their start. Ranges that fall between the records of the leaf
+page reached by the previous dive are counted on that page, without a dive
+from the root.
+@param[in]	index		index
+@param[in]	n_ranges	number of ranges
+@param[in]	tuples1		range starts, may also be empty tuples
+@param[in]	modes1		search modes for the range starts
+@param[in]	tuples2		range ends, may also be empty tuples
+@param[in]	modes2		search modes for the range ends
+@param[out]	n_rows		estimated number of rows in each range */
+void
+btr_estimate_n_rows_in_ranges(
+	dict_index_t*		index,
+	ulint			n_ranges,
+	const dtuple_t* const*	tuples1,
+	const page_cur_mode_t*	modes1,
+	const dtuple_t* const*	tuples2,
+	const page_cur_mode_t*	modes2,
+	int64_t*		n_rows);
+
 /*******************************************************************//**
 Estimates the number of different key values in a given index, for
 each n-column prefix of the index where 1 <= n <= dict_index_get_n_unique(index).
@@ -886,6 +907,9 @@ extern ulint	btr_cur_n_non_sea_old;
 srv_refresh_innodb_monitor_stats().  Referenced by
 srv_printf_innodb_monitor(). */
 extern ulint	btr_cur_n_sea_old;
+/** Whether btr_cur_search_to_nth_level() may descend the non-leaf levels
+of the tree without latching them (innodb_btree_optimistic_descent). */
+extern bool	btr_cur_optimistic_descent;
 #endif /* !UNIV_HOTBACKUP */
 
 #ifdef UNIV_DEBUG
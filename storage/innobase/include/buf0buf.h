@@ -584,6 +584,30 @@ UNIV_INLINE
 ib_uint64_t
 buf_block_get_modify_clock(const buf_block_t* block);
 
+/** Start an unlatched (optimistic) read of a buffer frame. The caller
+must have buffer-fixed the block, and must call
+buf_block_optimistic_read_validate() before trusting anything that it
+read from the frame.
+@param[in]	block	buffer-fixed block
+@param[out]	version	latch version to pass to the validation
+@return false if the block is currently x- or sx-latched */
+UNIV_INLINE
+bool
+buf_block_optimistic_read_begin(
+	const buf_block_t*	block,
+	ulint*			version);
+
+/** Check that no x- or sx-latch was held on the block since the
+matching buf_block_optimistic_read_begin().
+@param[in]	block	buffer-fixed block
+@param[in]	version	value returned by buf_block_optimistic_read_begin()
+@return true if the frame contents that were read are consistent */
+UNIV_INLINE
+bool
+buf_block_optimistic_read_validate(
+	const buf_block_t*	block,
+	ulint			version);
+
 /** Increments the bufferfix count.
 @param[in]	file	file name
 @param[in]	line	line
@@ -1486,6 +1510,17 @@ public:
 					and buf_pool->flush_list_mutex. Hence
 					reads can happen while holding
 					any one of the two mutexes */
+	space_index_t	dirty_index_id;	/*!< if dirty_leaf, the index
+					that the page was accounted to as a
+					dirty leaf page in buf_stat_per_index
+					when it was added to the flush list.
+					The same index is decremented when the
+					page leaves the flush list, even if the
+					frame has been changed meanwhile.
+					Protected like oldest_modification */
+	bool		dirty_leaf;	/*!< true if the page was an index
+					leaf page when it was added to the
+					flush list */
 	/* @} */
 	/** @name LRU replacement algorithm fields
 	These fields are protected by both buf_pool->LRU_list_mutex and the
@@ -1578,6 +1613,14 @@ struct buf_block_t{
 					bufferfixed, or (2) the thread has an
 					x-latch on the block, or (3) the block
 					must belong to an intrinsic table */
+	volatile ulint	latch_version;	/*!< incremented every time an
+					x-latch or an sx-latch on the block is
+					released; together with the state of
+					the block lock this lets a reader
+					validate a frame that it read without
+					latching it (optimistic B-tree
+					descent); only modified by the holder
+					of the x- or sx-latch */
 	/* @} */
 	/** @name Hash search fields (unprotected)
 	NOTE that these fields are NOT protected by any semaphore! */
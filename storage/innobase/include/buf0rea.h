@@ -110,6 +110,23 @@ buf_read_ahead_linear(
 	const page_size_t&	page_size,
 	ibool			inside_ibuf);
 
+/** Issues asynchronous read requests for the pages that directly follow
+a page in the tablespace. This is meant for page chains that are usually
+allocated in ascending page number order, such as the pages of an
+externally stored column, when the caller knows how many more pages of
+the chain it is going to read. A wrong guess only costs a useless read.
+Does nothing if read-ahead is disabled or too many reads are pending.
+@param[in]	page_id		page id of the page being read
+@param[in]	page_size	page size
+@param[in]	n_pages		number of following pages to read; limited
+to the read-ahead area size and to the size of the tablespace
+@return number of page read requests issued */
+ulint
+buf_read_ahead_successors(
+	const page_id_t&	page_id,
+	const page_size_t&	page_size,
+	page_no_t		n_pages);
+
 /********************************************************************//**
 Issues read requests for pages which the ibuf module wants to read in, in
 order to contract the insert buffer tree. Technically, this function is like
@@ -28,6 +28,7 @@ Created May 22, 2015 Vasil Dimov
 
 #include "univ.i"
 
+#include "buf0types.h" /* buf_page_t */
 #include "dict0types.h" /* index_id_t, DICT_IBUF_ID_MIN */
 #include "fsp0sysspace.h" /* srv_tmp_space */
 #include "ibuf0ibuf.h" /* IBUF_SPACE_ID */
@@ -37,60 +38,91 @@ Created May 22, 2015 Vasil Dimov
 /** Per index buffer pool statistics - contains how many pages for each index
 are cached in the buffer pool(s). This is a key,value store where the key is
 the index id and the value is the number of pages in the buffer pool that
-belong to this index. */
+belong to this index. Besides the number of cached pages, a few more
+counters of the same index leaf pages are maintained: how many of them are
+dirty, how many were evicted and, if innodb_cached_indexes_access_stats is
+enabled, how many page requests were served from the buffer pool (hits) or
+had to read the page from disk (misses). */
 class buf_stat_per_index_t {
 public:
+	/** Kinds of per index counters. */
+	enum counter_t {
+		/** Number of leaf pages in the buffer pool(s) */
+		CACHED = 0,
+		/** Number of leaf pages in the flush list(s) */
+		DIRTY,
+		/** Number of leaf page requests served from memory */
+		HITS,
+		/** Number of leaf page requests that read the page */
+		MISSES,
+		/** Number of leaf pages evicted from the buffer pool(s) */
+		EVICTED,
+		/** Number of counter kinds, must be last */
+		N_COUNTERS
+	};
+
 	/** Constructor. */
 	buf_stat_per_index_t()
 	{
-		m_store = UT_NEW(ut_lock_free_hash_t(1024, true),
-				 mem_key_buf_stat_per_index_t);
+		for (ulint i = 0; i < N_COUNTERS; i++) {
+			m_store[i] = UT_NEW(ut_lock_free_hash_t(1024, true),
+					    mem_key_buf_stat_per_index_t);
+		}
 	}
 
 	/** Destructor. */
 	~buf_stat_per_index_t()
 	{
-		UT_DELETE(m_store);
+		for (ulint i = 0; i < N_COUNTERS; i++) {
+			UT_DELETE(m_store[i]);
+		}
 	}
 
-	/** Increment the number of pages for a given index with 1.
-	@param[in]	id	id of the index whose count to increment */
+	/** Increment a counter for a given index with 1.
+	@param[in]	id	id of the index whose count to increment
+	@param[in]	counter	which counter to increment */
 	void
 	inc(
-		const index_id_t&	id)
+		const index_id_t&	id,
+		counter_t		counter = CACHED)
 	{
 		if (should_skip(id)) {
 			return;
 		}
 
-		m_store->inc(id.conv_to_int());
+		m_store[counter]->inc(id.conv_to_int());
 	}
 
-	/** Decrement the number of pages for a given index with 1.
-	@param[in]	id	id of the index whose count to decrement */
+	/** Decrement a counter for a given index with 1.
+	@param[in]	id	id of the index whose count to decrement
+	@param[in]	counter	which counter to decrement */
 	void
 	dec(
-		const index_id_t&	id)
+		const index_id_t&	id,
+		counter_t		counter = CACHED)
 	{
 		if (should_skip(id)) {
 			return;
 		}
 
-		m_store->dec(id.conv_to_int());
+		m_store[counter]->dec(id.conv_to_int());
 	}
 
-	/** Get the number of pages in the buffer pool for a given index.
+	/** Get a counter for a given index, by default the number of
+	its pages in the buffer pool.
 	@param[in]	id	id of the index whose pages to peek
-	@return number of pages */
+	@param[in]	counter	which counter to get
+	@return value of the counter */
 	uint64_t
 	get(
-		const index_id_t&	id)
+		const index_id_t&	id,
+		counter_t		counter = CACHED)
 	{
 		if (should_skip(id)) {
 			return(0);
 		}
 
-		const int64_t	ret = m_store->get(id.conv_to_int());
+		const int64_t	ret = m_store[counter]->get(id.conv_to_int());
 
 		if (ret == ut_lock_free_hash_t::NOT_FOUND) {
 			/* If the index is not found in this structure,
@@ -98,7 +130,17 @@ public:
 			return(0);
 		}
 
-		return(static_cast<uint64_t>(ret >= 0 ? ret : 0));
+		/* The number of cached pages is decremented with the
+		index id and level read from the frame on eviction, which
+		may differ from those it was incremented with, so it may
+		drift below zero. The other counters are exact. */
+		ut_ad(counter == CACHED || ret >= 0);
+
+		if (counter == CACHED && ret < 0) {
+			return(0);
+		}
+
+		return(static_cast<uint64_t>(ret));
 	}
 
 private:
@@ -115,10 +157,19 @@ private:
 		       || (id.m_index_id & 0xFFFFFFFF00000000ULL) != 0);
 	}
 
-	/** (key, value) storage. */
-	ut_lock_free_hash_t*	m_store;
+	/** (key, value) storage, one per counter kind. */
+	ut_lock_free_hash_t*	m_store[N_COUNTERS];
 };
 
+/** Get the index of a buffer pool page, if it is an index leaf page.
+@param[in]	bpage	page whose frame (or compressed frame) to inspect
+@param[out]	id	index of the page
+@return true if the page is an index leaf page */
+bool
+buf_stat_per_index_leaf(
+	const buf_page_t*	bpage,
+	index_id_t*		id);
+
 /** Container for how many pages from each index are contained in the buffer
 pool(s). */
 extern buf_stat_per_index_t*	buf_stat_per_index;
@@ -1405,7 +1405,10 @@ struct Reader
 	:
 	m_rctx(ctx),
 	m_cur_block(NULL),
-	m_copied_len(0)
+	m_copied_len(0),
+	m_prev_page_no(FIL_NULL),
+	m_read_ahead_end(0),
+	m_read_ahead(true)
 	{}
 
 	/** Fetch the complete or prefix of the uncompressed LOB data.
@@ -1415,6 +1418,10 @@ struct Reader
 	/** Fetch one BLOB page. */
 	void fetch_page();
 
+	/** Issue asynchronous reads for the pages that are expected to
+	follow the current page in the BLOB page chain. */
+	void read_ahead();
+
 	ReadContext	m_rctx;
 
 	/** Buffer block of the current BLOB page */
@@ -1424,6 +1431,16 @@ struct Reader
 	LOB pages. This is a cumulative value.  When this value reaches
 	m_rctx.m_len, then the read operation is completed. */
 	ulint		m_copied_len;
+
+	/** Page number of the previously fetched BLOB page. */
+	page_no_t	m_prev_page_no;
+
+	/** Page number up to which (exclusive) read-ahead was issued. */
+	page_no_t	m_read_ahead_end;
+
+	/** false once the BLOB page chain was found not to be laid out
+	in ascending page number order. */
+	bool		m_read_ahead;
 };
 
 /** The context information when the delete operation on LOB is
@@ -0,0 +1,64 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/row0pread.h
+Parallel read of the clustered index
+
+*******************************************************/
+
+#ifndef row0pread_h
+#define row0pread_h
+
+#include "univ.i"
+#include "db0err.h"
+#include "dict0types.h"
+
+struct row_prebuilt_t;
+
+/** Maximum value of innodb_parallel_read_threads */
+constexpr ulint	PARALLEL_READ_MAX_THREADS = 256;
+
+/** Count the records of a clustered index that are visible in the
+consistent read view of the transaction. The index is split into key
+ranges at the node pointers of its upper levels, and the ranges are
+scanned by up to n_threads threads, including the calling thread.
+The caller must not need record locks, that is the read is a
+non-locking consistent read.
+@param[in,out]	prebuilt	prebuilt struct in MySQL handle
+@param[in]	index		clustered index
+@param[in]	n_threads	maximum number of threads to use
+@param[out]	n_rows		number of records visible
+@return DB_SUCCESS or DB_INTERRUPTED */
+dberr_t
+row_count_parallel(
+	row_prebuilt_t*	prebuilt,
+	dict_index_t*	index,
+	ulint		n_threads,
+	ulint*		n_rows);
+
+/** Create the pool of threads that help row_count_parallel(). No thread
+is started until a parallel read needs one. */
+void
+row_pread_pool_create();
+
+/** Stop the threads of the parallel read pool, and free the pool. */
+void
+row_pread_pool_close();
+
+#endif /* row0pread_h */
@@ -343,6 +343,8 @@ enum monitor_id_t {
 	MONITOR_INDEX_REORG_ATTEMPTS,
 	MONITOR_INDEX_REORG_SUCCESSFUL,
 	MONITOR_INDEX_DISCARD,
+	MONITOR_INDEX_OPTIMISTIC_DESCENT,
+	MONITOR_INDEX_OPTIMISTIC_DESCENT_FAILED,
 
 	/* Adaptive Hash Index related counters */
 	MONITOR_MODULE_ADAPTIVE_HASH,
@@ -155,6 +155,9 @@ extern os_event_t	srv_buf_dump_event;
 /** The buffer pool resize thread waits on this event. */
 extern os_event_t	srv_buf_resize_event;
 
+/** The undo tablespace truncate thread waits on this event. */
+extern os_event_t	srv_undo_truncate_event;
+
 /** The buffer pool dump/load file name */
 #define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
 extern char*		srv_buf_dump_filename;
@@ -312,6 +315,8 @@ extern ulint	srv_buf_pool_base_size;
 extern long long	srv_buf_pool_curr_size;
 /** Dump this % of each buffer pool during BP dump */
 extern ulong	srv_buf_pool_dump_pct;
+/** Count buffer pool hits and misses of index leaf pages per index */
+extern bool	srv_cached_indexes_access_stats;
 /** Lock table size in bytes */
 extern ulint	srv_lock_table_size;
 
@@ -404,6 +409,9 @@ extern ibool	srv_buf_dump_thread_active;
 /* true during the lifetime of the buffer pool resize thread */
 extern bool	srv_buf_resize_thread_active;
 
+/* true during the lifetime of the undo tablespace truncate thread */
+extern bool	srv_undo_truncate_thread_active;
+
 /* true during the lifetime of the stats thread */
 extern bool	srv_dict_stats_thread_active;
 
@@ -442,6 +450,10 @@ extern const char* srv_io_thread_function[];
 /* the number of purge threads to use from the worker pool (currently 0 or 1) */
 extern ulong srv_n_purge_threads;
 
+/** Maximum number of threads in the pool of parallel read workers,
+see row_count_parallel() */
+extern ulong srv_parallel_read_worker_threads;
+
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
@@ -479,6 +491,7 @@ extern mysql_pfs_key_t	io_read_thread_key;
 extern mysql_pfs_key_t	io_write_thread_key;
 extern mysql_pfs_key_t	page_flush_coordinator_thread_key;
 extern mysql_pfs_key_t	page_flush_thread_key;
+extern mysql_pfs_key_t	parallel_read_thread_key;
 extern mysql_pfs_key_t	recv_writer_thread_key;
 extern mysql_pfs_key_t	srv_error_monitor_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
@@ -487,6 +500,7 @@ extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
 extern mysql_pfs_key_t	srv_worker_thread_key;
 extern mysql_pfs_key_t	trx_recovery_rollback_thread_key;
+extern mysql_pfs_key_t	undo_truncate_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
 #ifdef HAVE_PSI_STAGE_INTERFACE
@@ -359,6 +359,7 @@ enum latch_id_t {
 	LATCH_ID_PERSIST_AUTOINC,
 	LATCH_ID_DICT_PERSIST_CHECKPOINT,
 	LATCH_ID_PAGE_CLEANER,
+	LATCH_ID_PARALLEL_READ,
 	LATCH_ID_PURGE_SYS_PQ,
 	LATCH_ID_RECALC_POOL,
 	LATCH_ID_RECV_SYS,
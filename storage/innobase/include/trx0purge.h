@@ -36,6 +36,10 @@ Created 3/26/1996 Heikki Tuuri
 #include "fil0fil.h"
 #include "read0types.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 /** The global data structure coordinating a purge */
 extern trx_purge_t*	purge_sys;
 
@@ -115,6 +119,13 @@ purge_state_t
 trx_purge_state(void);
 /*=================*/
 
+/** This is the thread for truncating undo tablespaces. It waits for the
+purge coordinator to hand over an undo tablespace that is marked for
+truncate and whose rollback segments are all free, truncates it and
+makes its rollback segments available again. */
+void
+trx_purge_undo_truncate_thread();
+
 // Forward declaration
 struct TrxUndoRsegsIterator;
 
@@ -537,11 +548,30 @@ namespace undo {
 	/** Track an UNDO tablespace marked for truncate. */
 	class Truncate {
 	public:
+		/** Owner of the marked tablespace, and the outcome of
+		its truncate */
+		enum truncate_state_t {
+			/** The purge coordinator owns the marked
+			tablespace, if any */
+			NOT_TRUNCATING,
+
+			/** The undo truncate thread owns it */
+			TRUNCATING,
+
+			/** The undo truncate thread has truncated it and
+			made its rollback segments active again */
+			TRUNCATED,
+
+			/** The undo truncate thread could not truncate
+			it; its rollback segments stay inactive */
+			TRUNCATE_FAILED
+		};
 
 		Truncate()
 			:
 			m_space_id_marked(SPACE_UNKNOWN),
 			m_tablespace_marked(),
+			m_state(NOT_TRUNCATING),
 			m_purge_rseg_truncate_frequency(
 				static_cast<ulint>(
 				srv_purge_rseg_truncate_frequency))
@@ -608,6 +638,75 @@ namespace undo {
 				srv_purge_rseg_truncate_frequency);
 		}
 
+		/** Hand the marked tablespace over to the undo truncate
+		thread. Only the purge coordinator calls this. */
+		void hand_over()
+		{
+			ut_ad(is_marked());
+			ut_ad(m_state.load() == NOT_TRUNCATING);
+			m_state.store(TRUNCATING);
+		}
+
+		/** Give the marked tablespace back to the purge
+		coordinator. Only the undo truncate thread calls this, it
+		must not access the tracker afterwards.
+		@param[in]	state	NOT_TRUNCATING if the truncate was
+					not attempted, TRUNCATED or
+					TRUNCATE_FAILED */
+		void give_back(truncate_state_t state)
+		{
+			ut_ad(m_state.load() == TRUNCATING);
+			ut_ad(state != TRUNCATING);
+			m_state.store(state);
+		}
+
+		/** Take the marked tablespace back from the undo truncate
+		thread once it has tried to truncate it, and reset the
+		tracker for the next truncate. A tablespace that could not
+		be truncated is not marked again until restart. Only the
+		purge coordinator calls this. */
+		void take_back()
+		{
+			switch (m_state.load()) {
+			case NOT_TRUNCATING:
+			case TRUNCATING:
+				return;
+			case TRUNCATE_FAILED:
+				m_failed_space_ids.push_back(m_space_id_marked);
+				/* fall through */
+			case TRUNCATED:
+				reset();
+				m_state.store(NOT_TRUNCATING);
+			}
+		}
+
+		/** Check whether the marked tablespace is handed over to
+		the undo truncate thread.
+		@return true if the undo truncate thread owns the tablespace */
+		bool is_truncating() const
+		{
+			return(m_state.load() == TRUNCATING);
+		}
+
+		/** Get the tablespace ID that is being truncated by the
+		undo truncate thread. Only the purge coordinator calls this.
+		@return tablespace ID or SPACE_UNKNOWN if none */
+		space_id_t get_truncating_space_id() const
+		{
+			return(is_truncating()
+			       ? m_space_id_marked : SPACE_UNKNOWN);
+		}
+
+		/** Check whether the truncate of a tablespace has failed.
+		@param[in]	space_id	undo tablespace ID
+		@return true if the tablespace could not be truncated */
+		bool has_failed(space_id_t space_id) const
+		{
+			return(std::find(m_failed_space_ids.begin(),
+					 m_failed_space_ids.end(), space_id)
+			       != m_failed_space_ids.end());
+		}
+
 		/** Get the tablespace ID to start a scan.
 		@return	UNDO space_id to start scanning. */
 		space_id_t get_scan_space_id() const
@@ -647,6 +746,18 @@ namespace undo {
 		/** UNDO tablespace that is marked for truncate. */
 		undo::Tablespace*	m_tablespace_marked;
 
+		/** Owner of the marked tablespace. The other members are
+		only written by the purge coordinator. The undo truncate
+		thread reads them only between hand_over() and give_back(),
+		while the coordinator neither changes them nor marks
+		another tablespace. */
+		std::atomic<truncate_state_t>	m_state;
+
+		/** Undo tablespaces that could not be truncated. Their
+		rollback segments stay inactive until restart, when the
+		truncate is completed from the DDL log. */
+		std::vector<space_id_t>	m_failed_space_ids;
+
 		/** Rollback segment(s) purge frequency. This is local
 		value maintained along with global value. It is set to global
 		value on start but when tablespace is marked for truncate it
@@ -19,6 +19,7 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include <sys/types.h>
 
 #include "btr0pcur.h"
+#include "buf0rea.h"
 #include "fil0fil.h"
 #include "lob0fit.h"
 #include "lob0lob.h"
@@ -1230,6 +1231,46 @@ void Reader::fetch_page()
 	m_rctx.m_offset = FIL_PAGE_DATA;
 }
 
+/** Issue asynchronous reads for the pages that are expected to follow
+the current page in the BLOB page chain. The next page of a BLOB is
+allocated with the previous page number + 1 as the hint, so the chain
+is usually contiguous and the remaining length tells how many pages will
+be walked. Reading them ahead turns the page by page synchronous reads
+of a long chain into overlapping I/O. Read-ahead is stopped for this
+BLOB as soon as the chain is seen to be not contiguous. */
+void Reader::read_ahead()
+{
+	const page_no_t	page_no = m_rctx.m_page_no;
+
+	if (m_prev_page_no != FIL_NULL && page_no != m_prev_page_no + 1) {
+		m_read_ahead = false;
+	}
+
+	m_prev_page_no = page_no;
+
+	if (!m_read_ahead || page_no < m_read_ahead_end) {
+		return;
+	}
+
+	const ulint	payload = m_rctx.m_page_size.physical() - FIL_PAGE_DATA
+		- LOB_HDR_SIZE - FIL_PAGE_DATA_END;
+	const ulint	remaining = m_rctx.m_len - m_copied_len;
+
+	if (remaining <= payload) {
+		/* The current page is the last one to be read. */
+		return;
+	}
+
+	const page_id_t	page_id(m_rctx.m_space_id, page_no);
+	const page_no_t	n_pages = static_cast<page_no_t>(std::min<ulint>(
+		(remaining - 1) / payload,
+		BUF_READ_AHEAD_AREA(buf_pool_get(page_id))));
+
+	buf_read_ahead_successors(page_id, m_rctx.m_page_size, n_pages);
+
+	m_read_ahead_end = page_no + 1 + n_pages;
+}
+
 /** Fetch the complete or prefix of the uncompressed LOB data.
 @return bytes of LOB data fetched. */
 ulint	Reader::fetch()
@@ -1246,6 +1287,7 @@ ulint	Reader::fetch()
 			break;
 		}
 
+		read_ahead();
 		fetch_page();
 	}
 
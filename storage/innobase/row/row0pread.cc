@@ -0,0 +1,663 @@
+/*****************************************************************************
+
+Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file row/row0pread.cc
+Parallel read of the clustered index
+
+*******************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <system_error>
+#include <vector>
+
+#include "btr0btr.h"
+#include "btr0pcur.h"
+#include "dict0dict.h"
+#include "lock0lock.h"
+#include "os0event.h"
+#include "os0thread-create.h"
+#include "page0page.h"
+#include "read0types.h"
+#include "rem0cmp.h"
+#include "row0mysql.h"
+#include "row0pread.h"
+#include "row0vers.h"
+#include "srv0srv.h"
+#include "trx0trx.h"
+
+/** Number of key ranges to split the index into per thread, so that
+threads which finish early can take over ranges of the others. */
+static const ulint	PARALLEL_READ_RANGES_PER_THREAD = 4;
+
+/** Boundaries of the key ranges of a parallel read. The range i is
+[keys[i - 1], keys[i]), where keys[-1] is the start and keys[n] is the
+end of the index. */
+typedef std::vector<const dtuple_t*, ut_allocator<const dtuple_t*> >
+	pread_keys_t;
+
+/** Shared state of the threads of a parallel read. */
+struct pread_ctx_t {
+	/** Transaction doing the read */
+	trx_t*			trx;
+
+	/** Clustered index */
+	dict_index_t*		index;
+
+	/** Read view, or nullptr to read the latest version */
+	ReadView*		view;
+
+	/** Range boundaries */
+	const pread_keys_t*	keys;
+
+	/** Next range to scan */
+	std::atomic<ulint>	next_range;
+
+	/** Number of visible records counted */
+	std::atomic<ulint>	n_rows;
+
+	/** First error, or DB_SUCCESS */
+	std::atomic<int>	err;
+
+	/** Number of pool threads wanted, besides the calling thread */
+	ulint			n_helpers;
+
+	/** Number of pool threads reading ranges of this read,
+	protected by pread_pool_t::mutex */
+	ulint			n_running;
+
+	/** Set when n_running drops to 0 */
+	os_event_t		done;
+};
+
+/** Pool of threads that help row_count_parallel(). It has at most
+srv_parallel_read_worker_threads threads, which are started when they
+are first needed and exit at shutdown. */
+struct pread_pool_t {
+	typedef std::deque<pread_ctx_t*, ut_allocator<pread_ctx_t*> >
+		queue_t;
+
+	/** Protects the fields below, and pread_ctx_t::n_running */
+	ib_mutex_t		mutex;
+
+	/** Set when reads are queued, and at shutdown */
+	os_event_t		event;
+
+	/** Reads that want more threads than they have */
+	queue_t			queue;
+
+	/** Number of threads in the pool. An exiting thread decrements
+	it after releasing the mutex, as its last access to the pool. */
+	std::atomic<ulint>	n_threads;
+
+	/** Set by the last thread that exits at shutdown */
+	os_event_t		exited;
+
+	/** Number of threads waiting for a read */
+	ulint			n_idle;
+
+	/** true when the threads must exit */
+	bool			shutdown;
+};
+
+/** The pool of parallel read threads */
+static pread_pool_t*	pread_pool;
+
+/** Add the keys of the node pointers of non-leaf pages as range boundaries.
+The node pointer with the minimum record flag has no key, it starts the
+index.
+@param[in]	index	clustered index
+@param[in]	blocks	latched pages of the same level, in key order
+@param[in]	step	use every step-th node pointer
+@param[in,out]	heap	memory heap for the keys
+@param[in,out]	keys	range boundaries */
+static
+void
+row_pread_add_keys(
+	dict_index_t*				index,
+	const std::vector<buf_block_t*>&	blocks,
+	ulint					step,
+	mem_heap_t*				heap,
+	pread_keys_t&				keys)
+{
+	const ulint	n_fields = dict_index_get_n_unique_in_tree_nonleaf(
+		index);
+	const ulint	comp = dict_table_is_comp(index->table);
+	ulint		n = 0;
+
+	for (buf_block_t* block : blocks) {
+		page_cur_t	cur;
+
+		page_cur_set_before_first(block, &cur);
+		page_cur_move_to_next(&cur);
+
+		for (; !page_cur_is_after_last(&cur);
+		     page_cur_move_to_next(&cur)) {
+
+			rec_t*	rec = page_cur_get_rec(&cur);
+
+			if (rec_get_info_bits(rec, comp)
+			    & REC_INFO_MIN_REC_FLAG) {
+				continue;
+			}
+
+			if (++n % step != 0) {
+				continue;
+			}
+
+			/* Copy the key, the page latch is released
+			before the ranges are read. */
+			dtuple_t*	tuple = dict_index_build_data_tuple(
+				index, rec, n_fields, heap);
+
+			for (ulint i = 0; i < n_fields; ++i) {
+				dfield_dup(dtuple_get_nth_field(tuple, i),
+					   heap);
+			}
+
+			keys.push_back(tuple);
+		}
+	}
+}
+
+/** Split the clustered index into key ranges at the node pointers of the
+root page, or of the level below if the root has too few children.
+@param[in]	index		clustered index
+@param[in]	n_ranges	wanted number of ranges
+@param[in,out]	heap		memory heap for the keys
+@param[out]	keys		range boundaries */
+static
+void
+row_pread_split(
+	dict_index_t*	index,
+	ulint		n_ranges,
+	mem_heap_t*	heap,
+	pread_keys_t&	keys)
+{
+	mtr_t	mtr;
+
+	mtr_start(&mtr);
+
+	/* Prevent changes of the tree structure while the upper levels
+	are read. */
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
+
+	buf_block_t*	root = btr_root_block_get(index, RW_S_LATCH, &mtr);
+	const ulint	level = btr_page_get_level(
+		buf_block_get_frame(root), &mtr);
+
+	if (level > 0) {
+		std::vector<buf_block_t*>	blocks(1, root);
+		ulint				n_recs = page_get_n_recs(
+			buf_block_get_frame(root));
+
+		if (n_recs < n_ranges && level > 1) {
+			/* Read the node pointers of the children */
+			const page_size_t	page_size(
+				dict_table_page_size(index->table));
+			mem_heap_t*		offsets_heap = nullptr;
+			ulint*			offsets = nullptr;
+			page_cur_t		cur;
+
+			blocks.clear();
+			n_recs = 0;
+
+			page_cur_set_before_first(root, &cur);
+			page_cur_move_to_next(&cur);
+
+			for (; !page_cur_is_after_last(&cur);
+			     page_cur_move_to_next(&cur)) {
+
+				const rec_t*	rec = page_cur_get_rec(&cur);
+
+				offsets = rec_get_offsets(
+					rec, index, offsets, ULINT_UNDEFINED,
+					&offsets_heap);
+
+				buf_block_t*	block = btr_block_get(
+					page_id_t(dict_index_get_space(index),
+						  btr_node_ptr_get_child_page_no(
+							  rec, offsets)),
+					page_size, RW_S_LATCH, index, &mtr);
+
+				n_recs += page_get_n_recs(
+					buf_block_get_frame(block));
+
+				blocks.push_back(block);
+			}
+
+			if (offsets_heap != nullptr) {
+				mem_heap_free(offsets_heap);
+			}
+		}
+
+		row_pread_add_keys(index, blocks,
+				   std::max<ulint>(1, n_recs / n_ranges),
+				   heap, keys);
+	}
+
+	mtr_commit(&mtr);
+}
+
+/** Count the visible records of a key range.
+@param[in,out]	ctx	parallel read state
+@param[in]	low	start of the range, or nullptr
+@param[in]	high	end of the range (excluded), or nullptr
+@param[out]	n_rows	number of visible records
+@return DB_SUCCESS or DB_INTERRUPTED */
+static
+dberr_t
+row_pread_count_range(
+	pread_ctx_t*	ctx,
+	const dtuple_t*	low,
+	const dtuple_t*	high,
+	ulint*		n_rows)
+{
+	dict_index_t*	index = ctx->index;
+	const ulint	comp = dict_table_is_comp(index->table);
+	mem_heap_t*	offsets_heap = nullptr;
+	mem_heap_t*	vers_heap = mem_heap_create(UNIV_PAGE_SIZE);
+	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+	ulint*		offsets = offsets_;
+	dberr_t		err = DB_SUCCESS;
+	btr_pcur_t	pcur;
+	mtr_t		mtr;
+
+	rec_offs_init(offsets_);
+
+	*n_rows = 0;
+
+	mtr_start(&mtr);
+
+	if (low == nullptr) {
+		btr_pcur_open_at_index_side(
+			true, index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
+	} else {
+		btr_pcur_init(&pcur);
+		btr_pcur_open_with_no_init(
+			index, low, PAGE_CUR_GE, BTR_SEARCH_LEAF, &pcur, 0,
+			&mtr);
+	}
+
+	if (page_rec_is_infimum(btr_pcur_get_rec(&pcur))) {
+		btr_pcur_move_to_next_on_page(&pcur);
+	}
+
+	for (;;) {
+		const rec_t*	rec = btr_pcur_get_rec(&pcur);
+
+		if (page_rec_is_supremum(rec)) {
+
+			if (btr_pcur_is_after_last_in_tree(&pcur, &mtr)) {
+				break;
+			}
+
+			if (trx_is_interrupted(ctx->trx)) {
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+			/* Release the latches of the page and of the undo
+			pages read for it before reading the next page.
+			Store the cursor position on the last user record
+			of the page; leaf pages other than the root are
+			never empty. */
+			btr_pcur_move_to_prev_on_page(&pcur);
+			btr_pcur_store_position(&pcur, &mtr);
+			mtr_commit(&mtr);
+
+			mem_heap_empty(vers_heap);
+
+			mtr_start(&mtr);
+			btr_pcur_restore_position(
+				BTR_SEARCH_LEAF, &pcur, &mtr);
+
+			if (!btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+				break;
+			}
+
+			continue;
+		}
+
+		offsets = rec_get_offsets(
+			rec, index, offsets, ULINT_UNDEFINED, &offsets_heap);
+
+		if (high != nullptr
+		    && cmp_dtuple_rec(high, rec, index, offsets) <= 0) {
+			break;
+		}
+
+		if (ctx->view != nullptr
+		    && !lock_clust_rec_cons_read_sees(
+			    rec, index, offsets, ctx->view)) {
+
+			rec_t*	old_vers;
+
+			row_vers_build_for_consistent_read(
+				rec, &mtr, index, &offsets, ctx->view,
+				&offsets_heap, vers_heap, &old_vers, nullptr);
+
+			rec = old_vers;
+		}
+
+		if (rec != nullptr && !rec_get_deleted_flag(rec, comp)) {
+			++*n_rows;
+		}
+
+		btr_pcur_move_to_next_on_page(&pcur);
+	}
+
+	mtr_commit(&mtr);
+	btr_pcur_close(&pcur);
+
+	mem_heap_free(vers_heap);
+
+	if (offsets_heap != nullptr) {
+		mem_heap_free(offsets_heap);
+	}
+
+	return(err);
+}
+
+/** Scan ranges until there are none left or an error occurs.
+@param[in,out]	ctx	parallel read state */
+static
+void
+row_pread_worker(
+	pread_ctx_t*	ctx)
+{
+	const pread_keys_t&	keys = *ctx->keys;
+
+	while (ctx->err.load() == DB_SUCCESS) {
+		const ulint	i = ctx->next_range.fetch_add(1);
+
+		if (i > keys.size()) {
+			break;
+		}
+
+		ulint		n_rows;
+		const dberr_t	err = row_pread_count_range(
+			ctx, i == 0 ? nullptr : keys[i - 1],
+			i == keys.size() ? nullptr : keys[i], &n_rows);
+
+		if (err != DB_SUCCESS) {
+			int	expected = DB_SUCCESS;
+
+			ctx->err.compare_exchange_strong(expected, err);
+			break;
+		}
+
+		ctx->n_rows.fetch_add(n_rows);
+	}
+}
+
+/** Thread of the parallel read pool: help the queued reads until
+shutdown. */
+static
+void
+row_pread_thread()
+{
+	mutex_enter(&pread_pool->mutex);
+
+	while (!pread_pool->shutdown) {
+
+		if (pread_pool->queue.empty()) {
+			++pread_pool->n_idle;
+
+			const int64_t	sig_count = os_event_reset(
+				pread_pool->event);
+
+			mutex_exit(&pread_pool->mutex);
+
+			os_event_wait_low(pread_pool->event, sig_count);
+
+			mutex_enter(&pread_pool->mutex);
+
+			--pread_pool->n_idle;
+			continue;
+		}
+
+		pread_ctx_t*	ctx = pread_pool->queue.front();
+
+		if (++ctx->n_running == ctx->n_helpers) {
+			pread_pool->queue.pop_front();
+		}
+
+		mutex_exit(&pread_pool->mutex);
+
+		row_pread_worker(ctx);
+
+		mutex_enter(&pread_pool->mutex);
+
+		/* The caller frees ctx once this is 0. */
+		if (--ctx->n_running == 0) {
+			os_event_set(ctx->done);
+		}
+	}
+
+	mutex_exit(&pread_pool->mutex);
+
+	/* The pool is freed once the last thread has set the event. */
+	os_event_t	exited = pread_pool->exited;
+
+	if (pread_pool->n_threads.fetch_sub(1) == 1) {
+		os_event_set(exited);
+	}
+}
+
+/** Queue a read for the threads of the pool, and start threads for it
+up to srv_parallel_read_worker_threads.
+@param[in,out]	ctx	parallel read state */
+static
+void
+row_pread_pool_submit(
+	pread_ctx_t*	ctx)
+{
+	mutex_enter(&pread_pool->mutex);
+
+	ut_ad(!pread_pool->shutdown);
+
+	pread_pool->queue.push_back(ctx);
+
+	/* Start threads for the part of the read that the idle threads
+	will not take. */
+	for (ulint i = pread_pool->n_idle;
+	     i < ctx->n_helpers
+	     && pread_pool->n_threads < srv_parallel_read_worker_threads;
+	     ++i) {
+
+		try {
+			os_thread_create(
+				parallel_read_thread_key, row_pread_thread);
+		} catch (const std::system_error&) {
+			/* The ranges are read by the threads already
+			started, or by the calling thread alone. */
+			break;
+		}
+
+		++pread_pool->n_threads;
+	}
+
+	os_event_set(pread_pool->event);
+
+	mutex_exit(&pread_pool->mutex);
+}
+
+/** Remove a read from the queue of the pool, and wait for the threads
+of the pool that are reading its ranges.
+@param[in,out]	ctx	parallel read state */
+static
+void
+row_pread_pool_wait(
+	pread_ctx_t*	ctx)
+{
+	mutex_enter(&pread_pool->mutex);
+
+	pread_pool_t::queue_t&	queue = pread_pool->queue;
+	auto			it = std::find(queue.begin(), queue.end(), ctx);
+
+	if (it != queue.end()) {
+		queue.erase(it);
+	}
+
+	while (ctx->n_running > 0) {
+		const int64_t	sig_count = os_event_reset(ctx->done);
+
+		mutex_exit(&pread_pool->mutex);
+
+		os_event_wait_low(ctx->done, sig_count);
+
+		mutex_enter(&pread_pool->mutex);
+	}
+
+	mutex_exit(&pread_pool->mutex);
+}
+
+/** Create the pool of parallel read threads. No thread is started. */
+void
+row_pread_pool_create()
+{
+	pread_pool = UT_NEW_NOKEY(pread_pool_t());
+
+	mutex_create(LATCH_ID_PARALLEL_READ, &pread_pool->mutex);
+
+	pread_pool->event = os_event_create(0);
+	pread_pool->exited = os_event_create(0);
+	pread_pool->n_threads = 0;
+	pread_pool->n_idle = 0;
+	pread_pool->shutdown = false;
+}
+
+/** Stop the threads of the pool of parallel read threads, and free
+the pool. */
+void
+row_pread_pool_close()
+{
+	if (pread_pool == nullptr) {
+		return;
+	}
+
+	mutex_enter(&pread_pool->mutex);
+
+	ut_ad(pread_pool->queue.empty());
+
+	pread_pool->shutdown = true;
+
+	/* No thread is started after this, as no read is submitted. */
+	const bool	has_threads = pread_pool->n_threads > 0;
+
+	os_event_set(pread_pool->event);
+
+	mutex_exit(&pread_pool->mutex);
+
+	/* Wait until the threads no longer access the pool. */
+	if (has_threads) {
+		os_event_wait(pread_pool->exited);
+	}
+
+	os_event_destroy(pread_pool->exited);
+	os_event_destroy(pread_pool->event);
+
+	mutex_free(&pread_pool->mutex);
+
+	UT_DELETE(pread_pool);
+
+	pread_pool = nullptr;
+}
+
+/** Count the records of a clustered index that are visible in the
+consistent read view of the transaction.
+@param[in,out]	prebuilt	prebuilt struct in MySQL handle
+@param[in]	index		clustered index
+@param[in]	n_threads	maximum number of threads to use
+@param[out]	n_rows		number of records visible
+@return DB_SUCCESS or DB_INTERRUPTED */
+dberr_t
+row_count_parallel(
+	row_prebuilt_t*	prebuilt,
+	dict_index_t*	index,
+	ulint		n_threads,
+	ulint*		n_rows)
+{
+	trx_t*		trx = prebuilt->trx;
+
+	ut_ad(index->is_clustered());
+	ut_ad(prebuilt->select_lock_type == LOCK_NONE);
+	ut_ad(!index->table->is_temporary());
+
+	trx_start_if_not_started(trx, false);
+
+	if (prebuilt->sql_stat_start) {
+		/* Assign a read view for the statement, as
+		row_search_mvcc() does for a consistent read. */
+		if (!srv_read_only_mode) {
+			trx_assign_read_view(trx);
+		}
+
+		prebuilt->sql_stat_start = FALSE;
+	}
+
+	mem_heap_t*	heap = mem_heap_create(1024);
+	pread_keys_t	keys;
+	pread_ctx_t	ctx;
+
+	row_pread_split(
+		index, n_threads * PARALLEL_READ_RANGES_PER_THREAD, heap,
+		keys);
+
+	ctx.trx = trx;
+	ctx.index = index;
+	/* Like row_search_mvcc(), read the latest version if there is
+	no read view or the isolation level is READ UNCOMMITTED. */
+	ctx.view = srv_read_only_mode
+		|| trx->isolation_level == TRX_ISO_READ_UNCOMMITTED
+		? nullptr : trx->read_view;
+	ctx.keys = &keys;
+	ctx.next_range = 0;
+	ctx.n_rows = 0;
+	ctx.err = DB_SUCCESS;
+
+	/* The calling thread reads ranges too, so the read completes
+	even if the pool has no thread to spare. */
+	ctx.n_helpers = std::min(
+		n_threads, static_cast<ulint>(keys.size() + 1)) - 1;
+	ctx.n_running = 0;
+	ctx.done = nullptr;
+
+	if (ctx.n_helpers > 0 && srv_parallel_read_worker_threads > 0) {
+		ctx.done = os_event_create(0);
+
+		row_pread_pool_submit(&ctx);
+	}
+
+	row_pread_worker(&ctx);
+
+	if (ctx.done != nullptr) {
+		row_pread_pool_wait(&ctx);
+
+		os_event_destroy(ctx.done);
+	}
+
+	mem_heap_free(heap);
+
+	*n_rows = ctx.n_rows.load();
+
+	return(static_cast<dberr_t>(ctx.err.load()));
+}
@@ -1030,6 +1030,18 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_INDEX_DISCARD},
 
+	{"index_optimistic_descents", "index",
+	 "Number of B-tree searches that reached the leaf without latching"
+	 " the non-leaf pages",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_INDEX_OPTIMISTIC_DESCENT},
+
+	{"index_optimistic_descent_failures", "index",
+	 "Number of optimistic B-tree searches that detected a concurrent"
+	 " modification and were retried with latches",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_INDEX_OPTIMISTIC_DESCENT_FAILED},
+
 	/* ========== Counters for Adaptive Hash Index ========== */
 	{"module_adaptive_hash", "adaptive_hash_index", "Adpative Hash Index",
 	 MONITOR_MODULE,
@@ -62,6 +62,7 @@ Created 10/8/1995 Heikki Tuuri
 #include "pars0pars.h"
 #include "que0que.h"
 #include "row0mysql.h"
+#include "row0pread.h"
 #include "sql_thd_internal_api.h"
 #include "srv0mon.h"
 #include "srv0srv.h"
@@ -94,6 +95,8 @@ ibool	srv_buf_dump_thread_active = FALSE;
 
 bool	srv_buf_resize_thread_active = false;
 
+bool	srv_undo_truncate_thread_active = false;
+
 bool	srv_dict_stats_thread_active = false;
 
 const char*	srv_main_thread_op_info = "";
@@ -259,6 +262,8 @@ ulint	srv_buf_pool_base_size	= 0;
 long long	srv_buf_pool_curr_size	= 0;
 /** Dump this % of each buffer pool during BP dump */
 ulong	srv_buf_pool_dump_pct;
+/** Count buffer pool hits and misses of index leaf pages per index */
+bool	srv_cached_indexes_access_stats	= false;
 /** Lock table size in bytes */
 ulint	srv_lock_table_size	= ULINT_MAX;
 
@@ -311,6 +316,10 @@ ulong	srv_flushing_avg_loops		= 30;
 /* The number of purge threads to use.*/
 ulong	srv_n_purge_threads = 4;
 
+/** Maximum number of threads in the pool of parallel read workers,
+see row_count_parallel() */
+ulong	srv_parallel_read_worker_threads = 16;
+
 /* the number of pages to purge in one batch */
 ulong	srv_purge_batch_size = 20;
 
@@ -586,6 +595,9 @@ os_event_t	srv_buf_dump_event;
 /** Event to signal the buffer pool resize thread */
 os_event_t	srv_buf_resize_event;
 
+/** Event to signal the undo tablespace truncate thread */
+os_event_t	srv_undo_truncate_event;
+
 /** The buffer pool dump/load file name */
 char*	srv_buf_dump_filename;
 
@@ -1002,6 +1014,8 @@ srv_init(void)
 
 		srv_buf_dump_event = os_event_create(0);
 
+		srv_undo_truncate_event = os_event_create(0);
+
 		buf_flush_event = os_event_create("buf_flush_event");
 
 		UT_LIST_INIT(srv_sys->tasks, &que_thr_t::queue);
@@ -1055,6 +1069,7 @@ srv_free(void)
 		os_event_destroy(srv_error_event);
 		os_event_destroy(srv_monitor_event);
 		os_event_destroy(srv_buf_dump_event);
+		os_event_destroy(srv_undo_truncate_event);
 		os_event_destroy(buf_flush_event);
 	}
 
@@ -1087,6 +1102,7 @@ srv_general_init(void)
 	trx_pool_init();
 	que_init();
 	row_mysql_init();
+	row_pread_pool_create();
 }
 
 /*********************************************************************//**
@@ -2937,8 +2953,13 @@ srv_purge_coordinator_thread()
 	purge_sys->state = PURGE_STATE_EXIT;
 
 	/* Clear out any pending undo-tablespaces to truncate and reset
-	the list as we plan to shutdown the purge thread. */
-	purge_sys->undo_trunc.reset();
+	the list as we plan to shutdown the purge thread. A tablespace
+	owned by the undo truncate thread is left to it; that thread
+	does not exit before it has truncated the tablespace, see
+	trx_purge_undo_truncate_thread(). */
+	if (!purge_sys->undo_trunc.is_truncating()) {
+		purge_sys->undo_trunc.reset();
+	}
 
 	purge_sys->running = false;
 
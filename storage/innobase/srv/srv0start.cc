@@ -73,6 +73,7 @@ Created 2/16/1996 Heikki Tuuri
 #include "page0page.h"
 #include "rem0rec.h"
 #include "row0ftsort.h"
+#include "row0pread.h"
 #include "srv0srv.h"
 #include "srv0start.h"
 #include "trx0sys.h"
@@ -196,6 +197,7 @@ mysql_pfs_key_t	io_ibuf_thread_key;
 mysql_pfs_key_t	io_log_thread_key;
 mysql_pfs_key_t	io_read_thread_key;
 mysql_pfs_key_t	io_write_thread_key;
+mysql_pfs_key_t	parallel_read_thread_key;
 mysql_pfs_key_t	srv_error_monitor_thread_key;
 mysql_pfs_key_t	srv_lock_timeout_thread_key;
 mysql_pfs_key_t	srv_master_thread_key;
@@ -203,6 +205,7 @@ mysql_pfs_key_t	srv_monitor_thread_key;
 mysql_pfs_key_t	srv_purge_thread_key;
 mysql_pfs_key_t	srv_worker_thread_key;
 mysql_pfs_key_t	trx_recovery_rollback_thread_key;
+mysql_pfs_key_t	undo_truncate_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
 #ifdef HAVE_PSI_STAGE_INTERFACE
@@ -2877,6 +2880,16 @@ srv_start_purge_threads()
 
 	srv_start_wait_for_purge_to_start();
 
+	/* The purge coordinator hands undo tablespaces that are marked
+	for truncate over to this thread. The flag is set before the
+	thread is created, so that shutdown waits for it even if it has
+	not started running yet. */
+	srv_undo_truncate_thread_active = true;
+
+	os_thread_create(
+		undo_truncate_thread_key,
+		trx_purge_undo_truncate_thread);
+
 	srv_start_state_set(SRV_START_STATE_PURGE);
 }
 
@@ -3031,6 +3044,17 @@ srv_pre_dd_shutdown()
 			}
 		}
 
+		if (srv_undo_truncate_thread_active) {
+			wait = true;
+
+			os_event_set(srv_undo_truncate_event);
+
+			if (srv_print_verbose_log && ((count % 600) == 0)) {
+				ib::info() << "Waiting for undo_truncate_thread"
+					" to exit";
+			}
+		}
+
 		if (srv_dict_stats_thread_active) {
 			wait = true;
 
@@ -3076,6 +3100,7 @@ srv_shutdown()
 	}
 
 	/* 2. Make all threads created by InnoDB to exit */
+	row_pread_pool_close();
 	srv_shutdown_all_bg_threads();
 
 	if (srv_monitor_file) {
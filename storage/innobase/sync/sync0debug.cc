@@ -1458,6 +1458,9 @@ sync_latch_meta_init()
 	LATCH_ADD_MUTEX(PAGE_CLEANER, SYNC_PAGE_CLEANER,
 			page_cleaner_mutex_key);
 
+	LATCH_ADD_MUTEX(PARALLEL_READ, SYNC_NO_ORDER_CHECK,
+			parallel_read_mutex_key);
+
 	LATCH_ADD_MUTEX(PURGE_SYS_PQ, SYNC_PURGE_QUEUE,
 			purge_sys_pq_mutex_key);
 
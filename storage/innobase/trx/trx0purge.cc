@@ -36,6 +36,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "my_compiler.h"
 #include "my_dbug.h"
 #include "my_inttypes.h"
+#include "os0thread-create.h"
 #include "os0thread.h"
 #include "que0que.h"
 #include "read0read.h"
@@ -976,6 +977,36 @@ namespace undo {
 /* Declare this global object. */
 Space_Ids	undo::s_under_construction;
 
+/** Check whether an undo tablespace other than the given one is active,
+so that new transactions still find rollback segments while the given
+one is truncated. It may not be the case if a truncate failed.
+@param[in]	space_id	undo tablespace ID
+@return true if another undo tablespace is active */
+static
+bool
+trx_purge_other_undo_space_active(
+	space_id_t	space_id)
+{
+	for (auto undo_space : undo::spaces->m_spaces) {
+
+		if (undo_space->id() == space_id) {
+			continue;
+		}
+
+		undo_space->rsegs()->s_lock();
+
+		const bool	active = undo_space->rsegs()->is_active();
+
+		undo_space->rsegs()->s_unlock();
+
+		if (active) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
 /** Iterate over all the UNDO tablespaces and check if any of the UNDO
 tablespace qualifies for TRUNCATE (size > threshold).
 @param[in,out]	undo_trunc	undo truncate tracker */
@@ -1007,7 +1038,9 @@ trx_purge_mark_undo_for_truncate(
 	space_id_t first_space_id_scanned = space_id;
 	do {
 		if (fil_space_get_size(space_id)
-		    > (srv_max_undo_tablespace_size / srv_page_size)) {
+		    > (srv_max_undo_tablespace_size / srv_page_size)
+		    && !undo_trunc->has_failed(space_id)
+		    && trx_purge_other_undo_space_active(space_id)) {
 			/* Tablespace qualifies for truncate. */
 
 			undo_trunc->increment_scan();
@@ -1180,13 +1213,45 @@ trx_purge_initiate_truncate(
 		return;
 	}
 
-	/* Step-3: Start the actual truncate.
-	a. log-checkpoint
-	b. Write the DDL log to protect truncate action from CRASH
-	c. Remove rseg instance if added to purge queue before we
-	   initiate truncate.
-	d. Execute actual truncate
-	e. Remove the DDL log. */
+	/* Step-3: Remove rseg instances of the marked tablespace from the
+	purge queue and hand the tablespace over to the undo truncate
+	thread. The file is rebuilt there, so that purge keeps on running
+	with the rollback segments of the other undo tablespaces. */
+	trx_purge_cleanse_purge_queue(undo_trunc);
+
+	if (purge_sys->rseg != NULL
+	    && purge_sys->rseg->space_id
+	    == undo_trunc->get_marked_space_id()) {
+		/* If purge_sys->rseg is pointing to rseg that is about to
+		be truncated then move to next rseg element.
+		Note: Ideally purge_sys->rseg should be NULL because purge
+		should complete processing of all the records but there is
+		purge_batch_size that can force the purge loop to exit before
+		all the records are purged and in this case purge_sys->rseg
+		could point to a valid rseg waiting for next purge cycle. */
+		purge_sys->next_stored = FALSE;
+		purge_sys->rseg = NULL;
+	}
+
+	undo_trunc->hand_over();
+
+	os_event_set(srv_undo_truncate_event);
+}
+
+/** Truncate the undo tablespace handed over by the purge coordinator.
+a. log-checkpoint
+b. Write the DDL log to protect truncate action from CRASH
+c. Execute actual truncate
+d. Remove the DDL log.
+@param[in,out]	undo_trunc	undo truncate tracker */
+static
+void
+trx_purge_truncate_marked_undo(
+	undo::Truncate*	undo_trunc)
+{
+	ut_ad(undo_trunc->is_truncating());
+	ut_ad(undo_trunc->rsegs()->is_inactive());
+
 	DBUG_EXECUTE_IF("ib_undo_trunc_before_checkpoint",
 			ib::info() << "ib_undo_trunc_before_checkpoint";
 			DBUG_SUICIDE(););
@@ -1215,31 +1280,20 @@ trx_purge_initiate_truncate(
 			ib::info() << "ib_undo_trunc_before_truncate";
 			DBUG_SUICIDE(););
 
-	trx_purge_cleanse_purge_queue(undo_trunc);
-
-	bool	success = trx_undo_truncate_tablespace(undo_trunc);
+	bool	success = DBUG_EVALUATE_IF(
+		"ib_undo_trunc_fail_truncate", false,
+		trx_undo_truncate_tablespace(undo_trunc));
 	if (!success) {
-		/* Note: In case of error we don't enable the rsegs
-		and neither unmark the tablespace so the tablespace
-		continue to remain inactive. */
-		ib::error() << "Failed to truncate undo tablespace number"
+		/* Note: In case of error we don't enable the rsegs, so
+		the tablespace remains inactive. The purge coordinator
+		unmarks it and does not select it again until restart,
+		when the truncate is completed from the DDL log. */
+		ib::error() << "Failed to truncate undo tablespace number "
 			<< undo::id2num(undo_trunc->get_marked_space_id());
+		undo_trunc->give_back(undo::Truncate::TRUNCATE_FAILED);
 		return;
 	}
 
-	if (purge_sys->rseg != NULL
-	    && purge_sys->rseg->last_page_no == FIL_NULL) {
-		/* If purge_sys->rseg is pointing to rseg that was recently
-		truncated then move to next rseg element.
-		Note: Ideally purge_sys->rseg should be NULL because purge
-		should complete processing of all the records but there is
-		purge_batch_size that can force the purge loop to exit before
-		all the records are purged and in this case purge_sys->rseg
-		could point to a valid rseg waiting for next purge cycle. */
-		purge_sys->next_stored = FALSE;
-		purge_sys->rseg = NULL;
-	}
-
 	DBUG_EXECUTE_IF("ib_undo_trunc_before_ddl_log_end",
 			ib::info() << "ib_undo_trunc_before_ddl_log_end";
 			DBUG_SUICIDE(););
@@ -1256,10 +1310,12 @@ trx_purge_initiate_truncate(
 
 	marked_rsegs->set_active();
 
-	undo_trunc->reset();
-
 	marked_rsegs->x_unlock();
 
+	/* Give the purge coordinator the permission to unmark the
+	tablespace and to mark the next one. */
+	undo_trunc->give_back(undo::Truncate::TRUNCATED);
+
 	ib::info() << "Completed truncate of undo tablespace number "
 		<< undo::id2num(marked_space_id);
 
@@ -1268,6 +1324,64 @@ trx_purge_initiate_truncate(
 			DBUG_SUICIDE(););
 }
 
+/** This is the thread for truncating undo tablespaces. It waits for the
+purge coordinator to hand over an undo tablespace that is marked for
+truncate and whose rollback segments are all free, truncates it and
+makes its rollback segments available again. At shutdown it exits only
+once the purge coordinator has exited and no tablespace is handed over,
+so that a tablespace handed over during shutdown is truncated rather
+than left with inactive rollback segments. */
+void
+trx_purge_undo_truncate_thread()
+{
+	ut_ad(srv_undo_truncate_thread_active);
+	my_thread_init();
+
+	undo::Truncate*	undo_trunc = &purge_sys->undo_trunc;
+
+	for (;;) {
+		const int64_t	sig_count = os_event_reset(
+			srv_undo_truncate_event);
+
+		if (undo_trunc->is_truncating()) {
+
+			DBUG_EXECUTE_IF(
+				"ib_undo_trunc_wait_for_shutdown",
+				ib::info() << "ib_undo_trunc_wait_for_shutdown";
+				while (srv_shutdown_state
+				       == SRV_SHUTDOWN_NONE) {
+					os_thread_sleep(100000);
+				});
+
+			/* Don't truncate if concurrent clone in progress.
+			The purge coordinator hands the tablespace over
+			again on its next round. */
+			if (clone_mark_abort(false)) {
+
+				trx_purge_truncate_marked_undo(undo_trunc);
+				clone_mark_active();
+			} else {
+				undo_trunc->give_back(
+					undo::Truncate::NOT_TRUNCATING);
+			}
+
+			continue;
+		}
+
+		/* The coordinator hands nothing over once it has exited. */
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE
+		    && !srv_purge_threads_active()) {
+			break;
+		}
+
+		os_event_wait_low(srv_undo_truncate_event, sig_count);
+	}
+
+	srv_undo_truncate_thread_active = false;
+
+	my_thread_end();
+}
+
 /********************************************************************//**
 Removes unnecessary history data from rollback segments. NOTE that when this
 function is called, the caller must not have any latches on undo log pages! */
@@ -1278,8 +1392,6 @@ trx_purge_truncate_history(
 	purge_iter_t*		limit,		/*!< in: truncate limit */
 	const ReadView*		view)		/*!< in: purge view */
 {
-	ulint		i;
-
 	/* We play safe and set the truncate limit at most to the purge view
 	low_limit number, though this is not necessary */
 
@@ -1291,7 +1403,10 @@ trx_purge_truncate_history(
 
 	ut_ad(limit->trx_no <= purge_sys->view.low_limit_no());
 
-	/* Purge rollback segments in all undo tablespaces. */
+	/* Purge rollback segments in all undo tablespaces, except the
+	one that the undo truncate thread is rebuilding. */
+	space_id_t	truncating_space_id
+		= purge_sys->undo_trunc.get_truncating_space_id();
 	bool	undo_list_is_locked = false;
 	for (auto undo_space : undo::spaces->m_spaces) {
 		if (!undo_list_is_locked
@@ -1301,6 +1416,10 @@ trx_purge_truncate_history(
 			undo_list_is_locked = true;
 		}
 
+		if (undo_space->id() == truncating_space_id) {
+			continue;
+		}
+
 		/* Purge rollback segments in this undo tablespace.
 		Use an s-lock only for inactive rsegs. */
 		bool	rseg_list_is_locked = false;
@@ -1348,22 +1467,18 @@ trx_purge_truncate_history(
 		trx_sys->tmp_rsegs.s_unlock();
 	}
 
-	/* UNDO tablespace truncate. We will try to truncate as much as we
-	can (greedy approach). This will ensure when the server is idle we
-	try and truncate all the UNDO tablespaces. */
-	undo::spaces->s_lock();
-	ulint n_spaces = undo::spaces->size();
-	undo::spaces->s_unlock();
-	for (i = 0; i < n_spaces; i++) {
-		trx_purge_mark_undo_for_truncate(&purge_sys->undo_trunc);
+	/* UNDO tablespace truncate. The truncate itself is done by the
+	undo truncate thread, one tablespace at a time. Nothing is done
+	while it owns a tablespace. */
+	if (purge_sys->undo_trunc.is_truncating()) {
+		return;
+	}
 
-		/* Don't truncate if concurrent clone in progress. */
-		if (clone_mark_abort(false)) {
+	purge_sys->undo_trunc.take_back();
 
-			trx_purge_initiate_truncate(limit, &purge_sys->undo_trunc);
-			clone_mark_active();
-		}
-	}
+	trx_purge_mark_undo_for_truncate(&purge_sys->undo_trunc);
+
+	trx_purge_initiate_truncate(limit, &purge_sys->undo_trunc);
 }
 
 /***********************************************************************//**
@@ -0,0 +1,845 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA */
+
+/** @file storage/temptable/include/temptable/btree.h
+TempTable B+-tree container. */
+
+#ifndef TEMPTABLE_BTREE_H
+#define TEMPTABLE_BTREE_H
+
+#include <algorithm>   /* std::lower_bound(), std::upper_bound() */
+#include <cstddef>     /* size_t */
+#include <cstdint>     /* uint16_t */
+#include <cstring>     /* memcpy(), memmove() */
+#include <iterator>    /* std::bidirectional_iterator_tag */
+#include <type_traits> /* std::aligned_storage, std::is_trivially_copyable */
+
+#include "my_dbug.h"             /* DBUG_ASSERT() */
+#include "temptable/allocator.h" /* temptable::Allocator */
+#include "temptable/constants.h" /* temptable::INDEX_TREE_NODE_SIZE */
+
+namespace temptable {
+
+/** An ordered container that allows duplicates, like std::multiset, but
+ * implemented as a B+-tree. The elements are stored by value, next to each
+ * other, in leaf nodes of `INDEX_TREE_NODE_SIZE` bytes which are chained in a
+ * doubly linked list, so a scan touches a few cache lines per leaf instead of
+ * one heap node per element. Inner nodes store copies of the smallest element
+ * of each of their children but the first one, which are used to direct the
+ * searches.
+ *
+ * The elements must be trivially copyable because they are moved around with
+ * memmove() when nodes are split or elements are erased.
+ *
+ * Unlike std::multiset, inserting or erasing an element invalidates all
+ * iterators of the container, except the one returned by `insert()`. Nodes
+ * are not merged when they become underfull, only removed when they become
+ * empty. */
+template <class T, class Less>
+class Btree {
+ private:
+  struct Inner;
+
+  /** Part common to leaf and inner nodes. */
+  struct Node {
+    /** Parent node, nullptr for the root. */
+    Inner* m_parent;
+
+    /** Number of elements of a leaf, or number of children of an inner node. */
+    uint16_t m_count;
+
+    /** Whether this is a leaf node. */
+    bool m_is_leaf;
+  };
+
+  /** Type of the memory where an element is stored. */
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+ public:
+  /** Maximum number of elements in a leaf node. */
+  static constexpr size_t LEAF_CAPACITY =
+      (INDEX_TREE_NODE_SIZE - sizeof(Node) - 2 * sizeof(void*)) / sizeof(T);
+
+  /** Maximum number of children of an inner node. */
+  static constexpr size_t INNER_CAPACITY =
+      (INDEX_TREE_NODE_SIZE - sizeof(Node) + sizeof(T)) /
+      (sizeof(T) + sizeof(void*));
+
+ private:
+  /** Leaf node. */
+  struct Leaf : public Node {
+    /** Previous leaf in order, nullptr for the first one. */
+    Leaf* m_prev;
+
+    /** Next leaf in order, nullptr for the last one. */
+    Leaf* m_next;
+
+    /** Elements, [0, m_count) are used. */
+    Slot m_slots[LEAF_CAPACITY];
+
+    T* elements() { return reinterpret_cast<T*>(m_slots); }
+
+    const T* elements() const { return reinterpret_cast<const T*>(m_slots); }
+  };
+
+  /** Inner node. */
+  struct Inner : public Node {
+    /** Separators, m_keys[i] is a copy of the smallest element in the subtree
+     * of m_children[i + 1]. [0, m_count - 1) are used. */
+    Slot m_keys[INNER_CAPACITY - 1];
+
+    /** Children, [0, m_count) are used. */
+    Node* m_children[INNER_CAPACITY];
+
+    T* keys() { return reinterpret_cast<T*>(m_keys); }
+
+    const T* keys() const { return reinterpret_cast<const T*>(m_keys); }
+  };
+
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Btree elements are moved with memmove().");
+  static_assert(LEAF_CAPACITY >= 4 && INNER_CAPACITY >= 4,
+                "INDEX_TREE_NODE_SIZE is too small for the element type.");
+
+  /** Maximum height of the tree, more than enough given the fan out. */
+  static constexpr size_t MAX_HEIGHT = 32;
+
+ public:
+  /** Iterator over a Btree. All iterators are constant because modifying an
+   * element could break the order. */
+  class Iterator {
+   public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    /** Default constructor. This creates a hollow iterator object, that must
+     * be assigned afterwards. */
+    Iterator();
+
+    /** Dereference the iterator to the element it points to.
+     * @return the element where the iterator is positioned */
+    const T& operator*() const;
+
+    /** Access a member of the element the iterator points to.
+     * @return the element where the iterator is positioned */
+    const T* operator->() const;
+
+    /** Advance the iterator one element forward. If the iterator points to
+     * end() before this call, then the behavior is undefined.
+     * @return *this */
+    Iterator& operator++();
+
+    /** Recede the iterator one element backwards. If the iterator points to
+     * begin() before this call, then the behavior is undefined.
+     * @return *this */
+    Iterator& operator--();
+
+    /** Compare with another iterator over the same tree.
+     * @return true if positioned on the same element */
+    bool operator==(
+        /** [in] Iterator to compare with. */
+        const Iterator& rhs) const;
+
+    /** Compare with another iterator over the same tree.
+     * @return true if positioned on different elements */
+    bool operator!=(
+        /** [in] Iterator to compare with. */
+        const Iterator& rhs) const;
+
+   private:
+    friend class Btree;
+
+    /** Constructor. */
+    Iterator(
+        /** [in] Tree to iterate over. */
+        const Btree* tree,
+        /** [in] Leaf of the element, nullptr for end(). */
+        const Leaf* leaf,
+        /** [in] Position of the element within `leaf`. */
+        size_t pos);
+
+    /** Tree over which the iterator operates. */
+    const Btree* m_tree;
+
+    /** Current leaf, nullptr if the iterator is positioned after the last
+     * element. */
+    const Leaf* m_leaf;
+
+    /** Position within `m_leaf`. */
+    size_t m_pos;
+  };
+
+  typedef Iterator iterator;
+  typedef Iterator const_iterator;
+
+  /** Constructor. */
+  Btree(
+      /** [in] Comparator that defines the order of the elements. */
+      const Less& less,
+      /** [in] Allocator to allocate the nodes from. */
+      const Allocator<T>& allocator);
+
+  /** Copy constructing is disabled, not necessary. */
+  Btree(const Btree&) = delete;
+
+  /** Copy assignment is disabled, not necessary. */
+  Btree& operator=(const Btree&) = delete;
+
+  /** Destructor. */
+  ~Btree();
+
+  /** Get an iterator, positioned on the first element.
+   * @return iterator */
+  Iterator begin() const;
+
+  /** Get an iterator, positioned after the last element.
+   * @return iterator */
+  Iterator end() const;
+
+  /** Get the number of elements in the tree.
+   * @return number of elements */
+  size_t size() const;
+
+  /** Get the comparator of the tree.
+   * @return comparator */
+  const Less& key_comp() const;
+
+  /** Find the first element that is not less than `value`.
+   * @return iterator to the element or end() */
+  Iterator lower_bound(
+      /** [in] Value to search for. */
+      const T& value) const;
+
+  /** Find the first element that is greater than `value`.
+   * @return iterator to the element or end() */
+  Iterator upper_bound(
+      /** [in] Value to search for. */
+      const T& value) const;
+
+  /** Insert a copy of `value` after the elements that are equal to it. Throws
+   * `Result` if memory cannot be allocated, in which case the tree is not
+   * modified.
+   * @return iterator to the inserted element */
+  Iterator insert(
+      /** [in] Value to insert. */
+      const T& value);
+
+  /** Erase the element at `position`. */
+  void erase(
+      /** [in] Position of the element to erase, must not be end(). */
+      const Iterator& position);
+
+  /** Erase all elements and free all nodes. */
+  void clear();
+
+ private:
+  /** Descend from the root to the leaf where `value` belongs.
+   * @return leaf */
+  const Leaf* descend(
+      /** [in] Value to search for. */
+      const T& value,
+      /** [in] If true then go to the leaf of the last element equal to
+       * `value`, otherwise to the leaf of the first one. */
+      bool upper) const;
+
+  /** Create an iterator, moving to the next leaf if `pos` is past the last
+   * element of `leaf`.
+   * @return iterator */
+  Iterator make_iterator(
+      /** [in] Leaf. */
+      const Leaf* leaf,
+      /** [in] Position within `leaf`, at most `leaf->m_count`. */
+      size_t pos) const;
+
+  /** Allocate a leaf node.
+   * @return leaf */
+  Leaf* leaf_create();
+
+  /** Allocate an inner node.
+   * @return inner node */
+  Inner* inner_create();
+
+  /** Free a node, not its children. */
+  void node_destroy(
+      /** [in,out] Node to free. */
+      Node* node);
+
+  /** Free a node and all of its descendants. */
+  void subtree_destroy(
+      /** [in,out] Root of the subtree to free. */
+      Node* node);
+
+  /** Get the position of a child within its parent.
+   * @return index in `child->m_parent->m_children` */
+  static size_t child_position(
+      /** [in] Child node, must have a parent. */
+      const Node* child);
+
+  /** Get the smallest element in the subtree of a node.
+   * @return smallest element */
+  static const T& smallest(
+      /** [in] Root of the subtree. */
+      const Node* node);
+
+  /** Update the separator in the ancestors that refers to the smallest element
+   * of `node`'s subtree after it has changed. */
+  static void smallest_changed(
+      /** [in] Node whose smallest element has changed. */
+      Node* node);
+
+  /** Insert a new node `right` after `left` in the parent of `left`, splitting
+   * the parent and the ancestors as necessary. */
+  void insert_child(
+      /** [in,out] Node that has been split. */
+      Node* left,
+      /** [in,out] New node, sibling of `left`. */
+      Node* right,
+      /** [in] Smallest element of `right`. */
+      T separator,
+      /** [in,out] Preallocated inner nodes to use for the splits. */
+      Inner** spare,
+      /** [in,out] Number of nodes in `spare`. */
+      size_t* n_spare);
+
+  /** Remove an empty node from the tree and free it, removing ancestors that
+   * become empty as well. */
+  void remove_node(
+      /** [in,out] Node to remove. */
+      Node* node);
+
+  /** Comparator that defines the order of the elements. */
+  const Less m_less;
+
+  /** Allocator for the nodes. */
+  Allocator<uint8_t> m_allocator;
+
+  /** Root node, nullptr if the tree is empty. */
+  Node* m_root;
+
+  /** First leaf in order. */
+  Leaf* m_head;
+
+  /** Last leaf in order. */
+  Leaf* m_tail;
+
+  /** Number of elements. */
+  size_t m_size;
+};
+
+/* Implementation of inlined methods. */
+
+template <class T, class Less>
+inline Btree<T, Less>::Iterator::Iterator()
+    : m_tree(nullptr), m_leaf(nullptr), m_pos(0) {}
+
+template <class T, class Less>
+inline Btree<T, Less>::Iterator::Iterator(const Btree* tree, const Leaf* leaf,
+                                          size_t pos)
+    : m_tree(tree), m_leaf(leaf), m_pos(pos) {}
+
+template <class T, class Less>
+inline const T& Btree<T, Less>::Iterator::operator*() const {
+  DBUG_ASSERT(m_leaf != nullptr);
+  DBUG_ASSERT(m_pos < m_leaf->m_count);
+  return m_leaf->elements()[m_pos];
+}
+
+template <class T, class Less>
+inline const T* Btree<T, Less>::Iterator::operator->() const {
+  return &**this;
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator& Btree<T, Less>::Iterator::
+operator++() {
+  DBUG_ASSERT(m_leaf != nullptr);
+
+  if (++m_pos == m_leaf->m_count) {
+    m_leaf = m_leaf->m_next;
+    m_pos = 0;
+  }
+
+  return *this;
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator& Btree<T, Less>::Iterator::
+operator--() {
+  if (m_leaf == nullptr) {
+    m_leaf = m_tree->m_tail;
+    DBUG_ASSERT(m_leaf != nullptr);
+    m_pos = m_leaf->m_count - 1;
+  } else if (m_pos == 0) {
+    m_leaf = m_leaf->m_prev;
+    DBUG_ASSERT(m_leaf != nullptr);
+    m_pos = m_leaf->m_count - 1;
+  } else {
+    --m_pos;
+  }
+
+  return *this;
+}
+
+template <class T, class Less>
+inline bool Btree<T, Less>::Iterator::operator==(const Iterator& rhs) const {
+  return m_leaf == rhs.m_leaf && m_pos == rhs.m_pos;
+}
+
+template <class T, class Less>
+inline bool Btree<T, Less>::Iterator::operator!=(const Iterator& rhs) const {
+  return !(*this == rhs);
+}
+
+template <class T, class Less>
+inline Btree<T, Less>::Btree(const Less& less, const Allocator<T>& allocator)
+    : m_less(less),
+      m_allocator(allocator),
+      m_root(nullptr),
+      m_head(nullptr),
+      m_tail(nullptr),
+      m_size(0) {}
+
+template <class T, class Less>
+inline Btree<T, Less>::~Btree() {
+  clear();
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator Btree<T, Less>::begin() const {
+  return Iterator(this, m_head, 0);
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator Btree<T, Less>::end() const {
+  return Iterator(this, nullptr, 0);
+}
+
+template <class T, class Less>
+inline size_t Btree<T, Less>::size() const {
+  return m_size;
+}
+
+template <class T, class Less>
+inline const Less& Btree<T, Less>::key_comp() const {
+  return m_less;
+}
+
+template <class T, class Less>
+inline const typename Btree<T, Less>::Leaf* Btree<T, Less>::descend(
+    const T& value, bool upper) const {
+  const Node* node = m_root;
+
+  while (!node->m_is_leaf) {
+    const Inner* inner = static_cast<const Inner*>(node);
+    const T* keys = inner->keys();
+    const T* keys_end = keys + inner->m_count - 1;
+
+    const T* separator = upper
+                             ? std::upper_bound(keys, keys_end, value, m_less)
+                             : std::lower_bound(keys, keys_end, value, m_less);
+
+    node = inner->m_children[separator - keys];
+  }
+
+  return static_cast<const Leaf*>(node);
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator Btree<T, Less>::make_iterator(
+    const Leaf* leaf, size_t pos) const {
+  DBUG_ASSERT(pos <= leaf->m_count);
+
+  if (pos == leaf->m_count) {
+    return Iterator(this, leaf->m_next, 0);
+  }
+
+  return Iterator(this, leaf, pos);
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator Btree<T, Less>::lower_bound(
+    const T& value) const {
+  if (m_root == nullptr) {
+    return end();
+  }
+
+  const Leaf* leaf = descend(value, false);
+  const T* elements = leaf->elements();
+
+  return make_iterator(
+      leaf, std::lower_bound(elements, elements + leaf->m_count, value, m_less) -
+                elements);
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Iterator Btree<T, Less>::upper_bound(
+    const T& value) const {
+  if (m_root == nullptr) {
+    return end();
+  }
+
+  const Leaf* leaf = descend(value, true);
+  const T* elements = leaf->elements();
+
+  return make_iterator(
+      leaf, std::upper_bound(elements, elements + leaf->m_count, value, m_less) -
+                elements);
+}
+
+template <class T, class Less>
+typename Btree<T, Less>::Iterator Btree<T, Less>::insert(const T& value) {
+  if (m_root == nullptr) {
+    Leaf* leaf = leaf_create();
+    leaf->m_parent = nullptr;
+    m_root = m_head = m_tail = leaf;
+  }
+
+  Leaf* leaf = const_cast<Leaf*>(descend(value, true));
+  T* elements = leaf->elements();
+  size_t pos =
+      std::upper_bound(elements, elements + leaf->m_count, value, m_less) -
+      elements;
+
+  /* `pos` is 0 only in the first leaf because the separators in the ancestors
+   * of any other leaf are equal to its first element and we descended to the
+   * last equal element. So the separators need no update here. */
+
+  if (leaf->m_count < LEAF_CAPACITY) {
+    memmove(elements + pos + 1, elements + pos,
+            (leaf->m_count - pos) * sizeof(T));
+    memcpy(&elements[pos], &value, sizeof(T));
+    ++leaf->m_count;
+    ++m_size;
+    return Iterator(this, leaf, pos);
+  }
+
+  /* The leaf is full and must be split. Allocate all nodes needed for the
+   * split to propagate up the tree before modifying anything, so that the tree
+   * is left intact if the allocator throws. */
+  size_t n_spare_needed = 0;
+  const Inner* p = leaf->m_parent;
+  for (; p != nullptr && p->m_count == INNER_CAPACITY; p = p->m_parent) {
+    ++n_spare_needed;
+  }
+  if (p == nullptr) {
+    /* The split reaches the root, a new root is needed. */
+    ++n_spare_needed;
+  }
+  DBUG_ASSERT(n_spare_needed <= MAX_HEIGHT);
+
+  Leaf* right = nullptr;
+  Inner* spare[MAX_HEIGHT];
+  size_t n_spare = 0;
+
+  try {
+    right = leaf_create();
+    while (n_spare < n_spare_needed) {
+      spare[n_spare] = inner_create();
+      ++n_spare;
+    }
+  } catch (...) {
+    if (right != nullptr) {
+      node_destroy(right);
+    }
+    while (n_spare > 0) {
+      node_destroy(spare[--n_spare]);
+    }
+    throw;
+  }
+
+  const size_t mid = LEAF_CAPACITY / 2;
+
+  memcpy(right->elements(), elements + mid, (LEAF_CAPACITY - mid) * sizeof(T));
+  right->m_count = LEAF_CAPACITY - mid;
+  leaf->m_count = mid;
+
+  right->m_prev = leaf;
+  right->m_next = leaf->m_next;
+  if (leaf->m_next != nullptr) {
+    leaf->m_next->m_prev = right;
+  } else {
+    m_tail = right;
+  }
+  leaf->m_next = right;
+
+  Leaf* target = leaf;
+  if (pos > mid) {
+    target = right;
+    pos -= mid;
+  }
+
+  T* target_elements = target->elements();
+  memmove(target_elements + pos + 1, target_elements + pos,
+          (target->m_count - pos) * sizeof(T));
+  memcpy(&target_elements[pos], &value, sizeof(T));
+  ++target->m_count;
+  ++m_size;
+
+  insert_child(leaf, right, right->elements()[0], spare, &n_spare);
+
+  DBUG_ASSERT(n_spare == 0);
+
+  return Iterator(this, target, pos);
+}
+
+template <class T, class Less>
+void Btree<T, Less>::erase(const Iterator& position) {
+  Leaf* leaf = const_cast<Leaf*>(position.m_leaf);
+  const size_t pos = position.m_pos;
+
+  DBUG_ASSERT(leaf != nullptr);
+  DBUG_ASSERT(pos < leaf->m_count);
+
+  T* elements = leaf->elements();
+  memmove(elements + pos, elements + pos + 1,
+          (leaf->m_count - pos - 1) * sizeof(T));
+  --leaf->m_count;
+  --m_size;
+
+  if (leaf->m_count == 0) {
+    if (leaf->m_prev != nullptr) {
+      leaf->m_prev->m_next = leaf->m_next;
+    } else {
+      m_head = leaf->m_next;
+    }
+
+    if (leaf->m_next != nullptr) {
+      leaf->m_next->m_prev = leaf->m_prev;
+    } else {
+      m_tail = leaf->m_prev;
+    }
+
+    remove_node(leaf);
+  } else if (pos == 0) {
+    smallest_changed(leaf);
+  }
+}
+
+template <class T, class Less>
+void Btree<T, Less>::clear() {
+  if (m_root != nullptr) {
+    subtree_destroy(m_root);
+  }
+
+  m_root = nullptr;
+  m_head = nullptr;
+  m_tail = nullptr;
+  m_size = 0;
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Leaf* Btree<T, Less>::leaf_create() {
+  Leaf* leaf = reinterpret_cast<Leaf*>(m_allocator.allocate(sizeof(Leaf)));
+  leaf->m_parent = nullptr;
+  leaf->m_count = 0;
+  leaf->m_is_leaf = true;
+  leaf->m_prev = nullptr;
+  leaf->m_next = nullptr;
+  return leaf;
+}
+
+template <class T, class Less>
+inline typename Btree<T, Less>::Inner* Btree<T, Less>::inner_create() {
+  Inner* inner = reinterpret_cast<Inner*>(m_allocator.allocate(sizeof(Inner)));
+  inner->m_parent = nullptr;
+  inner->m_count = 0;
+  inner->m_is_leaf = false;
+  return inner;
+}
+
+template <class T, class Less>
+inline void Btree<T, Less>::node_destroy(Node* node) {
+  m_allocator.deallocate(reinterpret_cast<uint8_t*>(node),
+                         node->m_is_leaf ? sizeof(Leaf) : sizeof(Inner));
+}
+
+template <class T, class Less>
+void Btree<T, Less>::subtree_destroy(Node* node) {
+  if (!node->m_is_leaf) {
+    Inner* inner = static_cast<Inner*>(node);
+    for (size_t i = 0; i < inner->m_count; ++i) {
+      subtree_destroy(inner->m_children[i]);
+    }
+  }
+
+  node_destroy(node);
+}
+
+template <class T, class Less>
+inline size_t Btree<T, Less>::child_position(const Node* child) {
+  const Inner* parent = child->m_parent;
+
+  DBUG_ASSERT(parent != nullptr);
+
+  size_t i = 0;
+  while (parent->m_children[i] != child) {
+    ++i;
+    DBUG_ASSERT(i < parent->m_count);
+  }
+
+  return i;
+}
+
+template <class T, class Less>
+inline const T& Btree<T, Less>::smallest(const Node* node) {
+  while (!node->m_is_leaf) {
+    node = static_cast<const Inner*>(node)->m_children[0];
+  }
+
+  DBUG_ASSERT(node->m_count > 0);
+
+  return static_cast<const Leaf*>(node)->elements()[0];
+}
+
+template <class T, class Less>
+void Btree<T, Less>::smallest_changed(Node* node) {
+  const T& value = smallest(node);
+
+  /* The smallest element of a subtree is a separator in the first ancestor
+   * where the subtree is not the leftmost child. */
+  for (Node* child = node; child->m_parent != nullptr;
+       child = child->m_parent) {
+    const size_t i = child_position(child);
+    if (i > 0) {
+      memcpy(&child->m_parent->keys()[i - 1], &value, sizeof(T));
+      return;
+    }
+  }
+}
+
+template <class T, class Less>
+void Btree<T, Less>::insert_child(Node* left, Node* right, T separator,
+                                  Inner** spare, size_t* n_spare) {
+  Inner* parent = left->m_parent;
+
+  if (parent == nullptr) {
+    DBUG_ASSERT(left == m_root);
+    DBUG_ASSERT(*n_spare > 0);
+
+    Inner* root = spare[--*n_spare];
+    root->m_count = 2;
+    root->m_children[0] = left;
+    root->m_children[1] = right;
+    memcpy(&root->keys()[0], &separator, sizeof(T));
+    left->m_parent = root;
+    right->m_parent = root;
+    m_root = root;
+    return;
+  }
+
+  const size_t i = child_position(left);
+
+  if (parent->m_count < INNER_CAPACITY) {
+    T* keys = parent->keys();
+    memmove(&parent->m_children[i + 2], &parent->m_children[i + 1],
+            (parent->m_count - i - 1) * sizeof(Node*));
+    memmove(keys + i + 1, keys + i, (parent->m_count - i - 1) * sizeof(T));
+    parent->m_children[i + 1] = right;
+    memcpy(&keys[i], &separator, sizeof(T));
+    right->m_parent = parent;
+    ++parent->m_count;
+    return;
+  }
+
+  /* The parent is full, split it. First lay out all of its separators and
+   * children including the new ones in temporary arrays, then distribute them
+   * between the parent and its new sibling. */
+  DBUG_ASSERT(*n_spare > 0);
+  Inner* sibling = spare[--*n_spare];
+
+  Slot all_keys_mem[INNER_CAPACITY];
+  Node* all_children[INNER_CAPACITY + 1];
+  T* all_keys = reinterpret_cast<T*>(all_keys_mem);
+  const T* keys = parent->keys();
+
+  memcpy(all_children, parent->m_children, (i + 1) * sizeof(Node*));
+  all_children[i + 1] = right;
+  memcpy(&all_children[i + 2], &parent->m_children[i + 1],
+         (INNER_CAPACITY - i - 1) * sizeof(Node*));
+
+  memcpy(all_keys, keys, i * sizeof(T));
+  memcpy(&all_keys[i], &separator, sizeof(T));
+  memcpy(&all_keys[i + 1], &keys[i], (INNER_CAPACITY - 1 - i) * sizeof(T));
+
+  const size_t n_left = (INNER_CAPACITY + 1) / 2;
+  const size_t n_right = INNER_CAPACITY + 1 - n_left;
+
+  parent->m_count = static_cast<uint16_t>(n_left);
+  memcpy(parent->m_children, all_children, n_left * sizeof(Node*));
+  memcpy(parent->keys(), all_keys, (n_left - 1) * sizeof(T));
+
+  sibling->m_count = static_cast<uint16_t>(n_right);
+  memcpy(sibling->m_children, &all_children[n_left], n_right * sizeof(Node*));
+  memcpy(sibling->keys(), &all_keys[n_left], (n_right - 1) * sizeof(T));
+
+  right->m_parent = parent;
+  for (size_t c = 0; c < n_right; ++c) {
+    sibling->m_children[c]->m_parent = sibling;
+  }
+
+  /* The separator between the two halves moves up. */
+  insert_child(parent, sibling, all_keys[n_left - 1], spare, n_spare);
+}
+
+template <class T, class Less>
+void Btree<T, Less>::remove_node(Node* node) {
+  Inner* parent = node->m_parent;
+
+  if (parent == nullptr) {
+    DBUG_ASSERT(node == m_root);
+    node_destroy(node);
+    m_root = nullptr;
+    return;
+  }
+
+  if (parent->m_count == 1) {
+    node_destroy(node);
+    parent->m_count = 0;
+    remove_node(parent);
+    return;
+  }
+
+  const size_t i = child_position(node);
+  node_destroy(node);
+
+  T* keys = parent->keys();
+
+  if (i == 0) {
+    /* The new first child's smallest element was the first separator, which
+     * now becomes the smallest element of the parent's subtree. */
+    memmove(&parent->m_children[0], &parent->m_children[1],
+            (parent->m_count - 1) * sizeof(Node*));
+    memmove(keys, keys + 1, (parent->m_count - 2) * sizeof(T));
+    --parent->m_count;
+    smallest_changed(parent);
+  } else {
+    memmove(&parent->m_children[i], &parent->m_children[i + 1],
+            (parent->m_count - i - 1) * sizeof(Node*));
+    memmove(keys + i - 1, keys + i, (parent->m_count - i - 1) * sizeof(T));
+    --parent->m_count;
+  }
+
+  if (parent == m_root && parent->m_count == 1) {
+    m_root = parent->m_children[0];
+    m_root->m_parent = nullptr;
+    node_destroy(parent);
+  }
+}
+
+} /* namespace temptable */
+
+#endif /* TEMPTABLE_BTREE_H */
@@ -57,8 +57,14 @@ constexpr size_t ALLOCATOR_MAX_BLOCK_BYTES = 1_MiB
 /** `Storage` page size. */
 constexpr size_t STORAGE_PAGE_SIZE = 64_KiB;
 
-/** Number of buckets to have by default in a hash index. */
-constexpr size_t INDEX_DEFAULT_HASH_TABLE_BUCKETS = 1024;
+/** Number of slots a hash index allocates when its first entry is inserted.
+ * A slot is 32 bytes, so this takes about as much memory as the 1024 buckets
+ * of the std::unordered_set that was used before. */
+constexpr size_t INDEX_DEFAULT_HASH_TABLE_BUCKETS = 256;
+
+/** Size of a node of a tree index in bytes. With 16 bytes per indexed cells
+ * entry a leaf holds 30 entries. */
+constexpr size_t INDEX_TREE_NODE_SIZE = 512;
 
 } /* namespace temptable */
 
@@ -18,29 +18,24 @@ TempTable index containers declarations. */
 #ifndef TEMPTABLE_CONTAINERS_H
 #define TEMPTABLE_CONTAINERS_H
 
-#include <set>           /* std::multiset */
-#include <type_traits>   /* std::is_same */
-#include <unordered_set> /* std::unordered_set, std::unordered_multiset */
+#include <type_traits> /* std::is_same */
 
 #include "temptable/allocator.h"     /* temptable::Allocator */
+#include "temptable/btree.h"         /* temptable::Btree */
+#include "temptable/hash_table.h"    /* temptable::Hash_table */
 #include "temptable/indexed_cells.h" /* temptable::Indexed_cells */
 
 namespace temptable {
 
 /** The container used by tree unique and non-unique indexes. */
-typedef std::multiset<Indexed_cells, Indexed_cells_less,
-                      Allocator<Indexed_cells>>
-    Tree_container;
+typedef Btree<Indexed_cells, Indexed_cells_less> Tree_container;
 
 /** The container used by hash non-unique indexes. */
-typedef std::unordered_multiset<Indexed_cells, Indexed_cells_hash,
-                                Indexed_cells_equal_to,
-                                Allocator<Indexed_cells>>
+typedef Hash_table<Indexed_cells, Indexed_cells_hash, Indexed_cells_equal_to>
     Hash_duplicates_container;
 
 /** The container used by hash unique indexes. */
-typedef std::unordered_set<Indexed_cells, Indexed_cells_hash,
-                           Indexed_cells_equal_to, Allocator<Indexed_cells>>
+typedef Hash_table<Indexed_cells, Indexed_cells_hash, Indexed_cells_equal_to>
     Hash_unique_container;
 
 static_assert(
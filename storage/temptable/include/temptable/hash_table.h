@@ -0,0 +1,670 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA */
+
+/** @file storage/temptable/include/temptable/hash_table.h
+TempTable open addressing hash table container. */
+
+#ifndef TEMPTABLE_HASH_TABLE_H
+#define TEMPTABLE_HASH_TABLE_H
+
+#include <cstddef>     /* size_t */
+#include <cstdint>     /* uint64_t */
+#include <cstring>     /* memcpy() */
+#include <iterator>    /* std::forward_iterator_tag */
+#include <type_traits> /* std::aligned_storage, std::is_trivially_copyable */
+#include <utility>     /* std::pair */
+
+#include "my_dbug.h"             /* DBUG_ASSERT() */
+#include "temptable/allocator.h" /* temptable::Allocator */
+
+namespace temptable {
+
+/** A hash table with open addressing and linear probing, used instead of
+ * std::unordered_set and std::unordered_multiset. Each slot stores the hash
+ * of its element next to the element itself, so probing compares the hashes
+ * first and calls the (collation aware, thus expensive) equality comparator
+ * only when they match, and rehashing does not need to recompute them.
+ *
+ * Elements that are equal are kept in one slot: the first one inline and the
+ * others in an array attached to the slot. This way they are adjacent in
+ * iteration order, as `equal_range()` requires.
+ *
+ * Inserting an element invalidates all iterators if the table grows. Erasing
+ * an element invalidates the iterators positioned on elements equal to it. The
+ * elements must be trivially copyable. */
+template <class T, class Hash, class Equal>
+class Hash_table {
+ private:
+  /** Type of the memory where an element is stored. */
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+  /** Elements that are equal to the one in a slot. */
+  struct Duplicates {
+    /** Number of elements. */
+    size_t m_count;
+
+    /** Number of elements that fit in this object. */
+    size_t m_capacity;
+
+    /** Get the elements, which follow this header in memory.
+     * @return elements */
+    T* elements() { return reinterpret_cast<T*>(this + 1); }
+  };
+
+  /** A slot of the table. */
+  struct Slot {
+    /** Hash of the element, or one of `EMPTY` and `DELETED`. */
+    uint64_t m_hash;
+
+    /** The element. */
+    Storage m_element;
+
+    /** Elements equal to `m_element`, or nullptr. */
+    Duplicates* m_duplicates;
+
+    T* element() { return reinterpret_cast<T*>(&m_element); }
+
+    const T* element() const { return reinterpret_cast<const T*>(&m_element); }
+  };
+
+  /** Hash value of a slot that has never been used. */
+  static constexpr uint64_t EMPTY = 0;
+
+  /** Hash value of a slot whose element has been erased. */
+  static constexpr uint64_t DELETED = 1;
+
+  /** Value of `Iterator::m_duplicate` for the position after the elements of
+   * a slot. */
+  static constexpr size_t AFTER_SLOT = ~static_cast<size_t>(0);
+
+  /** Number of elements that an array of duplicates is created for. */
+  static constexpr size_t DUPLICATES_INITIAL_CAPACITY = 4;
+
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Hash_table elements are copied with memcpy().");
+  static_assert(alignof(T) <= alignof(Duplicates),
+                "Duplicates are stored after a Duplicates header.");
+
+ public:
+  /** Iterator over a Hash_table. */
+  class Iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    /** Default constructor. This creates a hollow iterator object, that must
+     * be assigned afterwards. */
+    Iterator();
+
+    /** Dereference the iterator to the element it points to.
+     * @return the element where the iterator is positioned */
+    const T& operator*() const;
+
+    /** Access a member of the element the iterator points to.
+     * @return the element where the iterator is positioned */
+    const T* operator->() const;
+
+    /** Advance the iterator one element forward. If the iterator points to
+     * end() before this call, then the behavior is undefined.
+     * @return *this */
+    Iterator& operator++();
+
+    /** Compare with another iterator over the same table. If one of them was
+     * returned by `equal_range()` as the end of a range and the other one is
+     * not in that range, this finds the next slot that contains elements.
+     * @return true if positioned on the same element */
+    bool operator==(
+        /** [in] Iterator to compare with. */
+        const Iterator& rhs) const;
+
+    /** Compare with another iterator over the same table.
+     * @return true if positioned on different elements */
+    bool operator!=(
+        /** [in] Iterator to compare with. */
+        const Iterator& rhs) const;
+
+   private:
+    friend class Hash_table;
+
+    /** Constructor. */
+    Iterator(
+        /** [in] Table to iterate over. */
+        const Hash_table* table,
+        /** [in] Slot of the element, the capacity of the table for end(). */
+        size_t slot,
+        /** [in] 0 for the element in the slot, i for the i-th duplicate, or
+         * `AFTER_SLOT` for the position after the elements of the slot. */
+        size_t duplicate);
+
+    /** Get the slot of the position after the elements of `m_slot`.
+     * @return slot index */
+    size_t slot_after() const;
+
+    /** Table over which the iterator operates. */
+    const Hash_table* m_table;
+
+    /** Current slot. */
+    size_t m_slot;
+
+    /** Current element within the slot, see the constructor. */
+    size_t m_duplicate;
+  };
+
+  typedef Iterator iterator;
+  typedef Iterator const_iterator;
+
+  /** Constructor. No memory is allocated until the first insert. */
+  Hash_table(
+      /** [in] Number of slots to create on the first insert, rounded up to a
+       * power of 2. */
+      size_t initial_capacity,
+      /** [in] Hash function. */
+      const Hash& hash,
+      /** [in] Equality comparator. */
+      const Equal& equal,
+      /** [in] Allocator to allocate the slots from. */
+      const Allocator<T>& allocator,
+      /** [in] Whether to allow elements that are equal. */
+      bool allow_duplicates);
+
+  /** Copy constructing is disabled, not necessary. */
+  Hash_table(const Hash_table&) = delete;
+
+  /** Copy assignment is disabled, not necessary. */
+  Hash_table& operator=(const Hash_table&) = delete;
+
+  /** Destructor. */
+  ~Hash_table();
+
+  /** Get an iterator, positioned on the first element.
+   * @return iterator */
+  Iterator begin() const;
+
+  /** Get an iterator, positioned after the last element.
+   * @return iterator */
+  Iterator end() const;
+
+  /** Get the number of elements in the table.
+   * @return number of elements */
+  size_t size() const;
+
+  /** Find the elements that are equal to `value`.
+   * @return a range of iterators, both are end() if none are found */
+  std::pair<Iterator, Iterator> equal_range(
+      /** [in] Value to search for. */
+      const T& value) const;
+
+  /** Insert a copy of `value`. If duplicates are not allowed and an equal
+   * element exists, then nothing is inserted. Throws `Result` if memory
+   * cannot be allocated, in which case the table is not modified.
+   * @return iterator to the inserted (or the existing) element, and whether
+   * the element was inserted */
+  std::pair<Iterator, bool> insert(
+      /** [in] Value to insert. */
+      const T& value);
+
+  /** Erase the element at `position`. */
+  void erase(
+      /** [in] Position of the element to erase, must not be end(). */
+      const Iterator& position);
+
+  /** Erase all elements and free all memory. */
+  void clear();
+
+ private:
+  /** Compute the hash of a value, avoiding the reserved values.
+   * @return hash */
+  uint64_t hash(
+      /** [in] Value to hash. */
+      const T& value) const;
+
+  /** Find the slot of the elements that are equal to `value`.
+   * @return slot index, or `m_capacity` if not found */
+  size_t find(
+      /** [in] Value to search for. */
+      const T& value,
+      /** [in] Hash of `value`. */
+      uint64_t hash) const;
+
+  /** Find the first slot after `slot` (inclusive) that contains elements.
+   * @return slot index, or `m_capacity` if there are no more */
+  size_t next_used(
+      /** [in] Slot to start from. */
+      size_t slot) const;
+
+  /** Move all elements to a new array of slots. */
+  void rehash(
+      /** [in] New number of slots, a power of 2. */
+      size_t capacity);
+
+  /** Add an element to the duplicates of a slot.
+   * @return the position of the new element within the slot, for `Iterator` */
+  size_t duplicate_add(
+      /** [in,out] Slot to add to. */
+      Slot* slot,
+      /** [in] Value to add. */
+      const T& value);
+
+  /** Size in bytes of a duplicates array.
+   * @return size in bytes */
+  static size_t duplicates_bytes(
+      /** [in] Number of elements. */
+      size_t capacity);
+
+  /** Hash function. */
+  const Hash m_hash;
+
+  /** Equality comparator. */
+  const Equal m_equal;
+
+  /** Allocator for the slots and the duplicates. */
+  Allocator<uint8_t> m_allocator;
+
+  /** Whether elements that are equal are allowed. */
+  const bool m_allow_duplicates;
+
+  /** Number of slots to create on the first insert. */
+  size_t m_initial_capacity;
+
+  /** Slots, nullptr until the first insert. */
+  Slot* m_slots;
+
+  /** Number of slots, 0 or a power of 2. */
+  size_t m_capacity;
+
+  /** Number of slots that contain elements. */
+  size_t m_used;
+
+  /** Number of slots that contain elements or are `DELETED`. Probing stops
+   * only at `EMPTY` slots so this must be kept below `m_capacity`. */
+  size_t m_not_empty;
+
+  /** Number of elements, including duplicates. */
+  size_t m_size;
+};
+
+/* Implementation of inlined methods. */
+
+template <class T, class Hash, class Equal>
+inline Hash_table<T, Hash, Equal>::Iterator::Iterator()
+    : m_table(nullptr), m_slot(0), m_duplicate(0) {}
+
+template <class T, class Hash, class Equal>
+inline Hash_table<T, Hash, Equal>::Iterator::Iterator(const Hash_table* table,
+                                                      size_t slot,
+                                                      size_t duplicate)
+    : m_table(table), m_slot(slot), m_duplicate(duplicate) {}
+
+template <class T, class Hash, class Equal>
+inline const T& Hash_table<T, Hash, Equal>::Iterator::operator*() const {
+  DBUG_ASSERT(m_slot < m_table->m_capacity);
+  DBUG_ASSERT(m_duplicate != AFTER_SLOT);
+
+  Slot& slot = m_table->m_slots[m_slot];
+
+  if (m_duplicate == 0) {
+    return *slot.element();
+  }
+
+  DBUG_ASSERT(m_duplicate <= slot.m_duplicates->m_count);
+  return slot.m_duplicates->elements()[m_duplicate - 1];
+}
+
+template <class T, class Hash, class Equal>
+inline const T* Hash_table<T, Hash, Equal>::Iterator::operator->() const {
+  return &**this;
+}
+
+template <class T, class Hash, class Equal>
+inline typename Hash_table<T, Hash, Equal>::Iterator&
+    Hash_table<T, Hash, Equal>::Iterator::operator++() {
+  DBUG_ASSERT(m_slot < m_table->m_capacity);
+  DBUG_ASSERT(m_duplicate != AFTER_SLOT);
+
+  const Duplicates* duplicates = m_table->m_slots[m_slot].m_duplicates;
+
+  if (duplicates != nullptr && m_duplicate < duplicates->m_count) {
+    ++m_duplicate;
+  } else {
+    m_slot = m_table->next_used(m_slot + 1);
+    m_duplicate = 0;
+  }
+
+  return *this;
+}
+
+template <class T, class Hash, class Equal>
+inline size_t Hash_table<T, Hash, Equal>::Iterator::slot_after() const {
+  return m_table->next_used(m_slot + 1);
+}
+
+template <class T, class Hash, class Equal>
+inline bool Hash_table<T, Hash, Equal>::Iterator::operator==(
+    const Iterator& rhs) const {
+  if (m_slot == rhs.m_slot) {
+    return m_duplicate == rhs.m_duplicate;
+  }
+
+  /* Positions in different slots are only equal if one is after the elements
+   * of its slot and the other is on the first element of the next slot. */
+  if (m_duplicate == AFTER_SLOT) {
+    return rhs.m_duplicate == 0 && slot_after() == rhs.m_slot;
+  }
+
+  if (rhs.m_duplicate == AFTER_SLOT) {
+    return m_duplicate == 0 && rhs.slot_after() == m_slot;
+  }
+
+  return false;
+}
+
+template <class T, class Hash, class Equal>
+inline bool Hash_table<T, Hash, Equal>::Iterator::operator!=(
+    const Iterator& rhs) const {
+  return !(*this == rhs);
+}
+
+template <class T, class Hash, class Equal>
+inline Hash_table<T, Hash, Equal>::Hash_table(size_t initial_capacity,
+                                              const Hash& hash,
+                                              const Equal& equal,
+                                              const Allocator<T>& allocator,
+                                              bool allow_duplicates)
+    : m_hash(hash),
+      m_equal(equal),
+      m_allocator(allocator),
+      m_allow_duplicates(allow_duplicates),
+      m_initial_capacity(2),
+      m_slots(nullptr),
+      m_capacity(0),
+      m_used(0),
+      m_not_empty(0),
+      m_size(0) {
+  while (m_initial_capacity < initial_capacity) {
+    m_initial_capacity *= 2;
+  }
+}
+
+template <class T, class Hash, class Equal>
+inline Hash_table<T, Hash, Equal>::~Hash_table() {
+  clear();
+}
+
+template <class T, class Hash, class Equal>
+inline typename Hash_table<T, Hash, Equal>::Iterator
+Hash_table<T, Hash, Equal>::begin() const {
+  return Iterator(this, next_used(0), 0);
+}
+
+template <class T, class Hash, class Equal>
+inline typename Hash_table<T, Hash, Equal>::Iterator
+Hash_table<T, Hash, Equal>::end() const {
+  return Iterator(this, m_capacity, 0);
+}
+
+template <class T, class Hash, class Equal>
+inline size_t Hash_table<T, Hash, Equal>::size() const {
+  return m_size;
+}
+
+template <class T, class Hash, class Equal>
+inline uint64_t Hash_table<T, Hash, Equal>::hash(const T& value) const {
+  uint64_t h = static_cast<uint64_t>(m_hash(value));
+
+  /* Mix the bits, because only the lower ones select the slot (the final step
+   * of MurmurHash3). */
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return h > DELETED ? h : h + DELETED + 1;
+}
+
+template <class T, class Hash, class Equal>
+inline size_t Hash_table<T, Hash, Equal>::find(const T& value,
+                                               uint64_t hash) const {
+  const size_t mask = m_capacity - 1;
+
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    const Slot& slot = m_slots[i];
+
+    if (slot.m_hash == EMPTY) {
+      return m_capacity;
+    }
+
+    if (slot.m_hash == hash && m_equal(*slot.element(), value)) {
+      return i;
+    }
+  }
+}
+
+template <class T, class Hash, class Equal>
+inline size_t Hash_table<T, Hash, Equal>::next_used(size_t slot) const {
+  while (slot < m_capacity && m_slots[slot].m_hash <= DELETED) {
+    ++slot;
+  }
+  return slot;
+}
+
+template <class T, class Hash, class Equal>
+std::pair<typename Hash_table<T, Hash, Equal>::Iterator,
+          typename Hash_table<T, Hash, Equal>::Iterator>
+Hash_table<T, Hash, Equal>::equal_range(const T& value) const {
+  if (m_used == 0) {
+    return std::make_pair(end(), end());
+  }
+
+  const size_t i = find(value, hash(value));
+
+  if (i == m_capacity) {
+    return std::make_pair(end(), end());
+  }
+
+  /* Finding the next slot that contains elements may take long if the table
+   * is sparse, so it is postponed until the end of the range is compared with
+   * an iterator positioned outside of it. */
+  return std::make_pair(Iterator(this, i, 0), Iterator(this, i, AFTER_SLOT));
+}
+
+template <class T, class Hash, class Equal>
+std::pair<typename Hash_table<T, Hash, Equal>::Iterator, bool>
+Hash_table<T, Hash, Equal>::insert(const T& value) {
+  const uint64_t h = hash(value);
+
+  if (m_used > 0) {
+    const size_t i = find(value, h);
+
+    if (i != m_capacity) {
+      if (!m_allow_duplicates) {
+        return std::make_pair(Iterator(this, i, 0), false);
+      }
+
+      const size_t d = duplicate_add(&m_slots[i], value);
+      ++m_size;
+      return std::make_pair(Iterator(this, i, d), true);
+    }
+  }
+
+  /* Keep at least 1/4 of the slots empty, so that probe sequences are short.
+   * If most of the non-empty slots are DELETED then rehash into the same
+   * number of slots, just to get rid of them. */
+  if ((m_not_empty + 1) * 4 > m_capacity * 3) {
+    size_t capacity = m_capacity > 0 ? m_capacity : m_initial_capacity;
+    while ((m_used + 1) * 2 > capacity) {
+      capacity *= 2;
+    }
+    rehash(capacity);
+  }
+
+  const size_t mask = m_capacity - 1;
+  size_t i = h & mask;
+
+  while (m_slots[i].m_hash > DELETED) {
+    i = (i + 1) & mask;
+  }
+
+  Slot& slot = m_slots[i];
+
+  if (slot.m_hash == EMPTY) {
+    ++m_not_empty;
+  }
+
+  slot.m_hash = h;
+  memcpy(slot.element(), &value, sizeof(T));
+  slot.m_duplicates = nullptr;
+  ++m_used;
+  ++m_size;
+
+  return std::make_pair(Iterator(this, i, 0), true);
+}
+
+template <class T, class Hash, class Equal>
+void Hash_table<T, Hash, Equal>::erase(const Iterator& position) {
+  DBUG_ASSERT(position.m_slot < m_capacity);
+
+  Slot& slot = m_slots[position.m_slot];
+  Duplicates* duplicates = slot.m_duplicates;
+
+  DBUG_ASSERT(slot.m_hash > DELETED);
+
+  --m_size;
+
+  if (duplicates == nullptr) {
+    slot.m_hash = DELETED;
+    --m_used;
+    return;
+  }
+
+  /* Move the last duplicate to the erased position. */
+  T* elements = duplicates->elements();
+  T* target = position.m_duplicate == 0 ? slot.element()
+                                        : &elements[position.m_duplicate - 1];
+
+  memcpy(target, &elements[duplicates->m_count - 1], sizeof(T));
+
+  if (--duplicates->m_count == 0) {
+    m_allocator.deallocate(reinterpret_cast<uint8_t*>(duplicates),
+                           duplicates_bytes(duplicates->m_capacity));
+    slot.m_duplicates = nullptr;
+  }
+}
+
+template <class T, class Hash, class Equal>
+void Hash_table<T, Hash, Equal>::clear() {
+  if (m_slots == nullptr) {
+    return;
+  }
+
+  for (size_t i = 0; i < m_capacity; ++i) {
+    Duplicates* duplicates = m_slots[i].m_duplicates;
+    if (m_slots[i].m_hash > DELETED && duplicates != nullptr) {
+      m_allocator.deallocate(reinterpret_cast<uint8_t*>(duplicates),
+                             duplicates_bytes(duplicates->m_capacity));
+    }
+  }
+
+  m_allocator.deallocate(reinterpret_cast<uint8_t*>(m_slots),
+                         m_capacity * sizeof(Slot));
+
+  m_slots = nullptr;
+  m_capacity = 0;
+  m_used = 0;
+  m_not_empty = 0;
+  m_size = 0;
+}
+
+template <class T, class Hash, class Equal>
+void Hash_table<T, Hash, Equal>::rehash(size_t capacity) {
+  DBUG_ASSERT((capacity & (capacity - 1)) == 0);
+  DBUG_ASSERT(capacity > m_used);
+
+  Slot* slots =
+      reinterpret_cast<Slot*>(m_allocator.allocate(capacity * sizeof(Slot)));
+
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].m_hash = EMPTY;
+  }
+
+  const size_t mask = capacity - 1;
+
+  for (size_t i = 0; i < m_capacity; ++i) {
+    const Slot& slot = m_slots[i];
+
+    if (slot.m_hash <= DELETED) {
+      continue;
+    }
+
+    size_t j = slot.m_hash & mask;
+    while (slots[j].m_hash != EMPTY) {
+      j = (j + 1) & mask;
+    }
+
+    memcpy(&slots[j], &slot, sizeof(Slot));
+  }
+
+  if (m_slots != nullptr) {
+    m_allocator.deallocate(reinterpret_cast<uint8_t*>(m_slots),
+                           m_capacity * sizeof(Slot));
+  }
+
+  m_slots = slots;
+  m_capacity = capacity;
+  m_not_empty = m_used;
+}
+
+template <class T, class Hash, class Equal>
+size_t Hash_table<T, Hash, Equal>::duplicate_add(Slot* slot, const T& value) {
+  Duplicates* duplicates = slot->m_duplicates;
+
+  if (duplicates == nullptr || duplicates->m_count == duplicates->m_capacity) {
+    const size_t capacity = duplicates == nullptr
+                                ? DUPLICATES_INITIAL_CAPACITY
+                                : duplicates->m_capacity * 2;
+
+    Duplicates* grown = reinterpret_cast<Duplicates*>(
+        m_allocator.allocate(duplicates_bytes(capacity)));
+
+    grown->m_capacity = capacity;
+
+    if (duplicates == nullptr) {
+      grown->m_count = 0;
+    } else {
+      grown->m_count = duplicates->m_count;
+      memcpy(grown->elements(), duplicates->elements(),
+             duplicates->m_count * sizeof(T));
+      m_allocator.deallocate(reinterpret_cast<uint8_t*>(duplicates),
+                             duplicates_bytes(duplicates->m_capacity));
+    }
+
+    slot->m_duplicates = duplicates = grown;
+  }
+
+  memcpy(&duplicates->elements()[duplicates->m_count], &value, sizeof(T));
+
+  return ++duplicates->m_count;
+}
+
+template <class T, class Hash, class Equal>
+inline size_t Hash_table<T, Hash, Equal>::duplicates_bytes(size_t capacity) {
+  return sizeof(Duplicates) + capacity * sizeof(T);
+}
+
+} /* namespace temptable */
+
+#endif /* TEMPTABLE_HASH_TABLE_H */
@@ -52,6 +52,16 @@ class Table {
   const TABLE* mysql_table() const;
   void mysql_table(TABLE* table);
 
+  /** Note that a handler has opened the table. */
+  void opened();
+
+  /** Note that a handler which had opened the table has closed it. */
+  void closed();
+
+  /** Check whether the table is opened by any handler.
+   * @return true if opened */
+  bool is_opened() const;
+
   size_t mysql_row_length() const;
 
   size_t number_of_indexes() const;
@@ -141,6 +151,12 @@ class Table {
   Columns m_columns;
 
   TABLE* m_mysql_table;
+
+  /** Number of handlers which have the table opened. A materialized derived
+   * table or CTE that is referenced more than once in a statement is read
+   * through one handler per reference, all sharing this table, which must
+   * live until the last of them has closed it. */
+  size_t m_opened_handlers;
 };
 
 /** A container for the list of the tables. Don't allocate memory for it from
@@ -184,6 +200,9 @@ inline Table& Table::operator=(Table&& rhs) {
   m_mysql_table = rhs.m_mysql_table;
   rhs.m_mysql_table = nullptr;
 
+  m_opened_handlers = rhs.m_opened_handlers;
+  rhs.m_opened_handlers = 0;
+
   return *this;
 }
 
@@ -193,6 +212,15 @@ inline void Table::mysql_table(TABLE* mysql_table) {
   m_mysql_table = mysql_table;
 }
 
+inline void Table::opened() { ++m_opened_handlers; }
+
+inline void Table::closed() {
+  DBUG_ASSERT(m_opened_handlers > 0);
+  --m_opened_handlers;
+}
+
+inline bool Table::is_opened() const { return m_opened_handlers > 0; }
+
 inline size_t Table::mysql_row_length() const { return m_mysql_row_length; }
 
 inline size_t Table::number_of_indexes() const { return m_indexes.size(); }
@@ -138,11 +138,13 @@ int Handler::delete_table(const char* table_name, const dd::Table*) {
     const auto pos = tables.find(table_name);
 
     if (pos != tables.end()) {
-      if (&pos->second != m_opened_table) {
+      if (!pos->second.is_opened()) {
         tables.erase(pos);
         ret = Result::OK;
       } else {
-        /* Attempt to delete the currently opened table. */
+        /* Attempt to delete a table that is still opened by this or by
+         * another handler, for example by another reference to a shared
+         * materialized derived table. */
         ret = Result::UNSUPPORTED;
       }
     } else {
@@ -178,6 +180,7 @@ int Handler::open(const char* table_name, int, uint, const dd::Table*) {
       ret = Result::NO_SUCH_TABLE;
     } else {
       m_opened_table = &iter->second;
+      m_opened_table->opened();
       assign_table();
       ret = Result::OK;
     }
@@ -197,7 +200,10 @@ int Handler::close() {
   DBUG_ASSERT(current_thread_is_creator());
   DBUG_ASSERT(m_opened_table != nullptr);
 
+  /* Other handlers which still have the table opened assign their own TABLE
+   * object before using it. */
   m_opened_table->mysql_table(nullptr);
+  m_opened_table->closed();
   m_opened_table = nullptr;
 
   handler::active_index = MAX_KEY;
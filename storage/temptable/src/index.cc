@@ -86,7 +86,7 @@ Result Tree::insert(const Indexed_cells& indexed_cells,
     Container::iterator it;
 
     try {
-      it = m_tree.emplace(indexed_cells);
+      it = m_tree.insert(indexed_cells);
     } catch (Result ex) {
       return ex;
     }
@@ -152,14 +152,14 @@ Hash_duplicates::Hash_duplicates(const Table& table, const KEY& mysql_index,
                                  const Allocator<Indexed_cells>& allocator)
     : Index(table, mysql_index),
       m_hash_table(INDEX_DEFAULT_HASH_TABLE_BUCKETS, Indexed_cells_hash(*this),
-                   Indexed_cells_equal_to(*this), allocator) {}
+                   Indexed_cells_equal_to(*this), allocator, true) {}
 
 Result Hash_duplicates::insert(const Indexed_cells& indexed_cells,
                                Cursor* insert_position) {
   Container::iterator it;
 
   try {
-    it = m_hash_table.emplace(indexed_cells);
+    it = m_hash_table.insert(indexed_cells).first;
   } catch (Result ex) {
     return ex;
   }
@@ -204,14 +204,14 @@ Hash_unique::Hash_unique(const Table& table, const KEY& mysql_index,
                          const Allocator<Indexed_cells>& allocator)
     : Index(table, mysql_index),
       m_hash_table(INDEX_DEFAULT_HASH_TABLE_BUCKETS, Indexed_cells_hash(*this),
-                   Indexed_cells_equal_to(*this), allocator) {}
+                   Indexed_cells_equal_to(*this), allocator, false) {}
 
 Result Hash_unique::insert(const Indexed_cells& indexed_cells,
                            Cursor* insert_position) {
   std::pair<Container::iterator, bool> r;
 
   try {
-    r = m_hash_table.emplace(indexed_cells);
+    r = m_hash_table.insert(indexed_cells);
   } catch (Result ex) {
     return ex;
   }
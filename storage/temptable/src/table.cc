@@ -46,7 +46,8 @@ Table::Table(TABLE* mysql_table, bool all_columns_are_fixed_size)
       m_indexes(m_allocator),
       m_insert_undo(m_allocator),
       m_columns(m_allocator),
-      m_mysql_table(mysql_table) {
+      m_mysql_table(mysql_table),
+      m_opened_handlers(0) {
   const size_t number_of_indexes = mysql_table->s->keys;
   const size_t number_of_columns = mysql_table->s->fields;
 
@@ -123,7 +123,16 @@ protected:
     delete[] sort_keys;
   }
 
+  /// @returns work space for radix_sort_keys() of count keys
+  uchar *radix_work_space(size_t count)
+  {
+    work_space.assign(count * RADIX_SORT_SPACE_PER_KEY / sizeof(ulonglong),
+                      0);
+    return static_cast<uchar*>(static_cast<void*>(work_space.data()));
+  }
+
   uchar **sort_keys;
+  std::vector<ulonglong> work_space;
 };
 std::vector<int> FileSortCompareTest::test_data;
 
@@ -506,4 +515,51 @@ TEST_F(FileSortCompareTest, DISABLED_StdStableSortIntIntIntInt)
   }
 }
 
+TEST_F(FileSortCompareTest, RadixSort)
+{
+  for (int ix= 0; ix < num_iterations; ++ix)
+  {
+    std::vector<uchar*> keys(sort_keys, sort_keys + num_records);
+    radix_sort_keys(keys.data(), keys.size(), record_size,
+                    radix_work_space(keys.size()));
+  }
+}
+
+/*
+  radix_sort_keys() must give exactly the same order as std::stable_sort,
+  also for keys sharing long prefixes, for keys shorter than its eight byte
+  prefixes, and for duplicate keys.
+ */
+TEST_F(FileSortCompareTest, RadixSortSameAsStableSort)
+{
+  std::vector<uchar*> keys(sort_keys, sort_keys + num_records);
+  std::vector<uchar*> expected(keys);
+  radix_sort_keys(keys.data(), keys.size(), record_size,
+                  radix_work_space(keys.size()));
+  std::stable_sort(expected.begin(), expected.end(),
+                   Mem_compare_memcmp(record_size));
+  EXPECT_EQ(expected, keys);
+
+  for (size_t key_len : { 1, 3, 8, 9, 20 })
+  {
+    const size_t num_keys= 5000;
+    std::vector<uchar> data(num_keys * key_len);
+    for (size_t iy= 0; iy < data.size(); ++iy)
+      data[iy]= (iy * 7919 + iy / 3) % 5;
+    std::vector<uchar*> radix_keys;
+    for (size_t iy= 0; iy < num_keys; ++iy)
+    {
+      if (iy % 2 == 0)
+        memset(&data[iy * key_len], 'x', std::min<size_t>(key_len, 10));
+      radix_keys.push_back(&data[iy * key_len]);
+    }
+    std::vector<uchar*> stable_keys(radix_keys);
+    radix_sort_keys(radix_keys.data(), radix_keys.size(), key_len,
+                    radix_work_space(radix_keys.size()));
+    std::stable_sort(stable_keys.begin(), stable_keys.end(),
+                     Mem_compare_memcmp(key_len));
+    EXPECT_EQ(stable_keys, radix_keys) << "key_len " << key_len;
+  }
+}
+
 }  // namespace
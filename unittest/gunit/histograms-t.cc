@@ -2746,6 +2746,82 @@ TEST_F(HistogramsTest, HistogramTimeCreated)
 }
 
 
+/*
+  Verify the join selectivity between two singleton histograms, which is
+  computed from the exact frequencies of the values they have in common.
+*/
+TEST_F(HistogramsTest, SingletonJoinSelectivity)
+{
+  Value_map<longlong> values1(&my_charset_numeric, Value_map_type::INT);
+  values1.add_values(1, 10);
+  values1.add_values(2, 30);
+
+  Value_map<longlong> values2(&my_charset_numeric, Value_map_type::INT);
+  values2.add_null_values(20);
+  values2.add_values(2, 10);
+  values2.add_values(3, 10);
+
+  Singleton<longlong> histogram1(&m_mem_root, "db1", "tbl1", "col1",
+                                 Value_map_type::INT);
+  Singleton<longlong> histogram2(&m_mem_root, "db1", "tbl2", "col1",
+                                 Value_map_type::INT);
+  EXPECT_FALSE(histogram1.build_histogram(values1, 10U));
+  EXPECT_FALSE(histogram2.build_histogram(values2, 10U));
+
+  // Only the value 2 matches: (30/40) * (10/40)
+  double selectivity;
+  EXPECT_FALSE(histogram1.get_join_selectivity(histogram2, &selectivity));
+  EXPECT_DOUBLE_EQ(0.1875, selectivity);
+  EXPECT_FALSE(histogram2.get_join_selectivity(histogram1, &selectivity));
+  EXPECT_DOUBLE_EQ(0.1875, selectivity);
+}
+
+
+/*
+  Verify the join selectivity between equi-height histograms, and between an
+  equi-height and a singleton histogram.
+*/
+TEST_F(HistogramsTest, EquiHeightJoinSelectivity)
+{
+  Value_map<longlong> values(&my_charset_numeric, Value_map_type::INT);
+  for (longlong i= 1; i <= 4; ++i)
+    values.add_values(i, 10);
+
+  Value_map<longlong> skewed_values(&my_charset_numeric, Value_map_type::INT);
+  skewed_values.add_values(1, 10);
+  skewed_values.add_values(2, 30);
+
+  // A single bucket [1, 4] with four distinct values
+  Equi_height<longlong> equi_height1(&m_mem_root, "db1", "tbl1", "col1",
+                                     Value_map_type::INT);
+  Equi_height<longlong> equi_height2(&m_mem_root, "db1", "tbl2", "col1",
+                                     Value_map_type::INT);
+  Singleton<longlong> singleton(&m_mem_root, "db1", "tbl3", "col1",
+                                Value_map_type::INT);
+  EXPECT_FALSE(equi_height1.build_histogram(values, 1U));
+  EXPECT_FALSE(equi_height2.build_histogram(values, 1U));
+  EXPECT_FALSE(singleton.build_histogram(skewed_values, 10U));
+
+  // Four matching values, each matching (1/4) * (1/4) of the combinations.
+  double selectivity;
+  EXPECT_FALSE(equi_height1.get_join_selectivity(equi_height2, &selectivity));
+  EXPECT_DOUBLE_EQ(0.25, selectivity);
+
+  // Each value in the singleton histogram matches 1/4 of the other column.
+  EXPECT_FALSE(equi_height1.get_join_selectivity(singleton, &selectivity));
+  EXPECT_DOUBLE_EQ(0.25, selectivity);
+  EXPECT_FALSE(singleton.get_join_selectivity(equi_height1, &selectivity));
+  EXPECT_DOUBLE_EQ(0.25, selectivity);
+
+  // Histograms of different data types cannot be compared.
+  Singleton<double> double_histogram(&m_mem_root, "db1", "tbl4", "col1",
+                                     Value_map_type::DOUBLE);
+  EXPECT_FALSE(double_histogram.build_histogram(double_values, 10U));
+  EXPECT_TRUE(equi_height1.get_join_selectivity(double_histogram,
+                                                &selectivity));
+}
+
+
 /*
   Check that an out-of-memory situation doesn't crash brutally, but fails
   gracefully.
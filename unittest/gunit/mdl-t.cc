@@ -25,7 +25,10 @@
 #include <gtest/gtest.h>
 #include <stddef.h>
 #include <sys/types.h>
+#include <atomic>
+#include <vector>
 
+#include "benchmark.h"
 #include "my_dbug.h"
 #include "my_inttypes.h"
 #include "mysqld_error.h"
@@ -4570,6 +4573,206 @@ TEST_F(MDLHtonNotifyTest, NotifyClone)
 }
 
 
+/**
+  Check that "fast path" IX locks in GLOBAL namespace, which are accounted
+  in per-CPU counters, conflict with S lock as expected, including locks
+  which were cloned.
+*/
+
+TEST_F(MDLTest, GlobalFastPathSlots)
+{
+  MDL_context mdl_context2;
+  mdl_context2.init(this);
+  MDL_request explicit_request, shared_request;
+  MDL_REQUEST_INIT(&explicit_request,
+                   MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE,
+                   MDL_EXPLICIT);
+  MDL_REQUEST_INIT(&shared_request,
+                   MDL_key::GLOBAL, "", "", MDL_SHARED, MDL_EXPLICIT);
+
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_global_request));
+  EXPECT_NE(m_null_ticket, m_global_request.ticket);
+
+  /* IX lock is granted, S lock should not be. */
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&shared_request));
+  EXPECT_EQ(m_null_ticket, shared_request.ticket);
+
+  /* Clone IX lock and release the original, S lock is still blocked. */
+  EXPECT_FALSE(m_mdl_context.acquire_lock(&explicit_request, long_timeout));
+  m_mdl_context.release_transactional_locks();
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&shared_request));
+  EXPECT_EQ(m_null_ticket, shared_request.ticket);
+
+  m_mdl_context.release_lock(explicit_request.ticket);
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&shared_request));
+  EXPECT_NE(m_null_ticket, shared_request.ticket);
+
+  /* Now IX lock can't be acquired using "fast path" or at all. */
+  MDL_REQUEST_INIT(&m_global_request,
+                   MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE,
+                   MDL_TRANSACTION);
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_global_request));
+  EXPECT_EQ(m_null_ticket, m_global_request.ticket);
+
+  mdl_context2.release_lock(shared_request.ticket);
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_global_request));
+  EXPECT_NE(m_null_ticket, m_global_request.ticket);
+
+  m_mdl_context.release_transactional_locks();
+  mdl_context2.destroy();
+}
+
+
+/**
+  Auxiliary thread class which simulates connection running DML statements
+  in a loop, i.e. acquiring IX lock in GLOBAL namespace and SW lock on table.
+  If "global_holders" is provided it is incremented while global lock is held.
+*/
+
+class MDL_DML_thread : public Thread, public Test_MDL_context_owner
+{
+public:
+  MDL_DML_thread(const char *table_name, size_t iterations,
+                 std::atomic<int> *global_holders)
+  : m_table_name(table_name),
+    m_iterations(iterations),
+    m_global_holders(global_holders)
+  {
+    m_mdl_context.init(this);
+  }
+
+  ~MDL_DML_thread()
+  {
+    m_mdl_context.destroy();
+  }
+
+  virtual void notify_shared_lock(MDL_context_owner*, bool) {}
+
+  virtual void run()
+  {
+    for (size_t i= 0; i < m_iterations; ++i)
+    {
+      MDL_request global_request, request;
+      MDL_REQUEST_INIT(&global_request,
+                       MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE,
+                       MDL_STATEMENT);
+      MDL_REQUEST_INIT(&request,
+                       MDL_key::TABLE, db_name, m_table_name,
+                       MDL_SHARED_WRITE, MDL_TRANSACTION);
+
+      EXPECT_FALSE(m_mdl_context.acquire_lock(&global_request, long_timeout));
+      if (m_global_holders)
+        ++*m_global_holders;
+      EXPECT_FALSE(m_mdl_context.acquire_lock(&request, long_timeout));
+      if (m_global_holders)
+        --*m_global_holders;
+      m_mdl_context.release_statement_locks();
+      m_mdl_context.release_transactional_locks();
+    }
+  }
+
+private:
+  const char *m_table_name;
+  size_t m_iterations;
+  std::atomic<int> *m_global_holders;
+  MDL_context m_mdl_context;
+};
+
+
+/**
+  Check that S lock in GLOBAL namespace excludes concurrent IX locks taken
+  using "fast path" by many connections, and that these connections wake
+  up its waiting request when they release their locks.
+*/
+
+TEST_F(MDLTest, GlobalFastPathConcurrentShared)
+{
+  const uint THREADS= 8;
+  const char *table_names[THREADS]= {"0","1","2","3","4","5","6","7"};
+  MDL_DML_thread *threads[THREADS];
+  std::atomic<int> global_holders(0);
+  uint i;
+
+  for (i= 0; i < THREADS; ++i)
+  {
+    threads[i]= new MDL_DML_thread(table_names[i], 2000, &global_holders);
+    threads[i]->start();
+  }
+
+  for (i= 0; i < 100; ++i)
+  {
+    MDL_request shared_request;
+    MDL_REQUEST_INIT(&shared_request,
+                     MDL_key::GLOBAL, "", "", MDL_SHARED, MDL_EXPLICIT);
+    EXPECT_FALSE(m_mdl_context.acquire_lock(&shared_request, long_timeout));
+    EXPECT_EQ(0, global_holders.load());
+    m_mdl_context.release_lock(shared_request.ticket);
+  }
+
+  for (i= 0; i < THREADS; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+}
+
+
+/*
+  Microbenchmarks of DML-like locking by 1, 16 and 128 concurrent
+  connections, for checking how "fast path" locking scales. Iterations
+  are split between connections, so with perfect scaling the time per
+  iteration goes down as the number of connections goes up.
+*/
+
+static void benchmark_concurrent_dml(size_t num_iterations, uint num_threads)
+{
+  const char *table_names[]= {"0","1","2","3","4","5","6","7"};
+  const size_t iterations_per_thread=
+    (num_iterations + num_threads - 1) / num_threads;
+  std::vector<MDL_DML_thread*> threads;
+
+  StopBenchmarkTiming();
+  CHARSET_INFO *charset= system_charset_info;
+  system_charset_info= &my_charset_utf8_bin;
+  max_write_lock_count= ULONG_MAX;
+  mdl_init();
+
+  for (uint i= 0; i < num_threads; ++i)
+    threads.push_back(new MDL_DML_thread(table_names[i % 8],
+                                         iterations_per_thread, nullptr));
+
+  StartBenchmarkTiming();
+  for (MDL_DML_thread *thread : threads)
+    thread->start();
+  for (MDL_DML_thread *thread : threads)
+    thread->join();
+  StopBenchmarkTiming();
+
+  for (MDL_DML_thread *thread : threads)
+    delete thread;
+  mdl_destroy();
+  system_charset_info= charset;
+}
+
+static void BM_MDLConcurrentDML1Thread(size_t num_iterations)
+{
+  benchmark_concurrent_dml(num_iterations, 1);
+}
+BENCHMARK(BM_MDLConcurrentDML1Thread);
+
+static void BM_MDLConcurrentDML16Threads(size_t num_iterations)
+{
+  benchmark_concurrent_dml(num_iterations, 16);
+}
+BENCHMARK(BM_MDLConcurrentDML16Threads);
+
+static void BM_MDLConcurrentDML128Threads(size_t num_iterations)
+{
+  benchmark_concurrent_dml(num_iterations, 128);
+}
+BENCHMARK(BM_MDLConcurrentDML128Threads);
+
+
 /** Test class for MDL_key class testing. Doesn't require MDL initialization. */
 
 class MDLKeyTest : public ::testing::Test
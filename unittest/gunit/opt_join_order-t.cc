@@ -0,0 +1,369 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include "benchmark.h"
+#include "my_alloc.h"
+#include "my_inttypes.h"
+#include "my_sys.h"
+#include "my_table_map.h"
+#include "sql/opt_join_order.h"
+
+namespace opt_join_order_unittest {
+
+/**
+  A synthetic cost model. Every table has a number of rows and a fan-out,
+  so the number of rows of a partial plan only depends on its tables. A
+  table that is joined to the plan is accessed with one lookup per row of
+  the plan; otherwise it is scanned for each row.
+*/
+struct Plan
+{
+  uint tableno;
+  double rowcount;
+  double cost;
+};
+
+class Join_graph
+{
+public:
+  explicit Join_graph(uint tables)
+    : m_tables(tables), m_rows(tables, 100.0), m_fanout(tables, 1.0),
+      m_neighbours(tables, 0), m_dependencies(tables, 0)
+  {}
+
+  void add_edge(uint a, uint b)
+  {
+    m_neighbours[a]|= table_map(1) << b;
+    m_neighbours[b]|= table_map(1) << a;
+  }
+
+  void set_table(uint tableno, double rows, double fanout)
+  {
+    m_rows[tableno]= rows;
+    m_fanout[tableno]= fanout;
+  }
+
+  void add_dependency(uint tableno, uint dependency)
+  {
+    m_dependencies[tableno]|= table_map(1) << dependency;
+  }
+
+  table_map all_tables() const
+  {
+    return m_tables == 64 ? ~table_map(0) : (table_map(1) << m_tables) - 1;
+  }
+
+  const table_map *neighbours() const { return m_neighbours.data(); }
+  const table_map *dependencies() const { return m_dependencies.data(); }
+
+  /// Extend the plan in plans[0 .. position) with a table.
+  Plan extend(const Plan *plans, uint position, table_map prefix_tables,
+              uint tableno) const
+  {
+    const Plan prev= position == 0 ? Plan{0, 1.0, 0.0} : plans[position - 1];
+    const bool joined= (m_neighbours[tableno] & prefix_tables) != 0;
+    Plan plan;
+    plan.tableno= tableno;
+    plan.rowcount= prev.rowcount * m_fanout[tableno];
+    plan.cost= prev.cost +
+               prev.rowcount * (joined ? 1.0 : m_rows[tableno]) +
+               plan.rowcount;
+    return plan;
+  }
+
+  /**
+    Find the cheapest order by trying every permutation in which each table
+    is joined to the tables before it whenever that is possible, as
+    join_order_dp_search() requires.
+  */
+  double brute_force_cost() const
+  {
+    std::vector<uint> order;
+    for (uint i= 0; i < m_tables; i++)
+      order.push_back(i);
+    std::vector<Plan> plans(m_tables);
+    double best= -1.0;
+    do
+    {
+      table_map prefix= 0;
+      table_map prefix_neighbours= 0;
+      bool valid= true;
+      for (uint pos= 0; pos < m_tables && valid; pos++)
+      {
+        const uint tableno= order[pos];
+        if (m_dependencies[tableno] & ~prefix)
+          valid= false;
+        else if (!(prefix_neighbours & (table_map(1) << tableno)))
+        {
+          // A table not joined to the prefix is allowed only if none is.
+          for (uint rest= pos + 1; rest < m_tables; rest++)
+            if (prefix_neighbours & (table_map(1) << order[rest]) &&
+                !(m_dependencies[order[rest]] & ~prefix))
+              valid= false;
+        }
+        plans[pos]= extend(plans.data(), pos, prefix, tableno);
+        prefix|= table_map(1) << tableno;
+        prefix_neighbours|= m_neighbours[tableno];
+      }
+      if (valid && (best < 0.0 || plans[m_tables - 1].cost < best))
+        best= plans[m_tables - 1].cost;
+    } while (std::next_permutation(order.begin(), order.end()));
+    return best;
+  }
+
+private:
+  uint m_tables;
+  std::vector<double> m_rows;
+  std::vector<double> m_fanout;
+  std::vector<table_map> m_neighbours;
+  std::vector<table_map> m_dependencies;
+};
+
+
+class JoinOrderTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    init_alloc_root(PSI_NOT_INSTRUMENTED, &m_mem_root, 1024, 0);
+  }
+
+  virtual void TearDown()
+  {
+    free_root(&m_mem_root, MYF(0));
+  }
+
+  /**
+    Run the search, leaving the plan found in m_plans.
+
+    @return the cost of the plan found
+  */
+  double search(const Join_graph &graph, uint max_block_size,
+                ulonglong max_partial_plans)
+  {
+    const table_map tables= graph.all_tables();
+    const uint table_count= my_count_bits(tables);
+    m_plans.assign(table_count, Plan());
+    m_partial_plans= 0;
+    auto extend= [&](uint position, table_map prefix_tables, uint tableno,
+                     double *cost)
+    {
+      m_plans[position]= graph.extend(m_plans.data(), position,
+                                      prefix_tables, tableno);
+      *cost= m_plans[position].cost;
+      return false;
+    };
+    EXPECT_FALSE(join_order_dp_search(&m_mem_root, tables, graph.neighbours(),
+                                      graph.dependencies(), max_block_size,
+                                      max_partial_plans, extend,
+                                      m_plans.data(), &m_partial_plans));
+    return m_plans[table_count - 1].cost;
+  }
+
+  /// Check that every table is placed once, after its dependencies.
+  void check_order(const Join_graph &graph)
+  {
+    table_map placed= 0;
+    for (const Plan &plan : m_plans)
+    {
+      const table_map bit= table_map(1) << plan.tableno;
+      EXPECT_EQ(0U, placed & bit) << "table " << plan.tableno;
+      EXPECT_EQ(0U, graph.dependencies()[plan.tableno] & ~placed)
+        << "table " << plan.tableno;
+      placed|= bit;
+    }
+    EXPECT_EQ(graph.all_tables(), placed);
+  }
+
+  MEM_ROOT m_mem_root;
+  std::vector<Plan> m_plans;
+  ulonglong m_partial_plans;
+};
+
+
+static Join_graph make_star(uint tables)
+{
+  Join_graph graph(tables);
+  graph.set_table(0, 100000.0, 1.0);
+  for (uint i= 1; i < tables; i++)
+  {
+    graph.add_edge(0, i);
+    graph.set_table(i, 10.0 + i, i % 3 == 0 ? 0.5 : 1.0);
+  }
+  return graph;
+}
+
+
+static Join_graph make_chain(uint tables)
+{
+  Join_graph graph(tables);
+  for (uint i= 0; i < tables; i++)
+  {
+    if (i > 0)
+      graph.add_edge(i - 1, i);
+    graph.set_table(i, 10.0 * (1 + i % 5), i % 4 == 0 ? 2.0 : 0.9);
+  }
+  return graph;
+}
+
+
+static Join_graph make_clique(uint tables)
+{
+  Join_graph graph(tables);
+  for (uint i= 0; i < tables; i++)
+  {
+    for (uint j= 0; j < i; j++)
+      graph.add_edge(i, j);
+    graph.set_table(i, 10.0 * (1 + i), 1.0 + 0.1 * (i % 3));
+  }
+  return graph;
+}
+
+
+TEST_F(JoinOrderTest, MatchesExhaustiveSearch)
+{
+  Join_graph star= make_star(6);
+  EXPECT_DOUBLE_EQ(star.brute_force_cost(), search(star, 6, 1000000));
+
+  Join_graph chain= make_chain(7);
+  EXPECT_DOUBLE_EQ(chain.brute_force_cost(), search(chain, 7, 1000000));
+
+  Join_graph clique= make_clique(6);
+  EXPECT_DOUBLE_EQ(clique.brute_force_cost(), search(clique, 6, 1000000));
+
+  // A Cartesian product: the two components are not joined to each other.
+  Join_graph disconnected(6);
+  disconnected.add_edge(0, 1);
+  disconnected.add_edge(1, 2);
+  disconnected.add_edge(3, 4);
+  disconnected.add_edge(4, 5);
+  disconnected.set_table(0, 1000.0, 0.1);
+  disconnected.set_table(3, 50.0, 3.0);
+  EXPECT_DOUBLE_EQ(disconnected.brute_force_cost(),
+                   search(disconnected, 6, 1000000));
+  check_order(disconnected);
+}
+
+
+TEST_F(JoinOrderTest, Dependencies)
+{
+  Join_graph graph= make_star(6);
+  // Like the inner tables of a straight join.
+  graph.add_dependency(1, 4);
+  graph.add_dependency(4, 5);
+  EXPECT_DOUBLE_EQ(graph.brute_force_cost(), search(graph, 6, 1000000));
+  check_order(graph);
+
+  // The same in blocks of two tables.
+  search(graph, 2, 1000000);
+  check_order(graph);
+}
+
+
+TEST_F(JoinOrderTest, LargeJoins)
+{
+  const ulonglong max_partial_plans= 10000;
+  const Join_graph graphs[]= { make_star(40), make_chain(40),
+                               make_clique(20), make_star(64) };
+  for (const Join_graph &graph : graphs)
+  {
+    search(graph, 62, max_partial_plans);
+    check_order(graph);
+    // Every block places at least one table.
+    EXPECT_LE(m_partial_plans, m_plans.size() * max_partial_plans);
+  }
+}
+
+
+TEST_F(JoinOrderTest, Abort)
+{
+  const Join_graph graph= make_star(10);
+  std::vector<Plan> plans(10);
+  ulonglong partial_plans= 0;
+  uint calls= 0;
+  auto extend= [&](uint position, table_map, uint, double *cost)
+  {
+    plans[position]= Plan{0, 1.0, 1.0};
+    *cost= 1.0;
+    return ++calls == 5;
+  };
+  EXPECT_TRUE(join_order_dp_search(&m_mem_root, graph.all_tables(),
+                                   graph.neighbours(), graph.dependencies(),
+                                   62, 10000, extend, plans.data(),
+                                   &partial_plans));
+  EXPECT_EQ(5U, calls);
+}
+
+
+/*
+  Optimizer time for large joins. The block size and the limit on partial
+  plans are those that Optimize_table_order::dp_search() uses by default.
+*/
+static void run_join_order_benchmark(size_t num_iterations,
+                                     const Join_graph &graph)
+{
+  StopBenchmarkTiming();
+  MEM_ROOT mem_root;
+  init_alloc_root(PSI_NOT_INSTRUMENTED, &mem_root, 1024, 0);
+  const uint table_count= my_count_bits(graph.all_tables());
+  std::vector<Plan> plans(table_count);
+  auto extend= [&](uint position, table_map prefix_tables, uint tableno,
+                   double *cost)
+  {
+    plans[position]= graph.extend(plans.data(), position, prefix_tables,
+                                  tableno);
+    *cost= plans[position].cost;
+    return false;
+  };
+  StartBenchmarkTiming();
+
+  for (size_t i= 0; i < num_iterations; ++i)
+  {
+    ulonglong partial_plans= 0;
+    join_order_dp_search(&mem_root, graph.all_tables(), graph.neighbours(),
+                         graph.dependencies(), 62, 10000, extend,
+                         plans.data(), &partial_plans);
+  }
+
+  StopBenchmarkTiming();
+  free_root(&mem_root, MYF(0));
+}
+
+static void BM_JoinOrderStar40(size_t num_iterations)
+{
+  run_join_order_benchmark(num_iterations, make_star(40));
+}
+BENCHMARK(BM_JoinOrderStar40);
+
+static void BM_JoinOrderChain40(size_t num_iterations)
+{
+  run_join_order_benchmark(num_iterations, make_chain(40));
+}
+BENCHMARK(BM_JoinOrderChain40);
+
+static void BM_JoinOrderClique20(size_t num_iterations)
+{
+  run_join_order_benchmark(num_iterations, make_clique(20));
+}
+BENCHMARK(BM_JoinOrderClique20);
+
+}  // namespace opt_join_order_unittest
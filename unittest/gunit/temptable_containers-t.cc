@@ -0,0 +1,292 @@
+/* Copyright (c) 2017, Oracle and/or its affiliates. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+
+#include <gtest/gtest.h>
+#include <random>        /* std::mt19937 */
+#include <set>           /* std::multiset */
+#include <unordered_set> /* std::unordered_multiset */
+#include <vector>        /* std::vector */
+
+#include "benchmark.h"
+#include "temptable/allocator.h"  /* temptable::Allocator */
+#include "temptable/btree.h"      /* temptable::Btree */
+#include "temptable/hash_table.h" /* temptable::Hash_table */
+
+namespace temptable_containers_unittest {
+
+/** Element of the same size as temptable::Indexed_cells: a key and a pointer
+ * to the row. */
+struct Element {
+  uint64_t key;
+  const void* row;
+};
+
+struct Element_less {
+  bool operator()(const Element& lhs, const Element& rhs) const {
+    return lhs.key < rhs.key;
+  }
+};
+
+struct Element_hash {
+  size_t operator()(const Element& e) const { return e.key; }
+};
+
+struct Element_equal_to {
+  bool operator()(const Element& lhs, const Element& rhs) const {
+    return lhs.key == rhs.key;
+  }
+};
+
+typedef temptable::Btree<Element, Element_less> Tree;
+typedef temptable::Hash_table<Element, Element_hash, Element_equal_to> Hash;
+
+static const void* row(size_t i) {
+  return reinterpret_cast<const void*>(i + 1);
+}
+
+TEST(temptable_containers, tree) {
+  temptable::Allocator<Element> allocator;
+  Tree tree(Element_less(), allocator);
+  std::multiset<Element, Element_less> reference;
+  std::mt19937 rng(1);
+
+  for (size_t i = 0; i < 20000; ++i) {
+    const Element e{rng() % 1000, row(i)};
+    EXPECT_EQ(e.row, tree.insert(e)->row);
+    reference.insert(e);
+  }
+
+  /* Erase half of the elements, picking them through lower_bound(). */
+  for (size_t i = 0; i < 10000; ++i) {
+    const Element e{rng() % 1000, nullptr};
+    auto it = tree.lower_bound(e);
+    auto ref_it = reference.lower_bound(e);
+    if (ref_it == reference.end()) {
+      EXPECT_TRUE(it == tree.end());
+      continue;
+    }
+    ASSERT_TRUE(it != tree.end());
+    EXPECT_EQ(ref_it->key, it->key);
+    auto ref_range = reference.equal_range(*it);
+    for (auto r = ref_range.first; r != ref_range.second; ++r) {
+      if (r->row == it->row) {
+        reference.erase(r);
+        break;
+      }
+    }
+    tree.erase(it);
+  }
+
+  ASSERT_EQ(reference.size(), tree.size());
+
+  auto it = tree.begin();
+  for (const Element& e : reference) {
+    ASSERT_TRUE(it != tree.end());
+    EXPECT_EQ(e.key, it->key);
+    ++it;
+  }
+  EXPECT_TRUE(it == tree.end());
+
+  auto ref_rit = reference.rbegin();
+  for (it = tree.end(); it != tree.begin(); ++ref_rit) {
+    --it;
+    EXPECT_EQ(ref_rit->key, it->key);
+  }
+
+  for (uint64_t k = 0; k < 1000; ++k) {
+    const Element e{k, nullptr};
+    auto ref_upper = reference.upper_bound(e);
+    auto upper = tree.upper_bound(e);
+    if (ref_upper == reference.end()) {
+      EXPECT_TRUE(upper == tree.end());
+    } else {
+      EXPECT_EQ(ref_upper->key, upper->key);
+    }
+  }
+
+  tree.clear();
+  EXPECT_EQ(0u, tree.size());
+  EXPECT_TRUE(tree.begin() == tree.end());
+}
+
+TEST(temptable_containers, hash_unique) {
+  temptable::Allocator<Element> allocator;
+  Hash hash(4, Element_hash(), Element_equal_to(), allocator, false);
+
+  for (size_t i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(hash.insert(Element{i, row(i)}).second);
+  }
+
+  auto r = hash.insert(Element{42, nullptr});
+  EXPECT_FALSE(r.second);
+  EXPECT_EQ(row(42), r.first->row);
+
+  for (size_t i = 0; i < 10000; i += 2) {
+    auto range = hash.equal_range(Element{i, nullptr});
+    ASSERT_TRUE(range.first != hash.end());
+    hash.erase(range.first);
+  }
+
+  EXPECT_EQ(5000u, hash.size());
+
+  for (size_t i = 0; i < 10000; ++i) {
+    auto range = hash.equal_range(Element{i, nullptr});
+    if (i % 2 == 0) {
+      EXPECT_TRUE(range.first == hash.end());
+    } else {
+      ASSERT_TRUE(range.first != hash.end());
+      EXPECT_EQ(row(i), range.first->row);
+      EXPECT_TRUE(++range.first == range.second);
+    }
+  }
+
+  size_t n = 0;
+  for (auto it = hash.begin(); it != hash.end(); ++it) {
+    ++n;
+  }
+  EXPECT_EQ(5000u, n);
+}
+
+TEST(temptable_containers, hash_duplicates) {
+  temptable::Allocator<Element> allocator;
+  Hash hash(4, Element_hash(), Element_equal_to(), allocator, true);
+
+  for (size_t i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(hash.insert(Element{i % 100, row(i)}).second);
+  }
+
+  for (uint64_t k = 0; k < 100; ++k) {
+    auto range = hash.equal_range(Element{k, nullptr});
+    size_t n = 0;
+    for (auto it = range.first; it != range.second; ++it) {
+      EXPECT_EQ(k, it->key);
+      ++n;
+    }
+    EXPECT_EQ(100u, n);
+  }
+
+  /* Erase all but one of the duplicates of each key. */
+  for (uint64_t k = 0; k < 100; ++k) {
+    for (size_t i = 0; i < 99; ++i) {
+      hash.erase(hash.equal_range(Element{k, nullptr}).first);
+    }
+  }
+
+  EXPECT_EQ(100u, hash.size());
+
+  hash.clear();
+  EXPECT_TRUE(hash.equal_range(Element{1, nullptr}).first == hash.end());
+}
+
+/* Microbenchmarks comparing the containers to the std ones that TempTable
+ * indexes used before. Each iteration inserts 100000 elements with random
+ * keys, looks each key up, and erases all elements. */
+
+static constexpr size_t BENCHMARK_ELEMENTS = 100000;
+
+static std::vector<Element> benchmark_elements() {
+  std::vector<Element> elements;
+  std::mt19937 rng(1);
+  for (size_t i = 0; i < BENCHMARK_ELEMENTS; ++i) {
+    elements.push_back(Element{rng(), row(i)});
+  }
+  return elements;
+}
+
+template <class Container>
+static void benchmark_tree(size_t num_iterations, Container* container) {
+  const std::vector<Element> elements = benchmark_elements();
+  size_t found = 0;
+
+  StartBenchmarkTiming();
+  for (size_t i = 0; i < num_iterations; ++i) {
+    for (const Element& e : elements) {
+      container->insert(e);
+    }
+    for (const Element& e : elements) {
+      found += container->lower_bound(e)->row == e.row;
+    }
+    for (auto it = container->begin(); it != container->end(); ++it) {
+      found -= it->key & 1;
+    }
+    for (const Element& e : elements) {
+      container->erase(container->lower_bound(e));
+    }
+  }
+  StopBenchmarkTiming();
+
+  EXPECT_NE(0u, found);
+}
+
+static void BM_TempTableTreeBtree(size_t num_iterations) {
+  StopBenchmarkTiming();
+  temptable::Allocator<Element> allocator;
+  Tree tree(Element_less(), allocator);
+  benchmark_tree(num_iterations, &tree);
+}
+BENCHMARK(BM_TempTableTreeBtree);
+
+static void BM_TempTableTreeStdMultiset(size_t num_iterations) {
+  StopBenchmarkTiming();
+  temptable::Allocator<Element> allocator;
+  std::multiset<Element, Element_less, temptable::Allocator<Element>> tree(
+      Element_less(), allocator);
+  benchmark_tree(num_iterations, &tree);
+}
+BENCHMARK(BM_TempTableTreeStdMultiset);
+
+template <class Container>
+static void benchmark_hash(size_t num_iterations, Container* container) {
+  const std::vector<Element> elements = benchmark_elements();
+  size_t found = 0;
+
+  StartBenchmarkTiming();
+  for (size_t i = 0; i < num_iterations; ++i) {
+    for (const Element& e : elements) {
+      container->insert(e);
+    }
+    for (const Element& e : elements) {
+      found += container->equal_range(e).first->row == e.row;
+    }
+    for (const Element& e : elements) {
+      container->erase(container->equal_range(e).first);
+    }
+  }
+  StopBenchmarkTiming();
+
+  EXPECT_NE(0u, found);
+}
+
+static void BM_TempTableHashHashTable(size_t num_iterations) {
+  StopBenchmarkTiming();
+  temptable::Allocator<Element> allocator;
+  Hash hash(1024, Element_hash(), Element_equal_to(), allocator, true);
+  benchmark_hash(num_iterations, &hash);
+}
+BENCHMARK(BM_TempTableHashHashTable);
+
+static void BM_TempTableHashStdUnorderedMultiset(size_t num_iterations) {
+  StopBenchmarkTiming();
+  temptable::Allocator<Element> allocator;
+  std::unordered_multiset<Element, Element_hash, Element_equal_to,
+                          temptable::Allocator<Element>>
+      hash(1024, Element_hash(), Element_equal_to(), allocator);
+  benchmark_hash(num_iterations, &hash);
+}
+BENCHMARK(BM_TempTableHashStdUnorderedMultiset);
+
+} /* namespace temptable_containers_unittest */